@@ -0,0 +1,114 @@
+#ifndef _STL_EXTENSION_BENCH_INPUTS_H_
+#define _STL_EXTENSION_BENCH_INPUTS_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+namespace trx_bench {
+//! The input distributions of the benchmarks, given as their second argument.
+enum distribution : std::int64_t {
+  random,         // uniform over the whole range of the type
+  sorted,         // ascending
+  reversed,       // descending
+  sawtooth,       // ascending runs of 64 elements
+  nearly_sorted,  // ascending with 1% of the elements swapped at random
+  few_unique      // 16 distinct values
+};
+
+constexpr std::int64_t distributions[] = {
+    random, sorted, reversed, sawtooth, nearly_sorted, few_unique};
+
+//! Returns the value of T numbered key, keys comparing like their values.
+template <class T>
+T value_of(std::uint64_t key) {
+  return static_cast<T>(key);
+}
+
+template <>
+inline std::string value_of<std::string>(std::uint64_t key) {
+  std::string value(12, '0');
+  for (std::size_t i = value.size(); key != 0 && i-- != 0; key /= 10)
+    value[i] = static_cast<char>('0'+key%10);
+  return value;
+}
+
+//! Returns n values of T drawn from the given distribution, always the same
+//! ones for given n and distribution.
+template <class T>
+std::vector<T> make_input(std::size_t n, std::int64_t shape) {
+  std::mt19937_64 engine(n*7919+static_cast<std::uint64_t>(shape));
+  std::vector<std::uint64_t> keys(n);
+  const std::uint64_t span = 1000000000;
+  switch (shape) {
+  case random:
+    for (auto &key : keys)
+      key = engine()%span;
+    break;
+  case sorted:
+  case nearly_sorted:
+    for (std::size_t i = 0; i != n; ++i)
+      keys[i] = i;
+    if (shape == nearly_sorted)
+      for (std::size_t k = 0; n > 1 && k != n/100; ++k)
+        std::swap(keys[engine()%n], keys[engine()%n]);
+    break;
+  case reversed:
+    for (std::size_t i = 0; i != n; ++i)
+      keys[i] = n-i;
+    break;
+  case sawtooth:
+    for (std::size_t i = 0; i != n; ++i)
+      keys[i] = i%64;
+    break;
+  default:
+    for (auto &key : keys)
+      key = engine()%16;
+    break;
+  }
+  std::vector<T> values;
+  values.reserve(n);
+  for (std::uint64_t key : keys)
+    values.push_back(value_of<T>(key));
+  return values;
+}
+
+//! Returns the sizes from 16 to limit, by factors of 16, and limit.
+inline std::vector<std::int64_t> sizes(std::int64_t limit) {
+  std::vector<std::int64_t> result;
+  for (std::int64_t n = 16; n < limit; n *= 16)
+    result.push_back(n);
+  result.push_back(limit);
+  return result;
+}
+
+//! The largest input size, TRX_BENCH_MAX_SIZE as set by CMake.
+constexpr std::int64_t max_size =
+#ifdef TRX_BENCH_MAX_SIZE
+    TRX_BENCH_MAX_SIZE;
+#else
+    100000000;
+#endif
+
+//! The largest input size of the node-based containers and of the strings.
+constexpr std::int64_t max_node_size =
+    max_size < (std::int64_t(1) << 24) ? max_size : std::int64_t(1) << 24;
+
+//! Names the arguments of a benchmark taking a size and a distribution.
+inline void size_and_distribution(benchmark::internal::Benchmark *bench,
+                                  std::int64_t limit) {
+  bench->ArgNames({"n", "dist"});
+  std::vector<std::int64_t> shapes(std::begin(distributions),
+                                   std::end(distributions));
+  bench->ArgsProduct({sizes(limit), shapes});
+  bench->Unit(benchmark::kMicrosecond);
+}
+
+} // namespace trx_bench
+
+#endif // _STL_EXTENSION_BENCH_INPUTS_H_
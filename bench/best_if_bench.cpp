@@ -0,0 +1,172 @@
+// trx::best_if, best_if_n and reduce_if against std::max_element over the
+// matching elements, over sizes from 16 to TRX_BENCH_MAX_SIZE and the
+// distributions of bench_inputs.h. Half of the elements match.
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#if __cplusplus >= 202002L && defined(__has_include)
+#if __has_include(<ranges>)
+#include <ranges>
+#endif
+#endif
+
+#include "bench_inputs.h"
+#include "trx/felix/algorithm.h"
+#include "trx/felix/ranges.h"
+
+namespace {
+//! The input of a search, and the bound its median leaves half of the
+//! elements above.
+template <class T>
+struct search_input {
+  explicit search_input(const benchmark::State &state)
+      : values(trx_bench::make_input<T>(state.range(0), state.range(1))) {
+    std::vector<T> copy(values);
+    std::nth_element(copy.begin(), copy.begin()+copy.size()/2, copy.end());
+    bound = copy[copy.size()/2];
+  }
+
+  std::vector<T> values;
+  T bound;
+};
+
+template <class T, class Search>
+void run_search(benchmark::State &state, Search search) {
+  const search_input<T> input(state);
+  for (auto _ : state)
+    benchmark::DoNotOptimize(search(input.values, input.bound));
+  state.SetItemsProcessed(state.iterations()*input.values.size());
+}
+
+//! The filter of the standard baselines, a lambda as most callers write it.
+template <class T>
+auto above(T bound) {
+  return [bound](T x) { return x > bound; };
+}
+
+template <class T>
+void std_copy_if_max_element(benchmark::State &state) {
+  std::vector<T> matching;
+  run_search<T>(state, [&](const std::vector<T> &values, T bound) {
+    matching.clear();
+    std::copy_if(values.begin(), values.end(), std::back_inserter(matching),
+                 above(bound));
+    return std::max_element(matching.begin(), matching.end());
+  });
+}
+
+template <class T>
+void std_max_element_filtering(benchmark::State &state) {
+  run_search<T>(state, [](const std::vector<T> &values, T bound) {
+    const auto up = above(bound);
+    return std::max_element(values.begin(), values.end(),
+                            [&](T lhs, T rhs) {
+                              return !up(lhs) || (up(rhs) && lhs < rhs);
+                            });
+  });
+}
+
+#if defined(__cpp_lib_ranges)
+template <class T>
+void std_ranges_filter_max_element(benchmark::State &state) {
+  run_search<T>(state, [](const std::vector<T> &values, T bound) {
+    return std::ranges::max_element(values | std::views::filter(above(bound)))
+        .base();
+  });
+}
+#endif
+
+template <class T>
+void trx_best_if(benchmark::State &state) {
+  run_search<T>(state, [](const std::vector<T> &values, T bound) {
+    return trx::best_if(values.begin(), values.end(), above(bound),
+                        std::greater<T>());
+  });
+}
+
+template <class T>
+void trx_best_if_simd(benchmark::State &state) {
+  run_search<T>(state, [](const std::vector<T> &values, T bound) {
+    return trx::best_if(values.begin(), values.end(),
+                        trx::greater_than(bound), std::greater<>());
+  });
+}
+
+template <class T>
+void trx_best_if_filter_view(benchmark::State &state) {
+  run_search<T>(state, [](const std::vector<T> &values, T bound) {
+    const auto view = trx::views::filter(values, trx::greater_than(bound));
+    return trx::best_if(view.begin(), view.end(), trx::any_value(),
+                        std::greater<>());
+  });
+}
+
+//! best_if_n stopping at the greatest value of the input, which the
+//! few_unique distribution reaches early.
+template <class T>
+void trx_best_if_n_optimum(benchmark::State &state) {
+  const T optimum = [&] {
+    const auto values = trx_bench::make_input<T>(state.range(0),
+                                                 state.range(1));
+    return *std::max_element(values.begin(), values.end());
+  }();
+  run_search<T>(state, [optimum](const std::vector<T> &values, T bound) {
+    return trx::best_if_n(values.begin(), values.size(), above(bound),
+                          std::greater<T>(),
+                          [optimum](T x) { return x == optimum; });
+  });
+}
+
+//! The min, max and count of the matching elements, in one pass or three.
+template <class T>
+void std_min_max_count(benchmark::State &state) {
+  run_search<T>(state, [](const std::vector<T> &values, T bound) {
+    const auto up = above(bound);
+    const auto min = trx::best_if(values.begin(), values.end(), up,
+                                  std::less<T>());
+    const auto max = trx::best_if(values.begin(), values.end(), up,
+                                  std::greater<T>());
+    const auto count = std::count_if(values.begin(), values.end(), up);
+    return (min != max)+count;
+  });
+}
+
+template <class T>
+void trx_reduce_if_min_max_count(benchmark::State &state) {
+  run_search<T>(state, [](const std::vector<T> &values, T bound) {
+    const auto stats = trx::reduce_if(values.begin(), values.end(),
+                                      trx::greater_than(bound),
+                                      trx::reduce_min(), trx::reduce_max(),
+                                      trx::reduce_count());
+    return (std::get<0>(stats) != std::get<1>(stats))+std::get<2>(stats);
+  });
+}
+
+void large(benchmark::internal::Benchmark *bench) {
+  trx_bench::size_and_distribution(bench, trx_bench::max_size);
+}
+
+} // namespace
+
+BENCHMARK_TEMPLATE(std_copy_if_max_element, int)->Apply(large);
+BENCHMARK_TEMPLATE(std_max_element_filtering, int)->Apply(large);
+#if defined(__cpp_lib_ranges)
+BENCHMARK_TEMPLATE(std_ranges_filter_max_element, int)->Apply(large);
+#endif
+BENCHMARK_TEMPLATE(trx_best_if, int)->Apply(large);
+BENCHMARK_TEMPLATE(trx_best_if_simd, int)->Apply(large);
+BENCHMARK_TEMPLATE(trx_best_if_filter_view, int)->Apply(large);
+BENCHMARK_TEMPLATE(trx_best_if_n_optimum, int)->Apply(large);
+
+BENCHMARK_TEMPLATE(std_copy_if_max_element, float)->Apply(large);
+BENCHMARK_TEMPLATE(std_max_element_filtering, float)->Apply(large);
+BENCHMARK_TEMPLATE(trx_best_if, float)->Apply(large);
+BENCHMARK_TEMPLATE(trx_best_if_simd, float)->Apply(large);
+
+BENCHMARK_TEMPLATE(std_min_max_count, float)->Apply(large);
+BENCHMARK_TEMPLATE(trx_reduce_if_min_max_count, float)->Apply(large);
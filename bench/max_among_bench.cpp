@@ -0,0 +1,87 @@
+// trx::max_among and max_among_ref against std::max(std::initializer_list),
+// taking the max of every window of K consecutive values of inputs from 16
+// to TRX_BENCH_MAX_SIZE values and the distributions of bench_inputs.h.
+
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "bench_inputs.h"
+#include "trx/felix/algorithm.h"
+
+namespace {
+template <class T, std::size_t... I>
+T std_max_of(const T *window, std::index_sequence<I...>) {
+  return std::max({window[I]...});
+}
+
+template <class T, std::size_t... I>
+T trx_max_of(const T *window, std::index_sequence<I...>) {
+  return trx::max_among(window[I]...);
+}
+
+template <class T, std::size_t... I>
+const T &trx_max_ref_of(const T *window, std::index_sequence<I...>) {
+  return trx::max_among_ref(window[I]...);
+}
+
+//! Calls max on every window of K values of an input of n+K-1 values.
+template <class T, std::size_t K, class Max>
+void run_windows(benchmark::State &state, Max max) {
+  const std::size_t n = state.range(0);
+  const std::vector<T> values = trx_bench::make_input<T>(n+K-1,
+                                                         state.range(1));
+  for (auto _ : state)
+    for (std::size_t i = 0; i != n; ++i)
+      benchmark::DoNotOptimize(max(values.data()+i));
+  state.SetItemsProcessed(state.iterations()*n);
+}
+
+template <class T, std::size_t K>
+void std_max_list(benchmark::State &state) {
+  run_windows<T, K>(state, [](const T *window) {
+    return std_max_of(window, std::make_index_sequence<K>());
+  });
+}
+
+template <class T, std::size_t K>
+void trx_max_among(benchmark::State &state) {
+  run_windows<T, K>(state, [](const T *window) {
+    return trx_max_of(window, std::make_index_sequence<K>());
+  });
+}
+
+template <class T, std::size_t K>
+void trx_max_among_ref(benchmark::State &state) {
+  run_windows<T, K>(state, [](const T *window) {
+    return &trx_max_ref_of(window, std::make_index_sequence<K>());
+  });
+}
+
+void large(benchmark::internal::Benchmark *bench) {
+  trx_bench::size_and_distribution(bench, trx_bench::max_size);
+}
+
+void node_sized(benchmark::internal::Benchmark *bench) {
+  trx_bench::size_and_distribution(bench, trx_bench::max_node_size);
+}
+
+} // namespace
+
+#define TRX_BENCH_MAX_AMONG(T, K, sizes)                                     \
+  BENCHMARK_TEMPLATE(std_max_list, T, K)->Apply(sizes);                      \
+  BENCHMARK_TEMPLATE(trx_max_among, T, K)->Apply(sizes);                     \
+  BENCHMARK_TEMPLATE(trx_max_among_ref, T, K)->Apply(sizes)
+
+TRX_BENCH_MAX_AMONG(int, 2, large);
+TRX_BENCH_MAX_AMONG(int, 4, large);
+TRX_BENCH_MAX_AMONG(int, 8, large);
+TRX_BENCH_MAX_AMONG(int, 16, large);
+TRX_BENCH_MAX_AMONG(double, 4, large);
+TRX_BENCH_MAX_AMONG(double, 16, large);
+TRX_BENCH_MAX_AMONG(std::string, 4, node_sized);
+TRX_BENCH_MAX_AMONG(std::string, 16, node_sized);
@@ -0,0 +1,87 @@
+// trx::eytzinger_index, in its Eytzinger and blocked layouts, against
+// std::lower_bound, on sorted unsigned integers of up to
+// TRX_BENCH_MAX_SIZE/4 elements: 4096 random lookups, one at a time and as
+// a batch.
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "bench_inputs.h"
+#include "trx/felix/eytzinger_index.h"
+
+namespace {
+constexpr std::size_t lookups = 4096;
+
+//! Returns n sorted values and lookups random queries among four times as
+//! many values.
+struct search_input {
+  explicit search_input(std::size_t n) : values(n), queries(lookups) {
+    std::mt19937 engine(static_cast<std::uint32_t>(n));
+    std::uniform_int_distribution<std::uint32_t> value(
+        0, static_cast<std::uint32_t>(4*n-1));
+    for (auto &x : values)
+      x = value(engine);
+    for (auto &x : queries)
+      x = value(engine);
+    std::sort(values.begin(), values.end());
+  }
+
+  std::vector<std::uint32_t> values, queries;
+};
+
+void std_lower_bound(benchmark::State &state) {
+  const search_input input(state.range(0));
+  for (auto _ : state)
+    for (std::uint32_t query : input.queries)
+      benchmark::DoNotOptimize(std::lower_bound(
+          input.values.begin(), input.values.end(), query));
+  state.SetItemsProcessed(state.iterations()*lookups);
+}
+
+template <class Layout>
+void trx_index_lower_bound(benchmark::State &state, Layout layout) {
+  const search_input input(state.range(0));
+  const trx::eytzinger_index<std::uint32_t, std::less<>, std::uint32_t>
+      index(input.values, layout);
+  for (auto _ : state)
+    for (std::uint32_t query : input.queries)
+      benchmark::DoNotOptimize(index.lower_bound(query));
+  state.SetItemsProcessed(state.iterations()*lookups);
+}
+
+template <class Layout>
+void trx_index_batch(benchmark::State &state, Layout layout) {
+  const search_input input(state.range(0));
+  const trx::eytzinger_index<std::uint32_t, std::less<>, std::uint32_t>
+      index(input.values, layout);
+  std::vector<std::size_t> ranks(lookups);
+  for (auto _ : state) {
+    index.lower_bound(input.queries.begin(), input.queries.end(),
+                      ranks.begin());
+    benchmark::DoNotOptimize(ranks.data());
+  }
+  state.SetItemsProcessed(state.iterations()*lookups);
+}
+
+void sizes(benchmark::internal::Benchmark *bench) {
+  bench->ArgNames({"n"});
+  for (std::int64_t n : trx_bench::sizes(trx_bench::max_size/4))
+    bench->Arg(n);
+  bench->Unit(benchmark::kMicrosecond);
+}
+
+} // namespace
+
+BENCHMARK(std_lower_bound)->Apply(sizes);
+BENCHMARK_CAPTURE(trx_index_lower_bound, eytzinger, trx::eytzinger_layout)
+    ->Apply(sizes);
+BENCHMARK_CAPTURE(trx_index_lower_bound, blocked, trx::blocked_layout)
+    ->Apply(sizes);
+BENCHMARK_CAPTURE(trx_index_batch, eytzinger, trx::eytzinger_layout)
+    ->Apply(sizes);
+BENCHMARK_CAPTURE(trx_index_batch, blocked, trx::blocked_layout)
+    ->Apply(sizes);
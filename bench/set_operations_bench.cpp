@@ -0,0 +1,101 @@
+// trx::merge, set_intersection and set_union against the standard
+// algorithms, on sorted sets of unsigned integers: the longer one of up to
+// TRX_BENCH_MAX_SIZE/4 elements, the shorter one 1 to 4096 times shorter,
+// drawn from four times as many values.
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "bench_inputs.h"
+#include "trx/felix/algorithm.h"
+
+namespace {
+//! Returns about n sorted distinct values drawn from [0, 4*range).
+std::vector<std::uint32_t> sorted_set(std::size_t n, std::size_t range,
+                                      std::uint32_t seed) {
+  std::mt19937 engine(seed);
+  std::uniform_int_distribution<std::uint32_t> value(
+      0, static_cast<std::uint32_t>(4*range-1));
+  std::vector<std::uint32_t> values(n);
+  for (auto &x : values)
+    x = value(engine);
+  std::sort(values.begin(), values.end());
+  values.erase(std::unique(values.begin(), values.end()), values.end());
+  return values;
+}
+
+//! Runs operation on a set of state.range(0) elements and one
+//! state.range(1) times shorter, into a buffer large enough for both.
+template <class Operation>
+void run_set_operation(benchmark::State &state, Operation operation) {
+  const std::size_t n = state.range(0);
+  const auto longer = sorted_set(n, n, 1);
+  const auto shorter = sorted_set(n/state.range(1)+1, n, 2);
+  std::vector<std::uint32_t> out(longer.size()+shorter.size());
+  for (auto _ : state)
+    benchmark::DoNotOptimize(operation(longer, shorter, out.begin()));
+  state.SetItemsProcessed(state.iterations()*(longer.size()+shorter.size()));
+}
+
+void std_merge(benchmark::State &state) {
+  run_set_operation(state, [](const auto &a, const auto &b, auto out) {
+    return std::merge(a.begin(), a.end(), b.begin(), b.end(), out);
+  });
+}
+
+void trx_merge(benchmark::State &state) {
+  run_set_operation(state, [](const auto &a, const auto &b, auto out) {
+    return trx::merge(a, b, out);
+  });
+}
+
+void std_set_intersection(benchmark::State &state) {
+  run_set_operation(state, [](const auto &a, const auto &b, auto out) {
+    return std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), out);
+  });
+}
+
+void trx_set_intersection(benchmark::State &state) {
+  run_set_operation(state, [](const auto &a, const auto &b, auto out) {
+    return trx::set_intersection(a, b, out);
+  });
+}
+
+void trx_set_intersection_par(benchmark::State &state) {
+  run_set_operation(state, [](const auto &a, const auto &b, auto out) {
+    return trx::set_intersection(trx::execution::par, a, b, out);
+  });
+}
+
+void std_set_union(benchmark::State &state) {
+  run_set_operation(state, [](const auto &a, const auto &b, auto out) {
+    return std::set_union(a.begin(), a.end(), b.begin(), b.end(), out);
+  });
+}
+
+void trx_set_union(benchmark::State &state) {
+  run_set_operation(state, [](const auto &a, const auto &b, auto out) {
+    return trx::set_union(a, b, out);
+  });
+}
+
+void size_and_ratio(benchmark::internal::Benchmark *bench) {
+  bench->ArgNames({"n", "ratio"});
+  bench->ArgsProduct({trx_bench::sizes(trx_bench::max_size/4),
+                      {1, 8, 64, 4096}});
+  bench->Unit(benchmark::kMicrosecond);
+}
+
+} // namespace
+
+BENCHMARK(std_merge)->Apply(size_and_ratio);
+BENCHMARK(trx_merge)->Apply(size_and_ratio);
+BENCHMARK(std_set_intersection)->Apply(size_and_ratio);
+BENCHMARK(trx_set_intersection)->Apply(size_and_ratio);
+BENCHMARK(trx_set_intersection_par)->Apply(size_and_ratio);
+BENCHMARK(std_set_union)->Apply(size_and_ratio);
+BENCHMARK(trx_set_union)->Apply(size_and_ratio);
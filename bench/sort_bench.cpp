@@ -0,0 +1,181 @@
+// trx::sort and trx::stable_sort against the standard sorts, for every
+// container of trx::sort's dispatch, over sizes from 16 to
+// TRX_BENCH_MAX_SIZE and the distributions of bench_inputs.h.
+
+#include <algorithm>
+#include <array>
+#include <deque>
+#include <forward_list>
+#include <functional>
+#include <list>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "bench_inputs.h"
+#include "trx/felix/algorithm.h"
+
+namespace {
+//! Sorts copies of an input with sort, the copies being made outside of the
+//! timing. Small inputs are copied many times per pause, so that pausing
+//! the timer costs little next to the sorts.
+template <class Container, class Sort>
+void run_sort(benchmark::State &state, Sort sort) {
+  const std::size_t n = state.range(0);
+  const Container input = [&] {
+    const auto values = trx_bench::make_input<
+        typename Container::value_type>(n, state.range(1));
+    return Container(values.begin(), values.end());
+  }();
+  std::vector<Container> copies(std::max<std::size_t>(1, 65536/n));
+  for (auto _ : state) {
+    state.PauseTiming();
+    for (auto &copy : copies)
+      copy = input;
+    state.ResumeTiming();
+    for (auto &copy : copies)
+      sort(copy);
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations()*copies.size()*n);
+}
+
+template <class Container>
+void std_sort(benchmark::State &state) {
+  run_sort<Container>(state, [](Container &c) {
+    std::sort(c.begin(), c.end());
+  });
+}
+
+template <class Container>
+void std_stable_sort(benchmark::State &state) {
+  run_sort<Container>(state, [](Container &c) {
+    std::stable_sort(c.begin(), c.end());
+  });
+}
+
+template <class Container>
+void member_sort(benchmark::State &state) {
+  run_sort<Container>(state, [](Container &c) { c.sort(); });
+}
+
+template <class Container>
+void trx_sort(benchmark::State &state) {
+  run_sort<Container>(state, [](Container &c) { trx::sort(c); });
+}
+
+template <class Container>
+void trx_sort_greater(benchmark::State &state) {
+  run_sort<Container>(state, [](Container &c) {
+    trx::sort(c, std::greater<>());
+  });
+}
+
+template <class Container>
+void std_sort_greater(benchmark::State &state) {
+  run_sort<Container>(state, [](Container &c) {
+    std::sort(c.begin(), c.end(), std::greater<>());
+  });
+}
+
+template <class Container>
+void trx_par_sort(benchmark::State &state) {
+  run_sort<Container>(state, [](Container &c) {
+    trx::sort(trx::execution::par, c, std::less<>());
+  });
+}
+
+template <class Container>
+void trx_stable_sort(benchmark::State &state) {
+  run_sort<Container>(state, [](Container &c) {
+    trx::stable_sort(c, std::less<>());
+  });
+}
+
+//! std::array can only be benchmarked at sizes known at compile time, which
+//! are those of the sorting networks and just above.
+template <std::size_t N, class Sort>
+void run_array_sort(benchmark::State &state, Sort sort) {
+  const auto values = trx_bench::make_input<int>(N, state.range(0));
+  std::array<int, N> input;
+  std::copy(values.begin(), values.end(), input.begin());
+  std::vector<std::array<int, N> > copies(4096/N+1);
+  for (auto _ : state) {
+    state.PauseTiming();
+    for (auto &copy : copies)
+      copy = input;
+    state.ResumeTiming();
+    for (auto &copy : copies)
+      sort(copy);
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations()*copies.size()*N);
+}
+
+template <std::size_t N>
+void std_sort_array(benchmark::State &state) {
+  run_array_sort<N>(state, [](std::array<int, N> &c) {
+    std::sort(c.begin(), c.end());
+  });
+}
+
+template <std::size_t N>
+void trx_sort_array(benchmark::State &state) {
+  run_array_sort<N>(state, [](std::array<int, N> &c) { trx::sort(c); });
+}
+
+void distributions_only(benchmark::internal::Benchmark *bench) {
+  bench->ArgName("dist");
+  for (std::int64_t shape : trx_bench::distributions)
+    bench->Arg(shape);
+}
+
+void large(benchmark::internal::Benchmark *bench) {
+  trx_bench::size_and_distribution(bench, trx_bench::max_size);
+}
+
+void node_sized(benchmark::internal::Benchmark *bench) {
+  trx_bench::size_and_distribution(bench, trx_bench::max_node_size);
+}
+
+} // namespace
+
+// contiguous containers of radix-sortable values
+BENCHMARK_TEMPLATE(std_sort, std::vector<int>)->Apply(large);
+BENCHMARK_TEMPLATE(trx_sort, std::vector<int>)->Apply(large);
+BENCHMARK_TEMPLATE(trx_par_sort, std::vector<int>)->Apply(large);
+BENCHMARK_TEMPLATE(std_sort_greater, std::vector<double>)->Apply(large);
+BENCHMARK_TEMPLATE(trx_sort_greater, std::vector<double>)->Apply(large);
+BENCHMARK_TEMPLATE(std_stable_sort, std::vector<int>)->Apply(large);
+BENCHMARK_TEMPLATE(trx_stable_sort, std::vector<int>)->Apply(large);
+
+// values compared through a function call
+BENCHMARK_TEMPLATE(std_sort, std::vector<std::string>)->Apply(node_sized);
+BENCHMARK_TEMPLATE(trx_sort, std::vector<std::string>)->Apply(node_sized);
+BENCHMARK_TEMPLATE(std_stable_sort, std::vector<std::string>)
+    ->Apply(node_sized);
+BENCHMARK_TEMPLATE(trx_stable_sort, std::vector<std::string>)
+    ->Apply(node_sized);
+
+// random access, not contiguous
+BENCHMARK_TEMPLATE(std_sort, std::deque<int>)->Apply(large);
+BENCHMARK_TEMPLATE(trx_sort, std::deque<int>)->Apply(large);
+
+// node-based containers, sorted by their member function or gathered
+BENCHMARK_TEMPLATE(member_sort, std::list<int>)->Apply(node_sized);
+BENCHMARK_TEMPLATE(trx_sort, std::list<int>)->Apply(node_sized);
+BENCHMARK_TEMPLATE(member_sort, std::forward_list<int>)->Apply(node_sized);
+BENCHMARK_TEMPLATE(trx_sort, std::forward_list<int>)->Apply(node_sized);
+
+// std::array, sorted by networks up to 32 elements
+BENCHMARK_TEMPLATE(std_sort_array, 4)->Apply(distributions_only);
+BENCHMARK_TEMPLATE(trx_sort_array, 4)->Apply(distributions_only);
+BENCHMARK_TEMPLATE(std_sort_array, 8)->Apply(distributions_only);
+BENCHMARK_TEMPLATE(trx_sort_array, 8)->Apply(distributions_only);
+BENCHMARK_TEMPLATE(std_sort_array, 16)->Apply(distributions_only);
+BENCHMARK_TEMPLATE(trx_sort_array, 16)->Apply(distributions_only);
+BENCHMARK_TEMPLATE(std_sort_array, 32)->Apply(distributions_only);
+BENCHMARK_TEMPLATE(trx_sort_array, 32)->Apply(distributions_only);
+BENCHMARK_TEMPLATE(std_sort_array, 64)->Apply(distributions_only);
+BENCHMARK_TEMPLATE(trx_sort_array, 64)->Apply(distributions_only);
@@ -3,226 +3,5626 @@
 
 #include <algorithm>
 #include <array>
+#include <cstdint>
+#include <cstring>
 #include <deque>
 #include <forward_list>
 #include <functional>
+#include <iterator>
+#include <limits>
 #include <list>
+#include <memory>
+#include <string>
+#include <tuple>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
+#include "execution.h"
+#include "instrumentation.h"
+#include "memory_resource.h"
+#include "simd.h"
 #include "type_traits.h"
 
 namespace trx {
+//! Customization point of trx::sort for user containers.
+/*!
+  Customization point of trx::sort for user containers. trx::sort calls
+  sorter<Container>::sort(container, comp) when it exists, where comp is the
+  comparison function object by lvalue reference (std::less<> when none is
+  given). Otherwise containers with random access iterators are sorted as a
+  range and the other ones through their sort member function.
+  trx::partial_sort and trx::nth_element likewise call
+  sorter<Container>::partial_sort(container, k, comp) and
+  sorter<Container>::nth_element(container, n, comp) when they exist, and
+  sorter<Container>::sort(container, comp) otherwise.
+
+  Example
+  template <>
+  struct trx::sorter<ring_buffer> {
+    template <class Comp>
+    static void sort(ring_buffer &buffer, Comp &comp) {
+      buffer.linearize();
+      std::sort(buffer.data(), buffer.data()+buffer.size(), comp);
+    }
+  };
+*/
+template <class Container, class Enable = void>
+struct sorter {};
+
+//! Tag selecting the node gathering sort of std::list and std::forward_list.
+/*!
+  Tag selecting the node gathering sort of std::list and std::forward_list,
+  see sort(container, comp, tag). The scratch buffer is taken from the
+  allocator, which is rebound to the buffer's element type; list_gather uses
+  std::allocator, list_gather_with(allocator) any other one, like an arena.
+*/
+template <class Allocator = void>
+struct list_gather_t {
+  Allocator allocator;
+};
+
+template <>
+struct list_gather_t<void> {};
+
+constexpr list_gather_t<> list_gather{};
+
+//! Returns a list_gather_t taking its scratch buffer from allocator.
+template <class Allocator>
+inline list_gather_t<Allocator> list_gather_with(const Allocator &allocator) {
+  return list_gather_t<Allocator>{allocator};
+}
+
+//! Unary predicate returning true for any value.
+struct any_value {
+  template <class T>
+  constexpr bool operator()(const T &) const noexcept { return true; }
+};
+
+//! Unary predicate returning comp(value, bound).
+/*!
+  Unary predicate returning comp(value, bound). best_if recognizes the
+  predicates returned by less_than, greater_than, not_greater_than and
+  not_less_than, as well as any_value, and searches contiguous ranges of
+  arithmetic values with them through SIMD kernels, when the bound has the
+  type of the elements.
+*/
+template <class T, class Comp>
+struct compare_to {
+  T bound;
+  Comp comp;
+
+  template <class U>
+  constexpr bool operator()(const U &value) const {
+    return comp(value, bound);
+  }
+};
+
+//! Returns a predicate telling whether a value is less than bound.
+template <class T>
+constexpr compare_to<T, std::less<> > less_than(T bound) {
+  return {bound, std::less<>()};
+}
+
+//! Returns a predicate telling whether a value is greater than bound.
+template <class T>
+constexpr compare_to<T, std::greater<> > greater_than(T bound) {
+  return {bound, std::greater<>()};
+}
+
+//! Returns a predicate telling whether a value is not greater than bound.
+template <class T>
+constexpr compare_to<T, std::less_equal<> > not_greater_than(T bound) {
+  return {bound, std::less_equal<>()};
+}
+
+//! Returns a predicate telling whether a value is not less than bound.
+template <class T>
+constexpr compare_to<T, std::greater_equal<> > not_less_than(T bound) {
+  return {bound, std::greater_equal<>()};
+}
+
+//! Reducers of reduce_if.
+/*!
+  Reducers of reduce_if. A reducer provides, for a range [first, last) of
+  ForwardIt, the member functions
+    state init(last), returning the state of an empty range,
+    add(state &, it, last), folding the matching element *it into state,
+    merge(state &left, const state &right, last), folding into left the state
+      of the range just after it,
+  all of them const. The final state is the result.
+  The reducers returned by reduce_best with std::less or std::greater,
+  reduce_min, reduce_max and reduce_count let reduce_if go through the SIMD
+  kernels, as best_if does.
+*/
+//! Reducer keeping the first best matching element, like best_if.
+template <class Comp>
+struct best_reducer {
+  Comp comp;
+
+  template <class ForwardIt>
+  ForwardIt init(const ForwardIt &last) const { return last; }
+
+  template <class ForwardIt>
+  void add(ForwardIt &best, const ForwardIt &it,
+           const ForwardIt &last) const {
+    if (best == last || comp(*it, *best))
+      best = it;
+  }
+
+  template <class ForwardIt>
+  void merge(ForwardIt &best, const ForwardIt &right,
+             const ForwardIt &last) const {
+    if (right != last && (best == last || comp(*right, *best)))
+      best = right;
+  }
+};
+
+//! Reducer counting the matching elements.
+struct count_reducer {
+  template <class ForwardIt>
+  std::size_t init(const ForwardIt &) const { return 0; }
+
+  template <class ForwardIt>
+  void add(std::size_t &count, const ForwardIt &, const ForwardIt &) const {
+    ++count;
+  }
+
+  template <class ForwardIt>
+  void merge(std::size_t &count, std::size_t right,
+             const ForwardIt &) const {
+    count += right;
+  }
+};
+
+//! Reducer summing the matching elements as T, or as their value type if T
+//! is void, starting from T().
+template <class T = void>
+struct sum_reducer {
+  template <class ForwardIt>
+  using sum_type = std::conditional_t<std::is_void<T>::value,
+      typename std::iterator_traits<ForwardIt>::value_type, T>;
+
+  template <class ForwardIt>
+  sum_type<ForwardIt> init(const ForwardIt &) const {
+    return sum_type<ForwardIt>();
+  }
+
+  template <class ForwardIt>
+  void add(sum_type<ForwardIt> &sum, const ForwardIt &it,
+           const ForwardIt &) const {
+    sum += *it;
+  }
+
+  template <class ForwardIt>
+  void merge(sum_type<ForwardIt> &sum, const sum_type<ForwardIt> &right,
+             const ForwardIt &) const {
+    sum += right;
+  }
+};
+
+//! Reducer keeping the first matching element.
+struct first_reducer {
+  template <class ForwardIt>
+  ForwardIt init(const ForwardIt &last) const { return last; }
+
+  template <class ForwardIt>
+  void add(ForwardIt &first, const ForwardIt &it,
+           const ForwardIt &last) const {
+    if (first == last)
+      first = it;
+  }
+
+  template <class ForwardIt>
+  void merge(ForwardIt &first, const ForwardIt &right,
+             const ForwardIt &last) const {
+    if (first == last)
+      first = right;
+  }
+};
+
+//! Reducer keeping the last matching element.
+struct last_reducer {
+  template <class ForwardIt>
+  ForwardIt init(const ForwardIt &last) const { return last; }
+
+  template <class ForwardIt>
+  void add(ForwardIt &found, const ForwardIt &it, const ForwardIt &) const {
+    found = it;
+  }
+
+  template <class ForwardIt>
+  void merge(ForwardIt &found, const ForwardIt &right,
+             const ForwardIt &last) const {
+    if (right != last)
+      found = right;
+  }
+};
+
+//! Returns a reducer keeping the first best matching element as ordered by
+//! comp.
+template <class Comp>
+constexpr best_reducer<Comp> reduce_best(Comp comp) {
+  return {comp};
+}
+
+//! Returns a reducer keeping the first least matching element.
+constexpr best_reducer<std::less<> > reduce_min() {
+  return {std::less<>()};
+}
+
+//! Returns a reducer keeping the first greatest matching element.
+constexpr best_reducer<std::greater<> > reduce_max() {
+  return {std::greater<>()};
+}
+
+//! Returns a reducer counting the matching elements.
+constexpr count_reducer reduce_count() { return {}; }
+
+//! Returns a reducer summing the matching elements as T, or as their value
+//! type if T is void.
+template <class T = void>
+constexpr sum_reducer<T> reduce_sum() { return {}; }
+
+//! Returns a reducer keeping the first matching element.
+constexpr first_reducer reduce_first() { return {}; }
+
+//! Returns a reducer keeping the last matching element.
+constexpr last_reducer reduce_last() { return {}; }
+
 //! helper function/class templates for the current header
 namespace detail_algorithm_trx {
-//! sort's helper for std::list and std::forward_list
-template <class T, class Allo, template <class, class> class Container>
-inline std::enable_if_t<
-    std::is_same<Container<T, Allo>, std::list<T, Allo> >::value ||
-    std::is_same<Container<T, Allo>, std::forward_list<T, Allo> >::value,
-    void> sort_impl(Container<T, Allo> &container) {
-  container.sort();
+//! Maps the values of T to the unsigned integers of trx::radix_sort_key,
+//! whose order is reversed if Descending is true. Only instantiated for the
+//! types satisfying trx::is_radix_sortable.
+template <class T, bool Descending>
+struct radix_key {
+  using type = typename radix_sort_key<T>::type;
+
+  type operator()(const T &value) const
+      noexcept(noexcept(radix_sort_key<T>::key(value))) {
+    const type bits = radix_sort_key<T>::key(value);
+    return Descending ? static_cast<type>(~bits) : bits;
+  }
+};
+
+//! Checks whether radix_sort can sort a range of T: its keys are given by
+//! trx::radix_sort_key, and its scratch buffer is built of default
+//! constructed elements.
+template <class T>
+struct has_radix_key : std::integral_constant<bool,
+    is_radix_sortable<T>::value && std::is_default_constructible<T>::value &&
+    std::is_move_assignable<T>::value> {};
+
+//! Tells whether comp sorts T like operator< (value 1) or operator> (value
+//! -1), which is when radix_sort can replace it. 0 otherwise.
+template <class T, class Comp>
+struct radix_direction : std::integral_constant<int, 0> {};
+
+template <class T>
+struct radix_direction<T, std::less<T> > : std::integral_constant<int, 1> {};
+
+template <class T>
+struct radix_direction<T, std::less<> > : std::integral_constant<int, 1> {};
+
+template <class T>
+struct radix_direction<T, std::greater<T> >
+    : std::integral_constant<int, -1> {};
+
+template <class T>
+struct radix_direction<T, std::greater<> >
+    : std::integral_constant<int, -1> {};
+
+#if TRX_INSTRUMENTATION
+//! Counting the comparisons does not change the algorithms picked.
+template <class T, class Comp>
+struct radix_direction<T, detail_instrumentation_trx::counting_compare<Comp> >
+    : radix_direction<T, Comp> {};
+#endif
+
+//! Scratch buffers up to this many bytes are kept by their thread for the
+//! next sort, larger ones are freed.
+constexpr std::size_t scratch_retained_bytes = std::size_t(1) << 20;
+
+using detail_memory_resource_trx::current_scratch_resource;
+using detail_memory_resource_trx::current_scratch_setting;
+using detail_memory_resource_trx::scratch_scope;
+using detail_memory_resource_trx::scratch_setting;
+
+using detail_instrumentation_trx::call_scope;
+using detail_instrumentation_trx::count_moves;
+using detail_instrumentation_trx::counted;
+using detail_instrumentation_trx::note_backend;
+using backend = instrumentation::backend;
+
+//! A scratch buffer of T borrowed from the one kept by the calling thread, so
+//! that the sorts run one after the other by a thread allocate it once. A
+//! lease taken while another one is alive gets a buffer of its own, and so
+//! does a lease taken while a resource is installed for the scratch buffers,
+//! which draws from that resource.
+template <class T>
+class scratch_lease {
+public:
+  scratch_lease()
+      : kept_(kept()),
+        owner_(!kept_.in_use && current_scratch_resource() == nullptr) {
+    if (owner_) {
+      kept_.in_use = true;
+      buffer.swap(kept_.buffer);
+    }
+  }
+
+  scratch_lease(const scratch_lease &) = delete;
+  scratch_lease &operator=(const scratch_lease &) = delete;
+
+  ~scratch_lease() {
+    if (!owner_)
+      return;
+    if (!std::is_trivially_destructible<T>::value)
+      buffer.clear();
+    if (buffer.capacity()*sizeof(T) <= scratch_retained_bytes)
+      buffer.swap(kept_.buffer);
+    kept_.in_use = false;
+  }
+
+  scratch_vector<T> buffer;
+
+private:
+  struct kept_buffer {
+    scratch_vector<T> buffer;
+    bool in_use = false;
+  };
+
+  static kept_buffer &kept() {
+    static thread_local kept_buffer value;
+    return value;
+  }
+
+  kept_buffer &kept_;
+  bool owner_;
+};
+
+//! Ranges shorter than this are sorted faster by std::sort than by radix_sort.
+constexpr std::size_t radix_cutoff = 256;
+
+//! One scatter pass of radix_sort: moves [src, src+n) to dst stably ordered
+//! by the byte of key_of(element) at the given shift, whose counts are given.
+template <class SrcIt, class DstIt, class KeyOf>
+void radix_pass(SrcIt src, std::size_t n, DstIt dst, KeyOf &key_of,
+                unsigned shift, const std::size_t (&counts)[256]) {
+  std::size_t offsets[256];
+  for (std::size_t digit = 0, sum = 0; digit != 256; ++digit) {
+    offsets[digit] = sum;
+    sum += counts[digit];
+  }
+  for (std::size_t i = 0; i != n; ++i, ++src)
+    dst[offsets[(key_of(*src) >> shift) & 0xff]++] = std::move(*src);
+  count_moves(n);
+}
+
+//! Sorts the n elements from first by the unsigned integers key_of(element),
+//! one byte per pass from the least significant one, scattering them back
+//! and forth between the range and buffer, which holds at least n elements.
+//! All the byte counts are taken in a single read, and the passes whose byte
+//! is the same for all elements are skipped. The sort is stable. Returns
+//! whether the sorted elements ended in buffer.
+template <class RandomIt, class Buffer, class KeyOf>
+bool radix_passes(RandomIt first, std::size_t n, Buffer &buffer,
+                  KeyOf &key_of) {
+  using key_type = std::decay_t<decltype(key_of(*first))>;
+  constexpr unsigned passes = sizeof(key_type);
+  std::size_t counts[passes][256] = {};
+  RandomIt it = first;
+  for (std::size_t i = 0; i != n; ++i, ++it) {
+    const key_type key = key_of(*it);
+    for (unsigned pass = 0; pass != passes; ++pass)
+      ++counts[pass][(key >> (8*pass)) & 0xff];
+  }
+  bool in_buffer = false;
+  const key_type first_key = key_of(*first);
+  for (unsigned pass = 0; pass != passes; ++pass) {
+    const unsigned shift = 8*pass;
+    if (counts[pass][(first_key >> shift) & 0xff] == n)
+      continue;
+    if (in_buffer)
+      radix_pass(buffer.begin(), n, first, key_of, shift, counts[pass]);
+    else
+      radix_pass(first, n, buffer.begin(), key_of, shift, counts[pass]);
+    in_buffer = !in_buffer;
+  }
+  return in_buffer;
+}
+
+//! Sorts [first, last) by the unsigned integers key_of(element), by
+//! radix_passes through a scratch buffer. The sort is stable.
+template <class RandomIt, class KeyOf>
+void radix_sort(RandomIt first, RandomIt last, KeyOf key_of) {
+  using value_type = typename std::iterator_traits<RandomIt>::value_type;
+  const std::size_t n = std::distance(first, last);
+  scratch_lease<value_type> scratch;
+  scratch_vector<value_type> &buffer = scratch.buffer;
+  if (buffer.size() < n)
+    buffer.resize(n);
+  if (radix_passes(first, n, buffer, key_of)) {
+    std::move(buffer.begin(), buffer.begin()+n, first);
+    count_moves(n);
+  }
+}
+
+//! Moves the first of each group of consecutive elements of [first, last)
+//! equal by eq to out, as std::unique_copy does through move iterators.
+//! Returns the end of the output.
+template <class InputIt, class OutputIt, class Eq>
+OutputIt move_unique(InputIt first, InputIt last, OutputIt out, Eq &eq) {
+  if (first == last)
+    return out;
+  InputIt kept = first;
+  *out = std::move(*first);
+  std::size_t moved = 1;
+  while (++first != last)
+    if (!eq(*kept, *first)) {
+      kept = first;
+      *++out = std::move(*first);
+      ++moved;
+    }
+  count_moves(moved);
+  return ++out;
+}
+
+//! Sorts [first, last) by radix_sort and removes the elements equal by eq to
+//! their predecessor, as std::unique does. When the sorted elements end in
+//! the scratch buffer, the first of each group of equal ones is moved back
+//! and the others are left there, which fuses the removal with the last
+//! move. Returns the end of the unique elements.
+template <class RandomIt, class KeyOf, class Eq>
+RandomIt radix_sort_unique(RandomIt first, RandomIt last, KeyOf key_of,
+                           Eq &eq) {
+  using value_type = typename std::iterator_traits<RandomIt>::value_type;
+  const std::size_t n = std::distance(first, last);
+  scratch_lease<value_type> scratch;
+  scratch_vector<value_type> &buffer = scratch.buffer;
+  if (buffer.size() < n)
+    buffer.resize(n);
+  if (radix_passes(first, n, buffer, key_of))
+    return move_unique(buffer.begin(), buffer.begin()+n, first, eq);
+  return std::unique(first, last, eq);
+}
+
+//! sort_range's helper for comparators radix_sort cannot emulate
+template <class RandomIt, class Comp>
+inline void sort_range(RandomIt first, RandomIt last, Comp &comp,
+                       std::integral_constant<int, 0>) {
+  note_backend(backend::introsort);
+  std::sort(first, last, comp);
+}
+
+//! sort_range's helper for operator< and operator>
+template <class RandomIt, class Comp, int Direction>
+inline void sort_range(RandomIt first, RandomIt last, Comp &comp,
+                       std::integral_constant<int, Direction>) {
+  using value_type = typename std::iterator_traits<RandomIt>::value_type;
+  if (static_cast<std::size_t>(std::distance(first, last)) < radix_cutoff) {
+    note_backend(backend::introsort);
+    std::sort(first, last, comp);
+  } else {
+    note_backend(backend::radix);
+    radix_sort(first, last, radix_key<value_type, Direction == -1>());
+  }
+}
+
+//! Presorted ranges are merged from their runs as long as those are this long
+//! on average.
+constexpr std::size_t adaptive_min_run = 64;
+
+//! Moves the stable merge of the sorted ranges [first1, last1) and
+//! [first2, last2) to out, as std::merge does through move iterators but
+//! comparing the elements as lvalues. Returns the end of the output.
+template <class InputIt1, class InputIt2, class OutputIt, class Comp>
+OutputIt move_merge(InputIt1 first1, InputIt1 last1, InputIt2 first2,
+                    InputIt2 last2, OutputIt out, Comp &comp) {
+  count_moves(std::distance(first1, last1)+std::distance(first2, last2));
+  for (; first1 != last1 && first2 != last2; ++out) {
+    if (comp(*first2, *first1)) {
+      *out = std::move(*first2);
+      ++first2;
+    } else {
+      *out = std::move(*first1);
+      ++first1;
+    }
+  }
+  return std::move(first2, last2, std::move(first1, last1, out));
+}
+
+//! Merges the adjacent pairs of sorted runs of src delimited by bounds into
+//! dst, an odd last run being moved as is. bounds is updated to the merged
+//! runs.
+template <class SrcIt, class DstIt, class Comp>
+void merge_run_pairs(SrcIt src, DstIt dst,
+                     scratch_vector<std::size_t> &bounds, Comp &comp) {
+  const std::size_t runs = bounds.size()-1;
+  std::size_t i = 0, merged = 0;
+  for (; i+1 < runs; i += 2, ++merged) {
+    move_merge(src+bounds[i], src+bounds[i+1], src+bounds[i+1],
+               src+bounds[i+2], dst+bounds[i], comp);
+    bounds[merged] = bounds[i];
+  }
+  if (i < runs) {
+    std::move(src+bounds[i], src+bounds[i+1], dst+bounds[i]);
+    count_moves(bounds[i+1]-bounds[i]);
+    bounds[merged++] = bounds[i];
+  }
+  bounds[merged] = bounds[runs];
+  bounds.resize(merged+1);
+}
+
+//! Merges the sorted ranges [first, middle) and [middle, last) in place, as
+//! std::inplace_merge does but through a scratch buffer holding the second
+//! range, which is merged from the back.
+template <class RandomIt, class Comp>
+void merge_suffix(RandomIt first, RandomIt middle, RandomIt last,
+                  Comp &comp) {
+  using value_type = typename std::iterator_traits<RandomIt>::value_type;
+  scratch_lease<value_type> scratch;
+  scratch_vector<value_type> &buffer = scratch.buffer;
+  buffer.assign(std::make_move_iterator(middle),
+                std::make_move_iterator(last));
+  count_moves(buffer.size());
+  RandomIt a = middle, out = last;
+  for (auto b = buffer.end(); b != buffer.begin();) {
+    if (a != first && comp(*(b-1), *(a-1)))
+      *--out = std::move(*--a);
+    else
+      *--out = std::move(*--b);
+  }
+  count_moves(std::distance(a, last));
+}
+
+//! Sorts [first, last) by merging its maximal runs when it is presorted:
+//! ascending runs are kept, strictly descending ones reversed, so that sorted
+//! and reverse sorted ranges take O(n). When there are too many runs, a long
+//! sorted prefix is merged with the rest sorted by sort(first, last), else
+//! the whole range is sorted by it. Stable if sort is.
+template <class RandomIt, class Comp, class Sort>
+void adaptive_sort(RandomIt first, RandomIt last, Comp &comp, Sort sort) {
+  using value_type = typename std::iterator_traits<RandomIt>::value_type;
+  const std::size_t n = std::distance(first, last);
+  if (n < adaptive_min_run) {
+    sort(first, last);
+    return;
+  }
+  const std::size_t max_runs = n/adaptive_min_run+1;
+  scratch_vector<std::size_t> bounds(1, 0);
+  for (std::size_t i = 0, j; i < n; i = j) {
+    if (bounds.size() > max_runs) {
+      const std::size_t prefix = bounds[1];
+      if (prefix < n/2) {
+        sort(first, last);
+      } else {
+        sort(first+prefix, last);
+        merge_suffix(first, first+prefix, last, comp);
+      }
+      return;
+    }
+    j = i+1;
+    if (j < n && comp(first[j], first[i])) {
+      while (j+1 < n && comp(first[j+1], first[j]))
+        ++j;
+      std::reverse(first+i, first+(++j));
+    } else {
+      while (j < n && !comp(first[j], first[j-1]))
+        ++j;
+    }
+    bounds.push_back(j);
+  }
+  note_backend(backend::run_merge);
+  if (bounds.size() == 2)
+    return;
+  // the buffer takes over the runs, so the first pass merges back
+  scratch_lease<value_type> scratch;
+  scratch_vector<value_type> &buffer = scratch.buffer;
+  buffer.assign(std::make_move_iterator(first), std::make_move_iterator(last));
+  count_moves(n);
+  bool in_buffer = true;
+  for (; bounds.size() > 2; in_buffer = !in_buffer) {
+    if (in_buffer)
+      merge_run_pairs(buffer.begin(), first, bounds, comp);
+    else
+      merge_run_pairs(first, buffer.begin(), bounds, comp);
+  }
+  if (in_buffer) {
+    std::move(buffer.begin(), buffer.end(), first);
+    count_moves(n);
+  }
+}
+
+//! compare_exchange's helper for arithmetic elements: both are selected from
+//! the same comparison, so that equivalent or unordered elements are kept.
+//! Integers lower to conditional moves.
+template <class T, class Comp>
+constexpr void select_exchange(T &a, T &b, Comp &comp, std::false_type) {
+  const bool swapped = comp(b, a);
+  const T low = swapped ? b : a, high = swapped ? a : b;
+  a = low;
+  b = high;
+}
+
+//! select_exchange's helper for floating-point elements. Two selects on one
+//! comparison are lowered to a branch, so high is selected on the quiet
+//! comparison of a and b, which holds exactly when comp(b, a) does but is
+//! not merged with it: low then lowers to minss or maxss, and high to a
+//! conditional move.
+template <class T, class Comp>
+constexpr void select_exchange(T &a, T &b, Comp &comp, std::true_type) {
+  const T low = comp(b, a) ? b : a;
+  const T high = (radix_direction<T, Comp>::value == 1 ?
+                  __builtin_isgreater(a, b) : __builtin_isless(a, b)) ? a : b;
+  a = low;
+  b = high;
+}
+
+//! Orders the elements a and b: swaps them if b comes before a. Arithmetic
+//! elements ordered by operator< or operator> are selected without branches.
+template <class T, class Comp>
+constexpr void compare_exchange(T &a, T &b, Comp &comp, std::true_type) {
+#if defined(__GNUC__) || defined(__clang__)
+  select_exchange(a, b, comp, std::is_floating_point<T>());
+#else
+  select_exchange(a, b, comp, std::false_type());
+#endif
+}
+
+template <class T, class Comp>
+constexpr void compare_exchange(T &a, T &b, Comp &comp, std::false_type) {
+  if (comp(b, a)) {
+    T moved(std::move(a));
+    a = std::move(b);
+    b = std::move(moved);
+  }
+}
+
+template <class T, class Comp>
+constexpr void compare_exchange(T &a, T &b, Comp &comp) {
+  compare_exchange(a, b, comp, std::integral_constant<bool,
+      std::is_arithmetic<T>::value && radix_direction<T, Comp>::value != 0>());
+}
+
+//! A comparator of a sorting network, ordering the elements at I and J.
+template <std::size_t I, std::size_t J>
+struct comparator {};
+
+//! A sorting network, as its comparators applied in order.
+template <class... Comparators>
+struct sorting_network {};
+
+//! Sorts first[0, N) by applying a sorting network for N elements.
+template <class RandomIt, class Comp, std::size_t... I, std::size_t... J>
+constexpr void apply_network(RandomIt first, Comp &comp,
+                             sorting_network<comparator<I, J>...>) {
+  const int expand[] = {0, (compare_exchange(first[I], first[J], comp), 0)...};
+  (void)expand, (void)first, (void)comp;
+}
+
+//! The sorting networks with the fewest comparators for up to 8 elements.
+template <std::size_t N>
+struct optimal_network {
+  using type = sorting_network<>;
+};
+
+template <>
+struct optimal_network<2> {
+  using type = sorting_network<comparator<0, 1> >;
+};
+
+template <>
+struct optimal_network<3> {
+  using type = sorting_network<comparator<0, 2>, comparator<0, 1>,
+                               comparator<1, 2> >;
+};
+
+template <>
+struct optimal_network<4> {
+  using type = sorting_network<comparator<0, 2>, comparator<1, 3>,
+                               comparator<0, 1>, comparator<2, 3>,
+                               comparator<1, 2> >;
+};
+
+template <>
+struct optimal_network<5> {
+  using type = sorting_network<comparator<0, 3>, comparator<1, 4>,
+                               comparator<0, 2>, comparator<1, 3>,
+                               comparator<0, 1>, comparator<2, 4>,
+                               comparator<1, 2>, comparator<3, 4>,
+                               comparator<2, 3> >;
+};
+
+template <>
+struct optimal_network<6> {
+  using type = sorting_network<comparator<0, 5>, comparator<1, 3>,
+                               comparator<2, 4>, comparator<1, 2>,
+                               comparator<3, 4>, comparator<0, 3>,
+                               comparator<2, 5>, comparator<0, 1>,
+                               comparator<2, 3>, comparator<4, 5>,
+                               comparator<1, 2>, comparator<3, 4> >;
+};
+
+template <>
+struct optimal_network<7> {
+  using type = sorting_network<comparator<0, 6>, comparator<2, 3>,
+                               comparator<4, 5>, comparator<0, 2>,
+                               comparator<1, 4>, comparator<3, 6>,
+                               comparator<0, 1>, comparator<2, 5>,
+                               comparator<3, 4>, comparator<1, 2>,
+                               comparator<4, 6>, comparator<2, 3>,
+                               comparator<4, 5>, comparator<1, 2>,
+                               comparator<3, 4>, comparator<5, 6> >;
+};
+
+template <>
+struct optimal_network<8> {
+  using type = sorting_network<comparator<0, 2>, comparator<1, 3>,
+                               comparator<4, 6>, comparator<5, 7>,
+                               comparator<0, 4>, comparator<1, 5>,
+                               comparator<2, 6>, comparator<3, 7>,
+                               comparator<0, 1>, comparator<2, 3>,
+                               comparator<4, 5>, comparator<6, 7>,
+                               comparator<2, 4>, comparator<3, 5>,
+                               comparator<1, 4>, comparator<3, 6>,
+                               comparator<1, 2>, comparator<3, 4>,
+                               comparator<5, 6> >;
+};
+
+//! Ranges up to this long are sorted by optimal_network.
+constexpr std::size_t network_cutoff = 8;
+
+//! Sorts first[0, n), where n <= network_cutoff, by the optimal network for
+//! n elements.
+template <class RandomIt, class Comp>
+void network_sort(RandomIt first, std::size_t n, Comp &comp) {
+  note_backend(backend::network);
+  switch (n) {
+  case 2: apply_network(first, comp, optimal_network<2>::type()); break;
+  case 3: apply_network(first, comp, optimal_network<3>::type()); break;
+  case 4: apply_network(first, comp, optimal_network<4>::type()); break;
+  case 5: apply_network(first, comp, optimal_network<5>::type()); break;
+  case 6: apply_network(first, comp, optimal_network<6>::type()); break;
+  case 7: apply_network(first, comp, optimal_network<7>::type()); break;
+  case 8: apply_network(first, comp, optimal_network<8>::type()); break;
+  default: break;
+  }
+}
+
+//! std::arrays up to this long are sorted by a sorting network unrolled at
+//! compile time.
+constexpr std::size_t array_network_cutoff = 32;
+
+//! The comparators of a sorting network for N elements, as pairs of indices.
+template <std::size_t N>
+struct network_table {
+  std::size_t size;
+  std::size_t low[N*N+1], high[N*N+1];
+};
+
+//! Returns the comparators of Batcher's odd-even merge sort for N elements,
+//! those reaching past N being dropped when N is not a power of two.
+template <std::size_t N>
+constexpr network_table<N> make_batcher_network() {
+  network_table<N> table{};
+  for (std::size_t p = 1; p < N; p *= 2) {
+    for (std::size_t k = p; k >= 1; k /= 2) {
+      for (std::size_t j = k%p; j+k < N; j += 2*k) {
+        for (std::size_t i = 0; i < k && i+j+k < N; ++i) {
+          if ((i+j)/(2*p) == (i+j+k)/(2*p)) {
+            table.low[table.size] = i+j;
+            table.high[table.size] = i+j+k;
+            ++table.size;
+          }
+        }
+      }
+    }
+  }
+  return table;
+}
+
+template <std::size_t N>
+struct batcher_network {
+  static constexpr network_table<N> value = make_batcher_network<N>();
+};
+
+template <std::size_t N>
+constexpr network_table<N> batcher_network<N>::value;
+
+//! Sorts a std::array by the comparators of batcher_network<N>, expanded so
+//! that every index is a constant.
+template <class T, std::size_t N, class Comp, std::size_t... K>
+constexpr void apply_batcher_network(std::array<T, N> &container, Comp &comp,
+                                     std::index_sequence<K...>) {
+  const int expand[] = {0, (compare_exchange(
+      container[batcher_network<N>::value.low[K]],
+      container[batcher_network<N>::value.high[K]], comp), 0)...};
+  (void)expand;
+}
+
+//! Sorts a std::array of at most 8 elements by the optimal network.
+template <class T, std::size_t N, class Comp>
+constexpr void array_network_sort(std::array<T, N> &container, Comp &comp,
+                                  std::true_type) {
+  apply_network(container.begin(), comp,
+                typename optimal_network<N>::type());
+}
+
+//! Sorts a longer std::array by Batcher's network.
+template <class T, std::size_t N, class Comp>
+constexpr void array_network_sort(std::array<T, N> &container, Comp &comp,
+                                  std::false_type) {
+  apply_batcher_network(
+      container, comp,
+      std::make_index_sequence<batcher_network<N>::value.size>());
+}
+
+//! Sorts a random access range, picking at compile time radix_sort for the
+//! radix sortable types ordered by std::less or std::greater, std::sort
+//! otherwise.
+//! Presorted ranges are merged from their runs instead.
+template <class RandomIt, class Comp>
+inline void sort_range(RandomIt first, RandomIt last, Comp &comp) {
+  using value_type = typename std::iterator_traits<RandomIt>::value_type;
+  constexpr int direction = has_radix_key<value_type>::value ?
+      radix_direction<value_type, Comp>::value : 0;
+  adaptive_sort(first, last, comp, [&comp](RandomIt lo, RandomIt hi) {
+    sort_range(lo, hi, comp, std::integral_constant<int, direction>());
+  });
+}
+
+//! merge_sort insertion sorts runs of this many elements before merging them.
+constexpr std::size_t merge_sort_block = 32;
+
+//! Sorts [first, last) by insertion, keeping the order of equivalent elements.
+template <class RandomIt, class Comp>
+void insertion_sort(RandomIt first, RandomIt last, Comp &comp) {
+  using value_type = typename std::iterator_traits<RandomIt>::value_type;
+  if (first == last)
+    return;
+  std::size_t moves = 0;
+  for (RandomIt it = first+1; it != last; ++it) {
+    if (!comp(*it, *(it-1)))
+      continue;
+    value_type held = std::move(*it);
+    RandomIt hole = it;
+    do {
+      *hole = std::move(*(hole-1));
+      --hole;
+      ++moves;
+    } while (hole != first && comp(held, *(hole-1)));
+    *hole = std::move(held);
+    moves += 2;
+  }
+  count_moves(moves);
+}
+
+//! Merges every pair of adjacent sorted runs of the given width from src into
+//! dst.
+template <class SrcIt, class DstIt, class Comp>
+void merge_pass(SrcIt src, DstIt dst, std::size_t n, std::size_t width,
+                Comp &comp) {
+  for (std::size_t lo = 0; lo < n; lo += 2*width) {
+    const std::size_t mid = std::min(n, lo+width), hi = std::min(n, mid+width);
+    move_merge(src+lo, src+mid, src+mid, src+hi, dst+lo, comp);
+  }
+}
+
+//! Sorts [first, last) keeping the order of equivalent elements, like
+//! std::stable_sort but taking its memory from the scratch buffers: blocks
+//! are insertion sorted, then merged pairwise back and forth through a
+//! buffer.
+template <class RandomIt, class Comp>
+void merge_sort(RandomIt first, RandomIt last, Comp &comp) {
+  using value_type = typename std::iterator_traits<RandomIt>::value_type;
+  const std::size_t n = std::distance(first, last);
+  note_backend(backend::merge_sort);
+  for (std::size_t lo = 0; lo < n; lo += merge_sort_block)
+    insertion_sort(first+lo, first+std::min(n, lo+merge_sort_block), comp);
+  if (n <= merge_sort_block)
+    return;
+  // the buffer takes over the sorted blocks, so the first pass merges back
+  scratch_lease<value_type> scratch;
+  scratch_vector<value_type> &buffer = scratch.buffer;
+  buffer.assign(std::make_move_iterator(first), std::make_move_iterator(last));
+  count_moves(n);
+  bool in_buffer = true;
+  for (std::size_t w = merge_sort_block; w < n;
+       w *= 2, in_buffer = !in_buffer) {
+    if (in_buffer)
+      merge_pass(buffer.begin(), first, n, w, comp);
+    else
+      merge_pass(first, buffer.begin(), n, w, comp);
+  }
+  if (in_buffer) {
+    std::move(buffer.begin(), buffer.end(), first);
+    count_moves(n);
+  }
+}
+
+//! Sorts a random access range, keeping the order of equivalent elements.
+//! Presorted ranges are merged from their runs, others merge sorted.
+template <class RandomIt, class Comp>
+inline void stable_sort_range(RandomIt first, RandomIt last, Comp &comp) {
+  adaptive_sort(first, last, comp, [&comp](RandomIt lo, RandomIt hi) {
+    merge_sort(lo, hi, comp);
+  });
+}
+
+using std::begin;
+using std::end;
+
+//! Returns begin(container), found by argument-dependent lookup or std::begin.
+template <class Container>
+inline auto adl_begin(Container &container) -> decltype(begin(container)) {
+  return begin(container);
+}
+
+//! Returns end(container), found by argument-dependent lookup or std::end.
+template <class Container>
+inline auto adl_end(Container &container) -> decltype(end(container)) {
+  return end(container);
+}
+
+//! Checks whether the iterators of Container are random access iterators.
+template <class Container, class Enable = void>
+struct is_random_access_container : std::false_type {};
+
+template <class Container>
+struct is_random_access_container<Container, std::enable_if_t<
+    std::is_base_of<std::random_access_iterator_tag,
+                    typename std::iterator_traits<decltype(adl_begin(
+                        std::declval<Container &>()))>::iterator_category
+                    >::value> > : std::true_type {};
+
+//! Overloads taking a higher priority_tag are preferred by overload
+//! resolution, as priority_tag<N> derives from priority_tag<N-1>.
+template <unsigned N>
+struct priority_tag : priority_tag<N-1> {};
+
+template <>
+struct priority_tag<0> {};
+
+//! Calls f(block_first, block_last) with the pointers delimiting the blocks
+//! of contiguous elements of the range [first, last) of segmented
+//! iterators, in order. Returns f.
+template <class RandomIt, class F>
+F for_each_block(RandomIt first, RandomIt last, F f) {
+  while (first != last) {
+    const auto block = std::addressof(*first);
+    const auto count = std::min<typename std::iterator_traits<
+        RandomIt>::difference_type>(
+            segmented_iterator<RandomIt>::block_end(first)-block,
+            last-first);
+    f(block, block+count);
+    first += count;
+  }
+  return f;
+}
+
+//! The comparison sorts gather segmented ranges at least this long into a
+//! contiguous buffer.
+constexpr std::size_t segmented_gather_cutoff = 256;
+
+//! Sorts the range [first, last) of segmented iterators by
+//! sort(pointer, pointer) on a contiguous copy, moved from and back to one
+//! block after the other. The sort then compares through pointers rather
+//! than iterators locating their block at each access, and shares the
+//! instantiations of the contiguous containers.
+template <class RandomIt, class Sort>
+void sort_gathered(RandomIt first, RandomIt last, Sort sort) {
+  using value_type = typename std::iterator_traits<RandomIt>::value_type;
+  using pointer = value_type *;
+  scratch_vector<value_type> gathered;
+  gathered.reserve(last-first);
+  for_each_block(first, last, [&gathered](pointer lo, pointer hi) {
+    gathered.insert(gathered.end(), std::make_move_iterator(lo),
+                    std::make_move_iterator(hi));
+  });
+  sort(gathered.data(), gathered.data()+gathered.size());
+  auto from = gathered.begin();
+  for_each_block(first, last, [&from](pointer lo, pointer hi) {
+    const auto next = from+(hi-lo);
+    std::move(from, next, lo);
+    from = next;
+  });
+  count_moves(2*gathered.size());
+}
+
+//! sort_segmented's helper for comparators radix_sort cannot emulate
+template <class RandomIt, class Comp>
+inline void sort_segmented(RandomIt first, RandomIt last, Comp &comp,
+                           std::integral_constant<int, 0>) {
+  using pointer = typename std::iterator_traits<RandomIt>::value_type *;
+  if (static_cast<std::size_t>(last-first) < segmented_gather_cutoff)
+    sort_range(first, last, comp);
+  else
+    sort_gathered(first, last, [&comp](pointer lo, pointer hi) {
+      sort_range(lo, hi, comp);
+    });
+}
+
+//! sort_segmented's helper for operator< and operator>, as the passes of
+//! radix_sort read and write the blocks sequentially already
+template <class RandomIt, class Comp, int Direction>
+inline void sort_segmented(RandomIt first, RandomIt last, Comp &comp,
+                           std::integral_constant<int, Direction>) {
+  sort_range(first, last, comp);
+}
+
+//! Sorts a random access range as sort_range does, the comparison sorts of
+//! segmented ranges going through a contiguous copy.
+template <class RandomIt, class Comp>
+inline void sort_random_access(RandomIt first, RandomIt last, Comp &comp,
+                               std::true_type) {
+  using value_type = typename std::iterator_traits<RandomIt>::value_type;
+  constexpr int direction = has_radix_key<value_type>::value ?
+      radix_direction<value_type, Comp>::value : 0;
+  sort_segmented(first, last, comp, std::integral_constant<int, direction>());
+}
+
+template <class RandomIt, class Comp>
+inline void sort_random_access(RandomIt first, RandomIt last, Comp &comp,
+                               std::false_type) {
+  sort_range(first, last, comp);
+}
+
+//! Sorts a random access range as stable_sort_range does, segmented ranges
+//! going through a contiguous copy.
+template <class RandomIt, class Comp>
+inline void stable_sort_random_access(RandomIt first, RandomIt last,
+                                      Comp &comp, std::true_type) {
+  using pointer = typename std::iterator_traits<RandomIt>::value_type *;
+  if (static_cast<std::size_t>(last-first) < segmented_gather_cutoff)
+    stable_sort_range(first, last, comp);
+  else
+    sort_gathered(first, last, [&comp](pointer lo, pointer hi) {
+      stable_sort_range(lo, hi, comp);
+    });
+}
+
+template <class RandomIt, class Comp>
+inline void stable_sort_random_access(RandomIt first, RandomIt last,
+                                      Comp &comp, std::false_type) {
+  stable_sort_range(first, last, comp);
+}
+
+//! sort_impl's helper for containers whose trx::sorter is specialized
+template <class Container, class Comp>
+TRX_INSTRUMENTED_CONSTEXPR auto sort_dispatch(Container &container,
+                                              Comp &comp, priority_tag<3>)
+    -> decltype(sorter<Container>::sort(container, comp), void()) {
+  note_backend(backend::sorter);
+  sorter<Container>::sort(container, comp);
+}
+
+//! Returns a pointer to the first element of a contiguous container.
+template <class Container>
+inline auto contiguous_data(Container &container)
+    -> decltype(container.data()) {
+  return container.data();
+}
+
+template <class T, std::size_t N>
+inline T *contiguous_data(T (&container)[N]) noexcept {
+  return container;
+}
+
+//! sort_impl's helper for contiguous containers, sorted through pointers so
+//! that all of them share the instantiations of the C arrays
+template <class Container, class Comp>
+inline std::enable_if_t<is_contiguous_container<Container>::value, void>
+sort_dispatch(Container &container, Comp &comp, priority_tag<2>) {
+  const auto first = contiguous_data(container);
+  sort_range(first, first+std::distance(adl_begin(container),
+                                        adl_end(container)), comp);
+}
+
+//! sort_impl's helper for the other containers traversed by random access
+//! iterators, like std::deque
+template <class Container, class Comp>
+inline std::enable_if_t<is_random_access_container<Container>::value &&
+                        !is_contiguous_container<Container>::value, void>
+sort_dispatch(Container &container, Comp &comp, priority_tag<2>) {
+  sort_random_access(adl_begin(container), adl_end(container), comp,
+                     is_segmented_iterator<decltype(adl_begin(container))>());
+}
+
+//! Tells whether a std::array<T, N> is sorted by a sorting network: up to 8
+//! elements of any type, up to 32 elements cheap to compare.
+template <class T, std::size_t N>
+struct is_network_array : std::integral_constant<bool,
+    N <= network_cutoff ||
+    (N <= array_network_cutoff && is_cheap_to_compare<T>::value)> {};
+
+//! sort_impl's helper for the std::arrays sorted by a sorting network
+//! unrolled at compile time
+template <class T, std::size_t N, class Comp>
+TRX_INSTRUMENTED_CONSTEXPR std::enable_if_t<is_network_array<T, N>::value,
+                                            void>
+sort_dispatch(std::array<T, N> &container, Comp &comp, priority_tag<2>) {
+  note_backend(backend::network);
+  array_network_sort(container, comp,
+                     std::integral_constant<bool, (N <= network_cutoff)>());
+}
+
+//! sort_impl's helper for containers with a sort member function, like
+//! std::list and std::forward_list
+template <class Container, class Comp>
+inline auto sort_dispatch(Container &container, Comp &comp, priority_tag<1>)
+    -> decltype(container.sort(comp), void()) {
+  note_backend(backend::member_sort);
+  container.sort(comp);
+}
+
+//! sort_impl's helper for the containers trx::sort cannot handle
+template <class Container, class Comp>
+inline void sort_dispatch(Container &, Comp &, priority_tag<0>) {
+  static_assert(sizeof(Container) == 0,
+                "trx::sort requires random access iterators, a sort member "
+                "function or a specialization of trx::sorter.");
+}
+
+//! sort's(comp) helper, dispatching on the customization point, the
+//! iterator category and the sort member function of Container
+template <class Container, class Comp>
+TRX_INSTRUMENTED_CONSTEXPR void sort_impl(Container &container, Comp &comp) {
+  const call_scope scope;
+  auto &&counting_comp = counted(comp);
+  sort_dispatch(container, counting_comp, priority_tag<3>());
+}
+
+//! stable_sort's helper for containers whose trx::sorter provides
+//! stable_sort
+template <class Container, class Comp>
+inline auto stable_sort_dispatch(Container &container, Comp &comp,
+                                 priority_tag<2>)
+    -> decltype(sorter<Container>::stable_sort(container, comp), void()) {
+  note_backend(backend::sorter);
+  sorter<Container>::stable_sort(container, comp);
+}
+
+//! stable_sort's helper for random access containers
+template <class Container, class Comp>
+inline std::enable_if_t<is_random_access_container<Container>::value, void>
+stable_sort_dispatch(Container &container, Comp &comp, priority_tag<1>) {
+  stable_sort_random_access(
+      adl_begin(container), adl_end(container), comp,
+      is_segmented_iterator<decltype(adl_begin(container))>());
+}
+
+//! stable_sort's helper for std::list, whose sort member function is stable
+template <class T, class Allo, class Comp>
+inline void stable_sort_dispatch(std::list<T, Allo> &container, Comp &comp,
+                                 priority_tag<1>) {
+  note_backend(backend::member_sort);
+  container.sort(comp);
+}
+
+//! stable_sort's helper for std::forward_list, whose sort member function is
+//! stable
+template <class T, class Allo, class Comp>
+inline void stable_sort_dispatch(std::forward_list<T, Allo> &container,
+                                 Comp &comp, priority_tag<1>) {
+  note_backend(backend::member_sort);
+  container.sort(comp);
+}
+
+//! stable_sort's helper for the containers trx::stable_sort cannot handle
+template <class Container, class Comp>
+inline void stable_sort_dispatch(Container &, Comp &, priority_tag<0>) {
+  static_assert(sizeof(Container) == 0,
+                "trx::stable_sort requires random access iterators, a "
+                "std::list, a std::forward_list or a specialization of "
+                "trx::sorter with a stable_sort member function.");
+}
+
+//! stable_sort's helper
+template <class Container, class Comp>
+inline void stable_sort_impl(Container &container, Comp &comp) {
+  const call_scope scope;
+  auto &&counting_comp = counted(comp);
+  stable_sort_dispatch(container, counting_comp, priority_tag<2>());
+}
+
+//! sort_unique_range's helper for comparators radix_sort cannot emulate
+template <class RandomIt, class Comp, class Eq>
+inline RandomIt sort_unique_range(RandomIt first, RandomIt last, Comp &comp,
+                                  Eq &eq, std::integral_constant<int, 0>) {
+  sort_range(first, last, comp);
+  return std::unique(first, last, eq);
+}
+
+//! sort_unique_range's helper for operator< and operator>
+template <class RandomIt, class Comp, class Eq, int Direction>
+inline RandomIt sort_unique_range(RandomIt first, RandomIt last, Comp &comp,
+                                  Eq &eq,
+                                  std::integral_constant<int, Direction>) {
+  using value_type = typename std::iterator_traits<RandomIt>::value_type;
+  if (static_cast<std::size_t>(std::distance(first, last)) < radix_cutoff) {
+    sort_range(first, last, comp);
+    return std::unique(first, last, eq);
+  }
+  note_backend(backend::radix);
+  return radix_sort_unique(first, last,
+                           radix_key<value_type, Direction == -1>(), eq);
+}
+
+//! Sorts [first, last) as sort_range does and removes the elements equal by
+//! eq to their predecessor. Returns the end of the unique elements.
+template <class RandomIt, class Comp, class Eq>
+inline RandomIt sort_unique_range(RandomIt first, RandomIt last, Comp &comp,
+                                  Eq &eq) {
+  using value_type = typename std::iterator_traits<RandomIt>::value_type;
+  constexpr int direction = has_radix_key<value_type>::value ?
+      radix_direction<value_type, Comp>::value : 0;
+  return sort_unique_range(first, last, comp, eq,
+                           std::integral_constant<int, direction>());
+}
+
+//! Erases the elements of container from first on, when it has an erase
+//! member function, like std::vector and std::deque. Returns the number of
+//! elements before first.
+template <class Container, class It>
+inline auto erase_tail(Container &container, It first, priority_tag<1>)
+    -> decltype(container.erase(first, adl_end(container)), std::size_t()) {
+  const std::size_t size = std::distance(adl_begin(container), first);
+  container.erase(first, adl_end(container));
+  return size;
+}
+
+//! erase_tail's helper for fixed size containers and views, which keep the
+//! elements from first on
+template <class Container, class It>
+inline std::size_t erase_tail(Container &container, It first,
+                              priority_tag<0>) {
+  return std::distance(adl_begin(container), first);
+}
+
+//! sort_unique's helper for containers whose trx::sorter is specialized
+template <class Container, class Comp, class Eq>
+inline auto sort_unique_dispatch(Container &container, Comp &comp, Eq &eq,
+                                 priority_tag<3>)
+    -> decltype(sorter<Container>::sort(container, comp), std::size_t()) {
+  sort_dispatch(container, comp, priority_tag<3>());
+  return erase_tail(container,
+                    std::unique(adl_begin(container), adl_end(container), eq),
+                    priority_tag<1>());
+}
+
+//! sort_unique's helper for contiguous containers, sorted through pointers
+template <class Container, class Comp, class Eq>
+inline std::enable_if_t<is_contiguous_container<Container>::value,
+                        std::size_t>
+sort_unique_dispatch(Container &container, Comp &comp, Eq &eq,
+                     priority_tag<2>) {
+  const auto first = contiguous_data(container);
+  const auto size = std::distance(adl_begin(container), adl_end(container));
+  const auto last = sort_unique_range(first, first+size, comp, eq);
+  return erase_tail(container, adl_begin(container)+(last-first),
+                    priority_tag<1>());
+}
+
+//! sort_unique's helper for the other random access containers
+template <class Container, class Comp, class Eq>
+inline std::enable_if_t<is_random_access_container<Container>::value &&
+                        !is_contiguous_container<Container>::value,
+                        std::size_t>
+sort_unique_dispatch(Container &container, Comp &comp, Eq &eq,
+                     priority_tag<2>) {
+  return erase_tail(container,
+                    sort_unique_range(adl_begin(container),
+                                      adl_end(container), comp, eq),
+                    priority_tag<1>());
+}
+
+//! sort_unique's helper for the std::arrays sorted by a sorting network
+template <class T, std::size_t N, class Comp, class Eq>
+inline std::enable_if_t<is_network_array<T, N>::value, std::size_t>
+sort_unique_dispatch(std::array<T, N> &container, Comp &comp, Eq &eq,
+                     priority_tag<2>) {
+  sort_dispatch(container, comp, priority_tag<2>());
+  return std::unique(container.begin(), container.end(), eq)-
+         container.begin();
+}
+
+//! sort_unique's helper for containers with sort and unique member
+//! functions, like std::list and std::forward_list, whose nodes are relinked
+//! by sort and erased by unique
+template <class Container, class Comp, class Eq>
+inline auto sort_unique_dispatch(Container &container, Comp &comp, Eq &eq,
+                                 priority_tag<1>)
+    -> decltype(container.sort(comp), container.unique(eq), std::size_t()) {
+  note_backend(backend::member_sort);
+  container.sort(comp);
+  container.unique(eq);
+  return std::distance(adl_begin(container), adl_end(container));
+}
+
+//! sort_unique's helper for the containers trx::sort_unique cannot handle
+template <class Container, class Comp, class Eq>
+inline std::size_t sort_unique_dispatch(Container &, Comp &, Eq &,
+                                        priority_tag<0>) {
+  static_assert(sizeof(Container) == 0,
+                "trx::sort_unique requires random access iterators, sort and "
+                "unique member functions or a specialization of trx::sorter.");
+  return 0;
+}
+
+//! sort_unique's helper
+template <class Container, class Comp, class Eq>
+inline std::size_t sort_unique_impl(Container &container, Comp &comp,
+                                    Eq &eq) {
+  const call_scope scope;
+  auto &&counting_comp = counted(comp);
+  return sort_unique_dispatch(container, counting_comp, eq,
+                              priority_tag<3>());
+}
+
+//! element_set extrapolates the size of its table from this many insertions
+//! at least.
+constexpr std::size_t element_set_min_sample = 1024;
+
+//! A set of elements of T, as pointers to them kept in an open addressing
+//! table with linear probing, grown when half full so that its size follows
+//! the number of distinct elements among the n expected insertions: doubled
+//! while most insertions are of elements already there, sized at once for
+//! the rest of the insertions otherwise, which spares the rehashes when the
+//! elements are mostly distinct. Hashes are spread over the table by
+//! Fibonacci hashing, so that hashes differing only in their high bits, as
+//! std::hash gives for multiples of a power of two, do not collide.
+template <class T, class Hash, class Eq>
+class element_set {
+public:
+  element_set(std::size_t n, Hash &hash, Eq &eq)
+      : hash_(hash), eq_(eq), expected_(n) {
+    slots_.buffer.assign(std::size_t(1) << bits_, slot{0, nullptr});
+  }
+
+  //! Returns the address of an element of the set equal to value, or inserts
+  //! its address at and returns nullptr if there is none. The element at
+  //! must have the value of value, or be given it before the next call.
+  const T *insert(const T &value, const T *at) {
+    const std::size_t h = hash_(value);
+    ++inserted_;
+    slot &found = find(value, h);
+    if (found.element != nullptr)
+      return found.element;
+    found = slot{h, at};
+    if (2*++size_ > slots_.buffer.size())
+      grow();
+    return nullptr;
+  }
+
+private:
+  struct slot {
+    std::size_t hash;
+    const T *element;
+  };
+
+  //! Returns the index of the slot where the probes for hash h start.
+  std::size_t home(std::size_t h) const noexcept {
+    return static_cast<std::size_t>(
+        (std::uint64_t(h)*0x9e3779b97f4a7c15u) >> (64-bits_));
+  }
+
+  //! Returns the slot of the element equal to value, whose hash is h, or the
+  //! empty slot where it would go.
+  slot &find(const T &value, std::size_t h) {
+    const std::size_t mask = slots_.buffer.size()-1;
+    for (std::size_t i = home(h);; i = (i+1) & mask) {
+      slot &candidate = slots_.buffer[i];
+      if (candidate.element == nullptr ||
+          (candidate.hash == h && eq_(*candidate.element, value)))
+        return candidate;
+    }
+  }
+
+  void grow() {
+    std::size_t estimate = 0;
+    if (inserted_ >= element_set_min_sample && 2*size_ > inserted_ &&
+        expected_ > inserted_)
+      estimate = size_+(expected_-inserted_)/inserted_*size_;
+    scratch_vector<slot> old(slots_.buffer.get_allocator());
+    old.swap(slots_.buffer);
+    ++bits_;
+    while ((std::size_t(1) << bits_) < 2*estimate)
+      ++bits_;
+    slots_.buffer.assign(std::size_t(1) << bits_, slot{0, nullptr});
+    const std::size_t mask = slots_.buffer.size()-1;
+    for (const slot &entry : old) {
+      if (entry.element == nullptr)
+        continue;
+      std::size_t i = home(entry.hash);
+      while (slots_.buffer[i].element != nullptr)
+        i = (i+1) & mask;
+      slots_.buffer[i] = entry;
+    }
+  }
+
+  Hash &hash_;
+  Eq &eq_;
+  unsigned bits_ = 4;
+  std::size_t size_ = 0;
+  std::size_t inserted_ = 0;
+  std::size_t expected_;
+  scratch_lease<slot> slots_;
+};
+
+//! Moves the first of each group of elements of [first, last) equal by eq
+//! to the front of the range, keeping their order, as std::unique does for
+//! consecutive elements. Returns the end of the unique elements.
+template <class ForwardIt, class Hash, class Eq>
+ForwardIt hash_unique_range(ForwardIt first, ForwardIt last, Hash &hash,
+                            Eq &eq) {
+  using value_type = typename std::iterator_traits<ForwardIt>::value_type;
+  element_set<value_type, Hash, Eq> seen(std::distance(first, last), hash,
+                                         eq);
+  ForwardIt out = first;
+  std::size_t moved = 0;
+  for (; first != last; ++first) {
+    // *out gets the value before the next insertion
+    if (seen.insert(*first, std::addressof(*out)) != nullptr)
+      continue;
+    if (out != first) {
+      *out = std::move(*first);
+      ++moved;
+    }
+    ++out;
+  }
+  count_moves(moved);
+  return out;
+}
+
+//! hash_unique's helper for std::list, whose duplicate nodes are erased
+template <class T, class Allo, class Hash, class Eq>
+inline std::size_t hash_unique_dispatch(std::list<T, Allo> &container,
+                                        Hash &hash, Eq &eq, priority_tag<1>) {
+  element_set<T, Hash, Eq> seen(container.size(), hash, eq);
+  for (auto it = container.begin(); it != container.end();) {
+    if (seen.insert(*it, std::addressof(*it)) != nullptr)
+      it = container.erase(it);
+    else
+      ++it;
+  }
+  return container.size();
+}
+
+//! hash_unique's helper for std::forward_list, whose duplicate nodes are
+//! erased
+template <class T, class Allo, class Hash, class Eq>
+inline std::size_t hash_unique_dispatch(std::forward_list<T, Allo> &container,
+                                        Hash &hash, Eq &eq, priority_tag<1>) {
+  element_set<T, Hash, Eq> seen(
+      std::distance(container.begin(), container.end()), hash, eq);
+  std::size_t size = 0;
+  for (auto prev = container.before_begin(), it = container.begin();
+       it != container.end();) {
+    if (seen.insert(*it, std::addressof(*it)) != nullptr) {
+      it = container.erase_after(prev);
+    } else {
+      prev = it++;
+      ++size;
+    }
+  }
+  return size;
+}
+
+//! hash_unique's helper for the other containers, compacted in place
+template <class Container, class Hash, class Eq>
+inline std::size_t hash_unique_dispatch(Container &container, Hash &hash,
+                                        Eq &eq, priority_tag<0>) {
+  return erase_tail(container,
+                    hash_unique_range(adl_begin(container),
+                                      adl_end(container), hash, eq),
+                    priority_tag<1>());
+}
+
+//! Ranges shorter than this are not worth being split between threads.
+constexpr std::size_t parallel_cutoff = std::size_t(1) << 15;
+
+//! Returns the smallest i such that merging a[0, i) and b[0, diag-i) gives the
+//! first diag elements of the stable merge of a[0, na) and b[0, nb).
+template <class RandomIt, class Comp>
+std::size_t merge_path_split(RandomIt a, std::size_t na, RandomIt b,
+                             std::size_t nb, std::size_t diag, Comp &comp) {
+  std::size_t lo = diag > nb ? diag-nb : 0, hi = std::min(diag, na);
+  while (lo < hi) {
+    const std::size_t i = lo+(hi-lo)/2;
+    if (!comp(b[diag-i-1], a[i]))
+      lo = i+1;
+    else
+      hi = i;
+  }
+  return lo;
+}
+
+//! A piece of the merge of the adjacent runs [lo, mid) and [mid, hi): the
+//! elements [out_first, out_last) of their merge, counted from lo.
+struct merge_piece {
+  std::size_t lo, mid, hi, out_first, out_last;
+};
+
+//! Cuts the merges of every pair of adjacent sorted runs of the given width
+//! among n elements into pieces of up to piece_size elements.
+inline scratch_vector<merge_piece> merge_pieces(std::size_t n,
+                                                std::size_t width,
+                                                std::size_t piece_size) {
+  scratch_vector<merge_piece> pieces;
+  for (std::size_t lo = 0; lo < n; lo += 2*width) {
+    const std::size_t mid = std::min(n, lo+width), hi = std::min(n, mid+width);
+    for (std::size_t out = 0; out < hi-lo; out += piece_size)
+      pieces.push_back({lo, mid, hi, out, std::min(hi-lo, out+piece_size)});
+  }
+  return pieces;
+}
+
+//! Moves the piece p of a merge from src to the same positions in dst, its
+//! bounds in each run being found along the merge path.
+template <class SrcIt, class DstIt, class Comp>
+void merge_piece_to(SrcIt src, DstIt dst, const merge_piece &p, Comp &comp) {
+  const SrcIt a = src+p.lo, b = src+p.mid;
+  const std::size_t na = p.mid-p.lo, nb = p.hi-p.mid;
+  const std::size_t a_first = merge_path_split(a, na, b, nb, p.out_first,
+                                               comp);
+  const std::size_t a_last = merge_path_split(a, na, b, nb, p.out_last, comp);
+  move_merge(a+a_first, a+a_last, b+(p.out_first-a_first),
+             b+(p.out_last-a_last), dst+(p.lo+p.out_first), comp);
+}
+
+//! Merges every pair of adjacent sorted runs of the given width from src into
+//! dst. Each merge is cut into pieces along its merge path, so that all the
+//! threads of the pool keep busy even when only one pair is left.
+template <class SrcIt, class DstIt, class Comp>
+void parallel_merge_pass(thread_pool &pool, SrcIt src, DstIt dst,
+                         std::size_t n, std::size_t width, Comp &comp) {
+  const scratch_vector<merge_piece> pieces = merge_pieces(
+      n, width, std::max(parallel_cutoff, n/(pool.size()*4)+1));
+  pool.run(pieces.size(), [&](std::size_t k) {
+    merge_piece_to(src, dst, pieces[k], comp);
+  });
+}
+
+//! Sorts [first, last) on the given pool: one chunk per thread is sorted
+//! concurrently, then the chunks are merged pairwise through a scratch buffer.
+template <class RandomIt, class Comp>
+void parallel_sort(thread_pool &pool, RandomIt first, RandomIt last,
+                   Comp &comp) {
+  using value_type = typename std::iterator_traits<RandomIt>::value_type;
+  const std::size_t n = std::distance(first, last);
+  if (n < 2*parallel_cutoff || pool.size() == 1) {
+    sort_range(first, last, comp);
+    return;
+  }
+  note_backend(backend::parallel);
+  const std::size_t chunks = std::min(pool.size(), n/parallel_cutoff);
+  const std::size_t width = (n+chunks-1)/chunks;
+  const scratch_setting setting = current_scratch_setting();
+  pool.run(chunks, [&](std::size_t k) {
+    const scratch_scope scope(setting);
+    sort_range(first+std::min(n, k*width), first+std::min(n, (k+1)*width),
+               comp);
+  });
+  bool presorted = true;
+  for (std::size_t k = 1; k < chunks && presorted; ++k)
+    presorted = !comp(first[k*width], first[k*width-1]);
+  if (presorted)
+    return;
+  // the buffer takes over the sorted chunks, so the first pass merges back
+  scratch_vector<value_type> buffer(std::make_move_iterator(first),
+                                    std::make_move_iterator(last));
+  count_moves(n);
+  bool in_buffer = true;
+  for (std::size_t w = width; w < n; w *= 2, in_buffer = !in_buffer) {
+    if (in_buffer)
+      parallel_merge_pass(pool, buffer.begin(), first, n, w, comp);
+    else
+      parallel_merge_pass(pool, first, buffer.begin(), n, w, comp);
+  }
+  if (in_buffer) {
+    const std::size_t pieces = (n+parallel_cutoff-1)/parallel_cutoff;
+    pool.run(pieces, [&](std::size_t k) {
+      const std::size_t lo = k*parallel_cutoff;
+      std::move(buffer.begin()+lo,
+                buffer.begin()+std::min(n, lo+parallel_cutoff), first+lo);
+    });
+    count_moves(n);
+  }
+}
+
+//! sort's(policy, comp) helper for containers whose trx::sorter is
+//! specialized, which are sorted in the calling thread
+template <class Container, class Comp>
+inline auto parallel_sort_dispatch(thread_pool &, Container &container,
+                                   Comp &comp, priority_tag<2>)
+    -> decltype(sorter<Container>::sort(container, comp), void()) {
+  note_backend(backend::sorter);
+  sorter<Container>::sort(container, comp);
+}
+
+//! sort's(policy, comp) helper for random access containers
+template <class Container, class Comp>
+inline std::enable_if_t<is_random_access_container<Container>::value, void>
+parallel_sort_dispatch(thread_pool &pool, Container &container, Comp &comp,
+                       priority_tag<1>) {
+  parallel_sort(pool, adl_begin(container), adl_end(container), comp);
+}
+
+//! sort's(policy, comp) helper for the other containers, which are sorted in
+//! the calling thread
+template <class Container, class Comp>
+inline void parallel_sort_dispatch(thread_pool &, Container &container,
+                                   Comp &comp, priority_tag<0>) {
+  sort_dispatch(container, comp, priority_tag<3>());
+}
+
+//! sort's(policy, comp) helper
+template <class Container, class Comp>
+inline void sort_impl(thread_pool *pool, Container &container, Comp &comp) {
+  if (!pool) {
+    sort_impl(container, comp);
+    return;
+  }
+  const call_scope scope;
+  auto &&counting_comp = counted(comp);
+  parallel_sort_dispatch(*pool, container, counting_comp, priority_tag<2>());
+}
+
+//! sort_each's helper for containers whose trx::sorter is specialized
+template <class Container, class Comp>
+inline auto sort_one(Container &container, Comp &comp, priority_tag<2>)
+    -> decltype(sorter<Container>::sort(container, comp), void()) {
+  note_backend(backend::sorter);
+  sorter<Container>::sort(container, comp);
+}
+
+//! sort_each's helper for random access containers, the smallest of which
+//! are sorted by a sorting network
+template <class Container, class Comp>
+inline std::enable_if_t<is_random_access_container<Container>::value, void>
+sort_one(Container &container, Comp &comp, priority_tag<1>) {
+  const auto first = adl_begin(container);
+  const std::size_t n = std::distance(first, adl_end(container));
+  if (n <= network_cutoff)
+    network_sort(first, n, comp);
+  else
+    sort_range(first, adl_end(container), comp);
+}
+
+//! sort_each's helper for the std::arrays sorted by a sorting network
+template <class T, std::size_t N, class Comp>
+inline std::enable_if_t<is_network_array<T, N>::value, void>
+sort_one(std::array<T, N> &container, Comp &comp, priority_tag<1>) {
+  note_backend(backend::network);
+  array_network_sort(container, comp,
+                     std::integral_constant<bool, (N <= network_cutoff)>());
+}
+
+//! sort_each's helper for the other containers
+template <class Container, class Comp>
+inline void sort_one(Container &container, Comp &comp, priority_tag<0>) {
+  sort_dispatch(container, comp, priority_tag<3>());
+}
+
+//! Ranges of containers holding less elements than this in total are sorted
+//! in the calling thread.
+constexpr std::size_t sort_each_parallel_cutoff = std::size_t(1) << 16;
+
+//! sort_each's helper for ranges traversed by random access iterators: when
+//! they hold enough elements, they are cut into groups of containers of about
+//! the same total size, sorted concurrently on the pool given by get_pool.
+template <class Range, class Comp, class GetPool>
+void sort_each_impl(Range &containers, Comp &comp, GetPool &get_pool,
+                    std::true_type) {
+  const call_scope scope;
+  auto &&counting_comp = counted(comp);
+  const auto first = adl_begin(containers);
+  const std::size_t n = std::distance(first, adl_end(containers));
+  scratch_vector<std::size_t> sizes(n);
+  std::size_t total = 0;
+  for (std::size_t i = 0; i != n; ++i)
+    total += sizes[i] = std::distance(adl_begin(first[i]), adl_end(first[i]));
+  thread_pool *pool = total < sort_each_parallel_cutoff ? nullptr : get_pool();
+  if (!pool || pool->size() == 1) {
+    for (std::size_t i = 0; i != n; ++i)
+      sort_one(first[i], counting_comp, priority_tag<2>());
+    return;
+  }
+  // every container also weighs as one element, for its fixed cost
+  const std::size_t grain = (total+n)/(pool->size()*8)+1;
+  scratch_vector<std::size_t> bounds(1, 0);
+  for (std::size_t i = 0, weight = 0; i != n; ++i) {
+    weight += sizes[i]+1;
+    if (weight >= grain || i+1 == n) {
+      bounds.push_back(i+1);
+      weight = 0;
+    }
+  }
+  const scratch_setting setting = current_scratch_setting();
+  pool->run(bounds.size()-1, [&](std::size_t k) {
+    const scratch_scope scratch(setting);
+    for (std::size_t i = bounds[k]; i != bounds[k+1]; ++i)
+      sort_one(first[i], counting_comp, priority_tag<2>());
+  });
+}
+
+//! sort_each's helper for the other ranges, whose containers are sorted in
+//! the calling thread
+template <class Range, class Comp, class GetPool>
+void sort_each_impl(Range &containers, Comp &comp, GetPool &,
+                    std::false_type) {
+  const call_scope scope;
+  auto &&counting_comp = counted(comp);
+  for (auto &&container : containers)
+    sort_one(container, counting_comp, priority_tag<2>());
+}
+
+//! sort_by_first's helper for comparators radix_sort cannot emulate
+template <class RandomIt, class Comp>
+inline void sort_by_first(RandomIt first, RandomIt last, Comp &comp,
+                          std::integral_constant<int, 0>) {
+  using pair_type = typename std::iterator_traits<RandomIt>::value_type;
+  note_backend(backend::introsort);
+  std::sort(first, last, [&comp](const pair_type &lhs, const pair_type &rhs) {
+    return comp(lhs.first, rhs.first);
+  });
+}
+
+//! sort_by_first's helper for operator< and operator>
+template <class RandomIt, class Comp, int Direction>
+inline void sort_by_first(RandomIt first, RandomIt last, Comp &comp,
+                          std::integral_constant<int, Direction>) {
+  using pair_type = typename std::iterator_traits<RandomIt>::value_type;
+  using key_type = typename pair_type::first_type;
+  if (static_cast<std::size_t>(std::distance(first, last)) < radix_cutoff) {
+    sort_by_first(first, last, comp, std::integral_constant<int, 0>());
+  } else {
+    const radix_key<key_type, Direction == -1> key_of;
+    note_backend(backend::radix);
+    radix_sort(first, last,
+               [&key_of](const pair_type &pair){ return key_of(pair.first); });
+  }
+}
+
+//! Sorts a random access range of std::pairs by their first members, picking
+//! radix_sort as sort_range does.
+template <class RandomIt, class Comp>
+inline void sort_by_first(RandomIt first, RandomIt last, Comp &comp) {
+  using pair_type = typename std::iterator_traits<RandomIt>::value_type;
+  using key_type = typename pair_type::first_type;
+  constexpr int direction = has_radix_key<key_type>::value &&
+      std::is_default_constructible<pair_type>::value ?
+          radix_direction<key_type, Comp>::value : 0;
+  sort_by_first(first, last, comp, std::integral_constant<int, direction>());
+}
+
+//! apply_permutation_range's helper for trivially relocatable elements,
+//! whose bytes are copied instead of moving the elements
+template <class RandomIt, class Indices>
+void apply_permutation_range(RandomIt first, Indices &perm, std::true_type) {
+  using value_type = typename std::iterator_traits<RandomIt>::value_type;
+  using Index = typename Indices::value_type;
+  alignas(value_type) unsigned char held[sizeof(value_type)];
+  const auto at = [first](std::size_t i) {
+    return static_cast<void *>(std::addressof(first[i]));
+  };
+  std::size_t moves = 0;
+  for (std::size_t i = 0; i != perm.size(); ++i) {
+    if (perm[i] == i)
+      continue;
+    std::memcpy(held, at(i), sizeof(value_type));
+    std::size_t j = i;
+    for (std::size_t k; (k = perm[j]) != i; j = k) {
+      std::memcpy(at(j), at(k), sizeof(value_type));
+      perm[j] = static_cast<Index>(j);
+      ++moves;
+    }
+    std::memcpy(at(j), held, sizeof(value_type));
+    perm[j] = static_cast<Index>(j);
+    moves += 2;
+  }
+  count_moves(moves);
+}
+
+//! apply_permutation_range's helper for the other elements
+template <class RandomIt, class Indices>
+void apply_permutation_range(RandomIt first, Indices &perm, std::false_type) {
+  using value_type = typename std::iterator_traits<RandomIt>::value_type;
+  using Index = typename Indices::value_type;
+  std::size_t moves = 0;
+  for (std::size_t i = 0; i != perm.size(); ++i) {
+    if (perm[i] == i)
+      continue;
+    value_type held = std::move(first[i]);
+    std::size_t j = i;
+    for (std::size_t k; (k = perm[j]) != i; j = k) {
+      first[j] = std::move(first[k]);
+      perm[j] = static_cast<Index>(j);
+      ++moves;
+    }
+    first[j] = std::move(held);
+    perm[j] = static_cast<Index>(j);
+    moves += 2;
+  }
+  count_moves(moves);
+}
+
+//! Moves the elements of [first, first+perm.size()) so that the element at
+//! position i is the one which was at position perm[i], by following the
+//! cycles of the permutation. perm is left as the identity.
+template <class RandomIt, class Indices>
+inline void apply_permutation_range(RandomIt first, Indices &perm) {
+  using value_type = typename std::iterator_traits<RandomIt>::value_type;
+  apply_permutation_range(first, perm,
+                          is_trivially_relocatable<value_type>());
+}
+
+//! Tells whether sort_by moves elements of type T along with their keys
+//! instead of sorting indices and permuting the elements afterwards.
+template <class T>
+struct sort_by_moves_elements : std::integral_constant<bool,
+    std::is_trivially_copyable<T>::value &&
+    std::is_default_constructible<T>::value &&
+    sizeof(T) <= 2*sizeof(void *)> {};
+
+//! sort_by's helper for random access ranges of small trivially copyable
+//! elements, which are sorted along with their keys
+template <class RandomIt, class Proj, class Comp>
+void sort_by_range(RandomIt first, RandomIt last, Proj &proj, Comp &comp,
+                   std::true_type) {
+  using value_type = typename std::iterator_traits<RandomIt>::value_type;
+  using key_type = std::decay_t<decltype(proj(*first))>;
+  scratch_vector<std::pair<key_type, value_type> > keyed;
+  keyed.reserve(std::distance(first, last));
+  for (RandomIt it = first; it != last; ++it)
+    keyed.emplace_back(proj(*it), *it);
+  sort_by_first(keyed.begin(), keyed.end(), comp);
+  for (auto &pair : keyed)
+    *first++ = pair.second;
+}
+
+//! sort_by's helper for random access ranges of other elements: the
+//! (key, index) pairs are sorted, then the elements are permuted
+template <class RandomIt, class Proj, class Comp>
+void sort_by_range(RandomIt first, RandomIt last, Proj &proj, Comp &comp,
+                   std::false_type) {
+  using key_type = std::decay_t<decltype(proj(*first))>;
+  scratch_vector<std::pair<key_type, std::size_t> > keyed;
+  keyed.reserve(std::distance(first, last));
+  for (RandomIt it = first; it != last; ++it)
+    keyed.emplace_back(proj(*it), keyed.size());
+  sort_by_first(keyed.begin(), keyed.end(), comp);
+  scratch_vector<std::size_t> perm;
+  perm.reserve(keyed.size());
+  for (auto &pair : keyed)
+    perm.push_back(pair.second);
+  keyed = {};
+  apply_permutation_range(first, perm);
+}
+
+//! sort_by's helper for random access ranges
+template <class RandomIt, class Proj, class Comp>
+inline void sort_by_range(RandomIt first, RandomIt last, Proj &proj,
+                          Comp &comp) {
+  using value_type = typename std::iterator_traits<RandomIt>::value_type;
+  if (std::distance(first, last) < 2)
+    return;
+  sort_by_range(first, last, proj, comp,
+                sort_by_moves_elements<value_type>());
+}
+
+//! The value type of the column of Columns at index J.
+template <std::size_t J, class Columns>
+using column_value_t = std::decay_t<decltype(
+    *adl_begin(std::get<J>(std::declval<Columns &>())))>;
+
+//! rows_less' helper once every key is compared
+template <std::size_t J, class Keys>
+inline bool rows_less(Keys &, std::size_t a, std::size_t b,
+                      std::false_type) {
+  return a < b;
+}
+
+//! sort_columns' order of rows a and b once the keys before J are equal:
+//! lexicographic over the keys from J, then by position
+template <std::size_t J, class Keys>
+inline bool rows_less(Keys &keys, std::size_t a, std::size_t b,
+                      std::true_type) {
+  const auto column = adl_begin(std::get<J>(keys));
+  if (column[a] < column[b])
+    return true;
+  if (column[b] < column[a])
+    return false;
+  return rows_less<J+1>(
+      keys, a, b,
+      std::integral_constant<bool, (J+1 < std::tuple_size<Keys>::value)>());
+}
+
+//! sort_rows' helper once every key is compared
+template <std::size_t J, class Keys, class Index>
+inline void sort_rows(Keys &, Index *, std::size_t, std::false_type) {}
+
+template <std::size_t J, class Keys, class Index>
+void sort_rows(Keys &keys, Index *perm, std::size_t n, std::true_type);
+
+//! Sorts the positions [perm, perm+n), whose keys before J are equal, by
+//! comparing the keys from J.
+template <std::size_t J, class Keys, class Index>
+inline void sort_rows_by_comparisons(Keys &keys, Index *perm, std::size_t n) {
+  auto less = [&keys](Index a, Index b) {
+    return rows_less<J>(keys, a, b, std::true_type());
+  };
+  note_backend(backend::introsort);
+  std::sort(perm, perm+n, counted(less));
+}
+
+//! sort_rows' helper for keys radix_sort cannot sort
+template <std::size_t J, class Keys, class Index>
+inline void sort_rows(Keys &keys, Index *perm, std::size_t n, std::true_type,
+                      std::false_type) {
+  sort_rows_by_comparisons<J>(keys, perm, n);
+}
+
+//! sort_rows' helper for radix sortable keys: key J is radix sorted along
+//! with the positions, then each run of keys equivalent by operator< is
+//! sorted by the next keys. Sorting one key at a time keeps the runs of the
+//! next keys small enough to stay in cache.
+template <std::size_t J, class Keys, class Index>
+void sort_rows(Keys &keys, Index *perm, std::size_t n, std::true_type,
+               std::true_type) {
+  using key_type = column_value_t<J, Keys>;
+  using bits_type = typename radix_sort_key<key_type>::type;
+  using keyed_type = std::pair<bits_type, Index>;
+  constexpr bool more = J+1 < std::tuple_size<Keys>::value;
+  const radix_key<key_type, false> key_of;
+  const auto column = adl_begin(std::get<J>(keys));
+  scratch_vector<keyed_type> keyed;
+  keyed.reserve(n);
+  for (std::size_t i = 0; i != n; ++i)
+    keyed.emplace_back(key_of(column[perm[i]]), perm[i]);
+  note_backend(backend::radix);
+  radix_sort(keyed.begin(), keyed.end(),
+             [](const keyed_type &pair){ return pair.first; });
+  for (std::size_t i = 0; i != n; ++i)
+    perm[i] = keyed[i].second;
+  if (!more)
+    return;
+  for (std::size_t lo = 0, hi; lo != n; lo = hi) {
+    for (hi = lo+1; hi != n && !(column[perm[lo]] < column[perm[hi]]) &&
+                    !(column[perm[hi]] < column[perm[lo]]); ++hi) {}
+    if (hi-lo > 1)
+      sort_rows<J+1>(keys, perm+lo, hi-lo,
+                     std::integral_constant<bool, more>());
+  }
+}
+
+//! Sorts the positions [perm, perm+n), whose keys before J are equal, by the
+//! keys from J, most significant first: radix sorted when they can be and
+//! the range is long enough, by comparisons otherwise.
+template <std::size_t J, class Keys, class Index>
+void sort_rows(Keys &keys, Index *perm, std::size_t n, std::true_type) {
+  using key_type = column_value_t<J, Keys>;
+  if (n < radix_cutoff)
+    sort_rows_by_comparisons<J>(keys, perm, n);
+  else
+    sort_rows<J>(keys, perm, n, std::true_type(),
+                 is_radix_sortable<key_type>());
+}
+
+//! Moves the elements of [first, first+perm.size()) so that the element at
+//! position i is the one which was at position perm[i], through a buffer.
+//! Unlike apply_permutation_range, the reads do not depend on each other,
+//! which is faster on large ranges; perm is kept.
+template <class RandomIt, class Indices>
+void gather_permutation_range(RandomIt first, const Indices &perm) {
+  using value_type = typename std::iterator_traits<RandomIt>::value_type;
+  scratch_vector<value_type> gathered;
+  gathered.reserve(perm.size());
+  for (const auto i : perm)
+    gathered.push_back(std::move(first[i]));
+  std::move(gathered.begin(), gathered.end(), first);
+  count_moves(2*perm.size());
+}
+
+//! sort_columns' helper, with positions of type Index
+template <class Index, class Keys, class... Columns>
+void sort_columns_impl(std::size_t n, Keys &keys, Columns &...columns) {
+  scratch_vector<Index> perm(n);
+  for (std::size_t i = 0; i != n; ++i)
+    perm[i] = static_cast<Index>(i);
+  sort_rows<0>(keys, perm.data(), n, std::true_type());
+  const int expand[] = {0,
+      (gather_permutation_range(adl_begin(columns), perm), 0)...};
+  (void)expand;
+}
+
+//! sort_columns' helper: the keys are permuted along with the payloads
+template <class... Keys, class... Payloads, std::size_t... Is>
+void sort_columns_impl(std::tuple<Keys...> &keys, std::index_sequence<Is...>,
+                       Payloads &...payloads) {
+  const call_scope scope;
+  auto &first = std::get<0>(keys);
+  const std::size_t n = std::distance(adl_begin(first), adl_end(first));
+  if (n < 2)
+    return;
+  if (n <= std::numeric_limits<std::uint32_t>::max())
+    sort_columns_impl<std::uint32_t>(n, keys, std::get<Is>(keys)...,
+                                     payloads...);
+  else
+    sort_columns_impl<std::size_t>(n, keys, std::get<Is>(keys)...,
+                                   payloads...);
+}
+
+//! argsort's helper for random access containers: the positions are stably
+//! sorted by comparing the elements at them
+template <class Index, class Container, class Comp>
+void argsort_by_comparisons(std::vector<Index> &perm,
+                            const Container &container, Comp &comp,
+                            std::true_type) {
+  const auto first = adl_begin(container);
+  auto less = [first, &comp](Index a, Index b) {
+    return comp(first[a], first[b]);
+  };
+  stable_sort_range(perm.begin(), perm.end(), less);
+}
+
+//! argsort's helper for the other containers, whose elements are compared
+//! through pointers gathered in a buffer
+template <class Index, class Container, class Comp>
+void argsort_by_comparisons(std::vector<Index> &perm,
+                            const Container &container, Comp &comp,
+                            std::false_type) {
+  using value_type = std::decay_t<decltype(*adl_begin(container))>;
+  scratch_vector<const value_type *> elements;
+  elements.reserve(perm.size());
+  for (const auto &element : container)
+    elements.push_back(std::addressof(element));
+  auto less = [&elements, &comp](Index a, Index b) {
+    return comp(*elements[a], *elements[b]);
+  };
+  stable_sort_range(perm.begin(), perm.end(), less);
+}
+
+//! argsort's helper for radix sortable elements: the (radix key, position)
+//! pairs are radix sorted, with positions of type Narrow
+template <class Narrow, class Index, class Container, class KeyOf>
+void argsort_by_radix(std::vector<Index> &perm, const Container &container,
+                      const KeyOf &key_of) {
+  using bits_type = std::decay_t<decltype(key_of(*adl_begin(container)))>;
+  using keyed_type = std::pair<bits_type, Narrow>;
+  scratch_vector<keyed_type> keyed;
+  keyed.reserve(perm.size());
+  for (const auto &element : container)
+    keyed.emplace_back(key_of(element), static_cast<Narrow>(keyed.size()));
+  note_backend(backend::radix);
+  radix_sort(keyed.begin(), keyed.end(),
+             [](const keyed_type &pair){ return pair.first; });
+  for (std::size_t i = 0; i != perm.size(); ++i)
+    perm[i] = static_cast<Index>(keyed[i].second);
+}
+
+//! argsort's helper for comparators radix_sort cannot emulate
+template <class Index, class Container, class Comp>
+inline void argsort_dispatch(std::vector<Index> &perm,
+                             const Container &container, Comp &comp,
+                             std::integral_constant<int, 0>) {
+  argsort_by_comparisons(perm, container, comp,
+                         is_random_access_container<const Container>());
+}
+
+//! argsort's helper for operator< and operator>: the positions are 32-bit
+//! in the radix sorted pairs when they fit, which halves the pairs of
+//! 32-bit keys
+template <class Index, class Container, class Comp, int Direction>
+inline void argsort_dispatch(std::vector<Index> &perm,
+                             const Container &container, Comp &comp,
+                             std::integral_constant<int, Direction>) {
+  using value_type = std::decay_t<decltype(*adl_begin(container))>;
+  const radix_key<value_type, Direction == -1> key_of;
+  if (perm.size() < radix_cutoff)
+    argsort_by_comparisons(perm, container, comp,
+                           is_random_access_container<const Container>());
+  else if (perm.size() <= std::numeric_limits<std::uint32_t>::max())
+    argsort_by_radix<std::uint32_t>(perm, container, key_of);
+  else
+    argsort_by_radix<std::size_t>(perm, container, key_of);
+}
+
+//! argsort's helper
+template <class Index, class Container, class Comp>
+std::vector<Index> argsort_impl(const Container &container, Comp &comp) {
+  using value_type = std::decay_t<decltype(*adl_begin(container))>;
+  const call_scope scope;
+  auto &&counting_comp = counted(comp);
+  std::vector<Index> perm(std::distance(adl_begin(container),
+                                        adl_end(container)));
+  for (std::size_t i = 0; i != perm.size(); ++i)
+    perm[i] = static_cast<Index>(i);
+  if (perm.size() < 2)
+    return perm;
+  constexpr int direction = is_radix_sortable<value_type>::value ?
+      radix_direction<value_type, Comp>::value : 0;
+  argsort_dispatch(perm, container, counting_comp,
+                   std::integral_constant<int, direction>());
+  return perm;
+}
+
+//! Returns a copy of perm in a scratch buffer, which apply_permutation_range
+//! may overwrite.
+template <class Indices>
+inline auto scratch_copy(const Indices &perm) {
+  using index_type = std::decay_t<decltype(*adl_begin(perm))>;
+  return scratch_vector<index_type>(adl_begin(perm), adl_end(perm));
+}
+
+//! apply_permutation's helper for random access containers, permuted by
+//! following the cycles of perm
+template <class Container, class Indices>
+inline std::enable_if_t<is_random_access_container<Container>::value, void>
+apply_permutation_dispatch(Container &container, const Indices &perm,
+                           priority_tag<1>) {
+  auto cycles = scratch_copy(perm);
+  apply_permutation_range(adl_begin(container), cycles);
+}
+
+//! apply_permutation's helper for std::list: the nodes are spliced to the
+//! end in the order of perm
+template <class T, class Allo, class Indices>
+void apply_permutation_dispatch(std::list<T, Allo> &container,
+                                const Indices &perm, priority_tag<1>) {
+  using iterator = typename std::list<T, Allo>::iterator;
+  scratch_vector<iterator> nodes;
+  nodes.reserve(container.size());
+  for (iterator it = container.begin(); it != container.end(); ++it)
+    nodes.push_back(it);
+  for (const auto i : perm)
+    container.splice(container.end(), container, nodes[i]);
+}
+
+//! apply_permutation's helper for std::forward_list: each node is detached
+//! into a list of its own, then the nodes are spliced back in the reverse
+//! order of perm
+template <class T, class Allo, class Indices>
+void apply_permutation_dispatch(std::forward_list<T, Allo> &container,
+                                const Indices &perm, priority_tag<1>) {
+  using node = std::forward_list<T, Allo>;
+  scratch_vector<node> nodes;
+  while (!container.empty()) {
+    nodes.emplace_back(container.get_allocator());
+    nodes.back().splice_after(nodes.back().before_begin(), container,
+                              container.before_begin());
+  }
+  for (auto it = adl_end(perm); it != adl_begin(perm);)
+    container.splice_after(container.before_begin(), nodes[*--it]);
+}
+
+//! apply_permutation's helper for the containers apply_permutation cannot
+//! handle
+template <class Container, class Indices>
+inline void apply_permutation_dispatch(Container &, const Indices &,
+                                       priority_tag<0>) {
+  static_assert(sizeof(Container) == 0,
+                "trx::apply_permutation requires random access iterators, a "
+                "std::list or a std::forward_list.");
+}
+
+//! The buffer of T a list_gather_t<Allocator> takes from its allocator.
+template <class Allocator, class T>
+struct gather_buffer {
+  using type = std::vector<
+      T, typename std::allocator_traits<Allocator>::template rebind_alloc<T> >;
+
+  static type make(const list_gather_t<Allocator> &tag) {
+    return type(typename type::allocator_type(tag.allocator));
+  }
+};
+
+template <class T>
+struct gather_buffer<void, T> {
+  using type = scratch_vector<T>;
+
+  static type make(const list_gather_t<> &) { return type(); }
+};
+
+//! Tells whether the gathering list sort copies the elements of type T next
+//! to their nodes, rather than comparing the elements through the nodes.
+template <class T>
+struct gather_copies_elements : std::integral_constant<bool,
+    std::is_trivially_copyable<T>::value &&
+    std::is_default_constructible<T>::value &&
+    sizeof(T) <= 2*sizeof(void *)> {};
+
+//! list_gather sort's helper for std::list: the node iterators are sorted in
+//! a contiguous buffer, then the nodes are spliced to the end in order
+template <class T, class Allo, class Comp, class Allocator>
+void gather_sort(std::list<T, Allo> &container, Comp &comp,
+                 const list_gather_t<Allocator> &tag, std::true_type) {
+  using iterator = typename std::list<T, Allo>::iterator;
+  using buffer = gather_buffer<Allocator, std::pair<T, iterator> >;
+  typename buffer::type keyed = buffer::make(tag);
+  keyed.reserve(container.size());
+  for (iterator it = container.begin(); it != container.end(); ++it)
+    keyed.emplace_back(*it, it);
+  sort_by_first(keyed.begin(), keyed.end(), comp);
+  for (auto &pair : keyed)
+    container.splice(container.end(), container, pair.second);
+}
+
+template <class T, class Allo, class Comp, class Allocator>
+void gather_sort(std::list<T, Allo> &container, Comp &comp,
+                 const list_gather_t<Allocator> &tag, std::false_type) {
+  using iterator = typename std::list<T, Allo>::iterator;
+  using buffer = gather_buffer<Allocator, iterator>;
+  typename buffer::type nodes = buffer::make(tag);
+  nodes.reserve(container.size());
+  for (iterator it = container.begin(); it != container.end(); ++it)
+    nodes.push_back(it);
+  std::sort(nodes.begin(), nodes.end(), [&comp](iterator lhs, iterator rhs) {
+    return comp(*lhs, *rhs);
+  });
+  for (iterator it : nodes)
+    container.splice(container.end(), container, it);
+}
+
+//! list_gather sort's helper for std::forward_list: each node is detached
+//! into a list of its own kept in a contiguous buffer, the buffer is sorted,
+//! then the nodes are spliced back in reverse order
+template <class T, class Allo, class Comp, class Allocator>
+void gather_sort(std::forward_list<T, Allo> &container, Comp &comp,
+                 const list_gather_t<Allocator> &tag, std::true_type) {
+  using node = std::forward_list<T, Allo>;
+  using node_buffer = gather_buffer<Allocator, node>;
+  using key_buffer = gather_buffer<Allocator, std::pair<T, std::size_t> >;
+  typename node_buffer::type nodes = node_buffer::make(tag);
+  typename key_buffer::type keyed = key_buffer::make(tag);
+  while (!container.empty()) {
+    keyed.emplace_back(container.front(), nodes.size());
+    nodes.emplace_back(container.get_allocator());
+    nodes.back().splice_after(nodes.back().before_begin(), container,
+                              container.before_begin());
+  }
+  sort_by_first(keyed.begin(), keyed.end(), comp);
+  for (auto it = keyed.rbegin(); it != keyed.rend(); ++it)
+    container.splice_after(container.before_begin(), nodes[it->second]);
+}
+
+template <class T, class Allo, class Comp, class Allocator>
+void gather_sort(std::forward_list<T, Allo> &container, Comp &comp,
+                 const list_gather_t<Allocator> &tag, std::false_type) {
+  using node = std::forward_list<T, Allo>;
+  using buffer = gather_buffer<Allocator, node>;
+  typename buffer::type nodes = buffer::make(tag);
+  while (!container.empty()) {
+    nodes.emplace_back(container.get_allocator());
+    nodes.back().splice_after(nodes.back().before_begin(), container,
+                              container.before_begin());
+  }
+  std::sort(nodes.begin(), nodes.end(), [&comp](const node &lhs,
+                                                const node &rhs) {
+    return comp(lhs.front(), rhs.front());
+  });
+  for (auto it = nodes.rbegin(); it != nodes.rend(); ++it)
+    container.splice_after(container.before_begin(), *it);
+}
+
+//! sort's(comp, list_gather) helper for std::list
+template <class T, class Allo, class Comp, class Allocator>
+inline void sort_impl(std::list<T, Allo> &container, Comp &comp,
+                      const list_gather_t<Allocator> &tag) {
+  const call_scope scope;
+  auto &&counting_comp = counted(comp);
+  note_backend(backend::list_gather);
+  if (container.size() > 1)
+    gather_sort(container, counting_comp, tag, gather_copies_elements<T>());
+}
+
+//! sort's(comp, list_gather) helper for std::forward_list
+template <class T, class Allo, class Comp, class Allocator>
+inline void sort_impl(std::forward_list<T, Allo> &container, Comp &comp,
+                      const list_gather_t<Allocator> &tag) {
+  const call_scope scope;
+  auto &&counting_comp = counted(comp);
+  note_backend(backend::list_gather);
+  if (!container.empty() && std::next(container.begin()) != container.end())
+    gather_sort(container, counting_comp, tag, gather_copies_elements<T>());
+}
+
+//! sort's(comp, list_gather) helper for the other containers, which ignore
+//! the tag
+template <class Container, class Comp, class Allocator>
+inline void sort_impl(Container &container, Comp &comp,
+                      const list_gather_t<Allocator> &) {
+  sort_impl(container, comp);
+}
+
+//! sort_by's helper for std::list: the nodes are spliced to the end in order
+template <class T, class Allo, class Proj, class Comp>
+void sort_by_dispatch(std::list<T, Allo> &container, Proj &proj,
+                      Comp &comp) {
+  using key_type = std::decay_t<decltype(proj(container.front()))>;
+  using iterator = typename std::list<T, Allo>::iterator;
+  scratch_vector<std::pair<key_type, iterator> > keyed;
+  keyed.reserve(container.size());
+  for (iterator it = container.begin(); it != container.end(); ++it)
+    keyed.emplace_back(proj(*it), it);
+  sort_by_first(keyed.begin(), keyed.end(), comp);
+  for (auto &pair : keyed)
+    container.splice(container.end(), container, pair.second);
+}
+
+//! sort_by's helper for std::forward_list: each node is detached into a list
+//! of its own, then they are spliced back in reverse order
+template <class T, class Allo, class Proj, class Comp>
+void sort_by_dispatch(std::forward_list<T, Allo> &container, Proj &proj,
+                      Comp &comp) {
+  using key_type = std::decay_t<decltype(proj(container.front()))>;
+  scratch_vector<std::pair<key_type, std::size_t> > keyed;
+  for (auto &element : container)
+    keyed.emplace_back(proj(element), keyed.size());
+  sort_by_first(keyed.begin(), keyed.end(), comp);
+  scratch_vector<std::forward_list<T, Allo> > nodes;
+  nodes.reserve(keyed.size());
+  while (!container.empty()) {
+    nodes.emplace_back(container.get_allocator());
+    nodes.back().splice_after(nodes.back().before_begin(), container,
+                              container.before_begin());
+  }
+  for (auto it = keyed.rbegin(); it != keyed.rend(); ++it)
+    container.splice_after(container.before_begin(), nodes[it->second]);
+}
+
+//! sort_by's helper for random access containers
+template <class Container, class Proj, class Comp>
+inline std::enable_if_t<is_random_access_container<Container>::value, void>
+sort_by_dispatch(Container &container, Proj &proj, Comp &comp) {
+  sort_by_range(adl_begin(container), adl_end(container), proj, comp);
+}
+
+//! sort_by's helper
+template <class Container, class Proj, class Comp>
+inline void sort_by_impl(Container &container, Proj &proj, Comp &comp) {
+  const call_scope scope;
+  auto &&counting_comp = counted(comp);
+  sort_by_dispatch(container, proj, counting_comp);
+}
+
+//! Selecting k elements out of n uses a bounded heap when k*heap_select_ratio
+//! <= n, and introselect otherwise.
+constexpr std::size_t heap_select_ratio = 16;
+
+//! Moves the k first elements of [first, last) in the order of comp to
+//! [first, first+k), sorted. Those are selected by a bounded heap for small
+//! k, in O(nlogk), and by introselect otherwise.
+template <class RandomIt, class Comp>
+void partial_sort_range(RandomIt first, RandomIt last, std::size_t k,
+                        Comp &comp) {
+  const std::size_t n = std::distance(first, last);
+  if (k >= n) {
+    sort_range(first, last, comp);
+  } else if (k*heap_select_ratio <= n) {
+    std::partial_sort(first, first+k, last, comp);
+  } else {
+    std::nth_element(first, first+k, last, comp);
+    sort_range(first, first+k, comp);
+  }
+}
+
+//! Returns iterators to the k first elements of [first, last) in the order of
+//! comp, sorted, where k <= n, the length of the range. Ties are broken in
+//! favour of the earlier elements for small k.
+template <class ForwardIt, class Comp>
+scratch_vector<ForwardIt> select_sorted(ForwardIt first, ForwardIt last,
+                                        std::size_t n, std::size_t k,
+                                        Comp &comp) {
+  auto pointee_comp = [&comp](ForwardIt lhs, ForwardIt rhs) {
+    return comp(*lhs, *rhs);
+  };
+  scratch_vector<ForwardIt> selected;
+  if (k*heap_select_ratio <= n) {
+    selected.reserve(k);
+    for (; selected.size() < k; ++first)
+      selected.push_back(first);
+    std::make_heap(selected.begin(), selected.end(), pointee_comp);
+    for (; first != last; ++first) {
+      if (comp(*first, *selected.front())) {
+        std::pop_heap(selected.begin(), selected.end(), pointee_comp);
+        selected.back() = first;
+        std::push_heap(selected.begin(), selected.end(), pointee_comp);
+      }
+    }
+    std::sort_heap(selected.begin(), selected.end(), pointee_comp);
+  } else {
+    selected.reserve(n);
+    for (; first != last; ++first)
+      selected.push_back(first);
+    if (k < n)
+      std::nth_element(selected.begin(), selected.begin()+k, selected.end(),
+                       pointee_comp);
+    selected.resize(k);
+    std::sort(selected.begin(), selected.end(), pointee_comp);
+  }
+  return selected;
+}
+
+//! partial_sort's helper for containers whose trx::sorter provides
+//! partial_sort
+template <class Container, class Comp>
+inline auto partial_sort_dispatch(Container &container, std::size_t k,
+                                  Comp &comp, priority_tag<4>)
+    -> decltype(sorter<Container>::partial_sort(container, k, comp), void()) {
+  sorter<Container>::partial_sort(container, k, comp);
+}
+
+//! partial_sort's helper for the other containers whose trx::sorter is
+//! specialized, which are sorted entirely
+template <class Container, class Comp>
+inline auto partial_sort_dispatch(Container &container, std::size_t,
+                                  Comp &comp, priority_tag<3>)
+    -> decltype(sorter<Container>::sort(container, comp), void()) {
+  sorter<Container>::sort(container, comp);
+}
+
+//! partial_sort's helper for random access containers
+template <class Container, class Comp>
+inline std::enable_if_t<is_random_access_container<Container>::value, void>
+partial_sort_dispatch(Container &container, std::size_t k, Comp &comp,
+                      priority_tag<2>) {
+  partial_sort_range(adl_begin(container), adl_end(container), k, comp);
+}
+
+//! partial_sort's helper for std::list: the selected nodes are spliced to the
+//! front in order
+template <class T, class Allo, class Comp>
+void partial_sort_dispatch(std::list<T, Allo> &container, std::size_t k,
+                           Comp &comp, priority_tag<2>) {
+  k = std::min(k, container.size());
+  if (k == 0)
+    return;
+  const auto selected = select_sorted(container.begin(), container.end(),
+                                      container.size(), k, comp);
+  for (auto it = selected.rbegin(); it != selected.rend(); ++it)
+    container.splice(container.begin(), container, *it);
+}
+
+//! partial_sort's helper for std::forward_list: the selected nodes are
+//! unlinked in a single pass, sorted, then spliced to the front
+template <class T, class Allo, class Comp>
+void partial_sort_dispatch(std::forward_list<T, Allo> &container,
+                           std::size_t k, Comp &comp, priority_tag<2>) {
+  using iterator = typename std::forward_list<T, Allo>::iterator;
+  const std::size_t n = std::distance(container.begin(), container.end());
+  k = std::min(k, n);
+  if (k == 0)
+    return;
+  // the selected nodes are recognized by the addresses of their elements
+  scratch_vector<const T *> selected;
+  selected.reserve(k);
+  for (iterator it : select_sorted(container.begin(), container.end(), n, k,
+                                   comp))
+    selected.push_back(std::addressof(*it));
+  std::sort(selected.begin(), selected.end(), std::less<const T *>());
+  std::forward_list<T, Allo> prefix(container.get_allocator());
+  iterator tail = prefix.before_begin();
+  for (iterator prev = container.before_begin(), it = container.begin();
+       it != container.end(); it = std::next(prev)) {
+    if (std::binary_search(selected.begin(), selected.end(),
+                           std::addressof(*it), std::less<const T *>())) {
+      prefix.splice_after(tail, container, prev);
+      tail = it;
+    } else {
+      prev = it;
+    }
+  }
+  prefix.sort(comp);
+  container.splice_after(container.before_begin(), prefix);
+}
+
+//! partial_sort's helper for the other containers with a sort member
+//! function, which are sorted entirely
+template <class Container, class Comp>
+inline auto partial_sort_dispatch(Container &container, std::size_t,
+                                  Comp &comp, priority_tag<1>)
+    -> decltype(container.sort(comp), void()) {
+  container.sort(comp);
+}
+
+//! partial_sort's helper for the containers trx::partial_sort cannot handle
+template <class Container, class Comp>
+inline void partial_sort_dispatch(Container &, std::size_t, Comp &,
+                                  priority_tag<0>) {
+  static_assert(sizeof(Container) == 0,
+                "trx::partial_sort requires random access iterators, a sort "
+                "member function or a specialization of trx::sorter.");
+}
+
+//! nth_element's helper for containers whose trx::sorter provides
+//! nth_element
+template <class Container, class Comp>
+inline auto nth_element_dispatch(Container &container, std::size_t n,
+                                 Comp &comp, priority_tag<4>)
+    -> decltype(sorter<Container>::nth_element(container, n, comp), void()) {
+  sorter<Container>::nth_element(container, n, comp);
+}
+
+//! nth_element's helper for the other containers whose trx::sorter is
+//! specialized, which are sorted entirely
+template <class Container, class Comp>
+inline auto nth_element_dispatch(Container &container, std::size_t,
+                                 Comp &comp, priority_tag<3>)
+    -> decltype(sorter<Container>::sort(container, comp), void()) {
+  sorter<Container>::sort(container, comp);
+}
+
+//! nth_element's helper for random access containers
+template <class Container, class Comp>
+inline std::enable_if_t<is_random_access_container<Container>::value, void>
+nth_element_dispatch(Container &container, std::size_t n, Comp &comp,
+                     priority_tag<2>) {
+  const auto first = adl_begin(container), last = adl_end(container);
+  if (n < static_cast<std::size_t>(std::distance(first, last)))
+    std::nth_element(first, first+n, last, comp);
+}
+
+//! nth_element's helper for std::list: the node iterators are partitioned in a
+//! contiguous buffer, then the nodes are spliced to the end in order
+template <class T, class Allo, class Comp>
+void nth_element_dispatch(std::list<T, Allo> &container, std::size_t n,
+                          Comp &comp, priority_tag<2>) {
+  using iterator = typename std::list<T, Allo>::iterator;
+  if (n >= container.size())
+    return;
+  scratch_vector<iterator> nodes;
+  nodes.reserve(container.size());
+  for (iterator it = container.begin(); it != container.end(); ++it)
+    nodes.push_back(it);
+  std::nth_element(nodes.begin(), nodes.begin()+n, nodes.end(),
+                   [&comp](iterator lhs, iterator rhs) {
+                     return comp(*lhs, *rhs);
+                   });
+  for (iterator it : nodes)
+    container.splice(container.end(), container, it);
+}
+
+//! nth_element's helper for std::forward_list: each node is detached into a
+//! list of its own, the lists are partitioned, then the nodes are spliced
+//! back in reverse order
+template <class T, class Allo, class Comp>
+void nth_element_dispatch(std::forward_list<T, Allo> &container,
+                          std::size_t n, Comp &comp, priority_tag<2>) {
+  using node = std::forward_list<T, Allo>;
+  scratch_vector<node> nodes;
+  while (!container.empty()) {
+    nodes.emplace_back(container.get_allocator());
+    nodes.back().splice_after(nodes.back().before_begin(), container,
+                              container.before_begin());
+  }
+  if (n < nodes.size())
+    std::nth_element(nodes.begin(), nodes.begin()+n, nodes.end(),
+                     [&comp](const node &lhs, const node &rhs) {
+                       return comp(lhs.front(), rhs.front());
+                     });
+  for (auto it = nodes.rbegin(); it != nodes.rend(); ++it)
+    container.splice_after(container.before_begin(), *it);
+}
+
+//! nth_element's helper for the other containers with a sort member
+//! function, which are sorted entirely
+template <class Container, class Comp>
+inline auto nth_element_dispatch(Container &container, std::size_t,
+                                 Comp &comp, priority_tag<1>)
+    -> decltype(container.sort(comp), void()) {
+  container.sort(comp);
+}
+
+//! nth_element's helper for the containers trx::nth_element cannot handle
+template <class Container, class Comp>
+inline void nth_element_dispatch(Container &, std::size_t, Comp &,
+                                 priority_tag<0>) {
+  static_assert(sizeof(Container) == 0,
+                "trx::nth_element requires random access iterators, a sort "
+                "member function or a specialization of trx::sorter.");
+}
+
+//! top_k's helper: copies the k first elements of the container in the order
+//! of comp, sorted
+template <class Container, class Comp>
+auto top_k_impl(const Container &container, std::size_t k, Comp &comp) {
+  using value_type = std::decay_t<decltype(*adl_begin(container))>;
+  const auto first = adl_begin(container), last = adl_end(container);
+  const std::size_t n = std::distance(first, last);
+  k = std::min(k, n);
+  std::vector<value_type> result;
+  if (k == 0)
+    return result;
+  if (k*heap_select_ratio <= n) {
+    // copies only the k best so far, so that the container is read once
+    result.reserve(k);
+    auto it = first;
+    for (; result.size() < k; ++it)
+      result.push_back(*it);
+    std::make_heap(result.begin(), result.end(), comp);
+    for (; it != last; ++it) {
+      if (comp(*it, result.front())) {
+        std::pop_heap(result.begin(), result.end(), comp);
+        result.back() = *it;
+        std::push_heap(result.begin(), result.end(), comp);
+      }
+    }
+    std::sort_heap(result.begin(), result.end(), comp);
+  } else {
+    result.assign(first, last);
+    partial_sort_range(result.begin(), result.end(), k, comp);
+    result.resize(k);
+  }
+  return result;
+}
+
+//! Maps the unary predicates of best_if to the predicates of the SIMD
+//! kernels for elements of type T. Only specialized for those the kernels
+//! understand.
+template <class Pred, class T>
+struct simd_predicate {};
+
+template <class T>
+struct simd_predicate<any_value, T> {
+  static constexpr detail_simd_trx::compare_op op =
+      detail_simd_trx::compare_op::any;
+
+  static T bound(const any_value &) noexcept { return T(); }
+};
+
+//! simd_predicate for compare_to, whose comparator gives the kernel's
+//! predicate
+template <class Comp>
+struct simd_compare_op;
+
+template <>
+struct simd_compare_op<std::less<> > {
+  static constexpr detail_simd_trx::compare_op op =
+      detail_simd_trx::compare_op::less;
+};
+
+template <>
+struct simd_compare_op<std::greater<> > {
+  static constexpr detail_simd_trx::compare_op op =
+      detail_simd_trx::compare_op::greater;
+};
+
+template <>
+struct simd_compare_op<std::less_equal<> > {
+  static constexpr detail_simd_trx::compare_op op =
+      detail_simd_trx::compare_op::less_equal;
+};
+
+template <>
+struct simd_compare_op<std::greater_equal<> > {
+  static constexpr detail_simd_trx::compare_op op =
+      detail_simd_trx::compare_op::greater_equal;
+};
+
+template <class T, class Comp>
+struct simd_predicate<compare_to<T, Comp>, T> : simd_compare_op<Comp> {
+  static T bound(const compare_to<T, Comp> &pred) noexcept {
+    return pred.bound;
+  }
+};
+
+//! Checks whether best_if can search [ForwardIt, ForwardIt) with up and bp
+//! through the SIMD kernels.
+template <class ForwardIt, class UnaryPredicate, class BinaryPredicate,
+          class Enable = void>
+struct is_simd_best_if : std::false_type {};
+
+template <class ForwardIt, class UnaryPredicate, class BinaryPredicate>
+struct is_simd_best_if<ForwardIt, UnaryPredicate, BinaryPredicate,
+    std::conditional_t<true, void, decltype(simd_predicate<UnaryPredicate,
+        typename std::iterator_traits<ForwardIt>::value_type>::op)> >
+    : std::integral_constant<bool,
+          is_contiguous_iterator<ForwardIt>::value &&
+          detail_simd_trx::is_simd_element<
+              typename std::iterator_traits<ForwardIt>::value_type>::value &&
+          radix_direction<
+              typename std::iterator_traits<ForwardIt>::value_type,
+              BinaryPredicate>::value != 0> {};
+
+//! best_if's helper for the general case
+template <class ForwardIt, class UnaryPredicate, class BinaryPredicate>
+ForwardIt best_if_impl(ForwardIt first, ForwardIt last, UnaryPredicate &up,
+                       BinaryPredicate &bp, std::false_type) {
+  ForwardIt best = last;
+  for (; first!=last; ++first)
+    if (up(*first) && (best==last || bp(*first, *best)))
+      best = first;
+  return best;
+}
+
+//! best_if's helper for contiguous ranges of arithmetic values, searched by
+//! the SIMD kernels. Ranges holding NaNs are left to the general case.
+template <class ForwardIt, class UnaryPredicate, class BinaryPredicate>
+ForwardIt best_if_impl(ForwardIt first, ForwardIt last, UnaryPredicate &up,
+                       BinaryPredicate &bp, std::true_type) {
+  using value_type = typename std::iterator_traits<ForwardIt>::value_type;
+  using predicate = simd_predicate<UnaryPredicate, value_type>;
+  constexpr bool maximum = radix_direction<value_type,
+                                           BinaryPredicate>::value == -1;
+  if (first == last)
+    return last;
+  const std::size_t n = std::distance(first, last);
+  const std::size_t best =
+      detail_simd_trx::first_best_index<predicate::op, maximum>(
+          static_cast<const value_type *>(std::addressof(*first)), n,
+          predicate::bound(up));
+  if (best > n)
+    return best_if_impl(first, last, up, bp, std::false_type());
+  return std::next(first, best);
+}
+
+//! best_if's helper for ranges of segmented iterators, searched one block
+//! after the other through pointers, so that each block takes the SIMD
+//! kernels when the elements of a contiguous range would
+template <class RandomIt, class UnaryPredicate, class BinaryPredicate>
+RandomIt best_if_range(RandomIt first, RandomIt last, UnaryPredicate &up,
+                       BinaryPredicate &bp, std::true_type) {
+  using pointer = decltype(std::addressof(*first));
+  RandomIt best = last, block_first = first;
+  for_each_block(first, last, [&](pointer lo, pointer hi) {
+    const pointer found = best_if_impl(
+        lo, hi, up, bp,
+        is_simd_best_if<pointer, UnaryPredicate, BinaryPredicate>());
+    if (found != hi && (best == last || bp(*found, *best)))
+      best = block_first+(found-lo);
+    block_first += hi-lo;
+  });
+  return best;
+}
+
+template <class ForwardIt, class UnaryPredicate, class BinaryPredicate>
+inline ForwardIt best_if_range(ForwardIt first, ForwardIt last,
+                               UnaryPredicate &up, BinaryPredicate &bp,
+                               std::false_type) {
+  return best_if_impl(
+      first, last, up, bp,
+      is_simd_best_if<ForwardIt, UnaryPredicate, BinaryPredicate>());
+}
+
+//! Tells how reduce_if's SIMD path fills the state of Reducer for elements
+//! of type T from the match_stats of the kernels. Only specialized for the
+//! reducers it can fill.
+template <class Reducer, class T, class Enable = void>
+struct simd_reducer {};
+
+template <class Comp, class T>
+struct simd_reducer<best_reducer<Comp>, T,
+                    std::enable_if_t<radix_direction<T, Comp>::value != 0> > {
+  template <class ForwardIt>
+  static ForwardIt state(const detail_simd_trx::match_stats &stats,
+                         ForwardIt first, ForwardIt last) {
+    const std::size_t index = radix_direction<T, Comp>::value == 1 ?
+        stats.min_index : stats.max_index;
+    return stats.count == 0 ? last : std::next(first, index);
+  }
+};
+
+template <class T>
+struct simd_reducer<count_reducer, T> {
+  template <class ForwardIt>
+  static std::size_t state(const detail_simd_trx::match_stats &stats,
+                           ForwardIt, ForwardIt) {
+    return stats.count;
+  }
+};
+
+//! Checks whether simd_reducer is specialized for Reducer and T.
+template <class Reducer, class T, class Enable = void>
+struct has_simd_reducer : std::false_type {};
+
+template <class Reducer, class T>
+struct has_simd_reducer<Reducer, T, std::conditional_t<true, void, decltype(
+    &simd_reducer<Reducer, T>::template state<const T *>)> >
+    : std::true_type {};
+
+//! Checks whether reduce_if can fold [ForwardIt, ForwardIt) with up and
+//! Reducers through the SIMD kernels.
+template <class ForwardIt, class UnaryPredicate, class Reducers,
+          class Enable = void>
+struct is_simd_reduce_if : std::false_type {};
+
+template <class ForwardIt, class UnaryPredicate, class... Reducers>
+struct is_simd_reduce_if<ForwardIt, UnaryPredicate, std::tuple<Reducers...>,
+    std::conditional_t<true, void, decltype(simd_predicate<UnaryPredicate,
+        typename std::iterator_traits<ForwardIt>::value_type>::op)> >
+    : std::integral_constant<bool,
+          is_contiguous_iterator<ForwardIt>::value &&
+          detail_simd_trx::is_simd_element<
+              typename std::iterator_traits<ForwardIt>::value_type>::value &&
+          tlx_and<has_simd_reducer<Reducers,
+              typename std::iterator_traits<ForwardIt>::value_type
+              >::value...>()> {};
+
+//! The states reduce_if folds [ForwardIt, ForwardIt) into with Reducers
+template <class ForwardIt, class... Reducers>
+using reduce_states = std::tuple<decltype(
+    std::declval<const Reducers &>().init(std::declval<ForwardIt>()))...>;
+
+//! reduce_if's helper for the general case, folding [first, last) into the
+//! states of a range ending at end in a single pass
+template <class ForwardIt, class UnaryPredicate, class... Reducers,
+          std::size_t... I>
+reduce_states<ForwardIt, Reducers...> reduce_if_impl(
+    ForwardIt first, ForwardIt last, ForwardIt end, UnaryPredicate &up,
+    const std::tuple<Reducers...> &reducers, std::index_sequence<I...>,
+    std::false_type) {
+  reduce_states<ForwardIt, Reducers...> states(
+      std::get<I>(reducers).init(end)...);
+  for (; first != last; ++first)
+    if (up(*first)) {
+      const int expand[] = {0, (std::get<I>(reducers).add(
+          std::get<I>(states), first, end), 0)...};
+      (void)expand;
+    }
+  return states;
+}
+
+//! reduce_if's helper for contiguous ranges of arithmetic values, folded by
+//! a single match_stats kernel whatever the number of reducers. Ranges
+//! holding NaNs are left to the general case.
+template <class ForwardIt, class UnaryPredicate, class... Reducers,
+          std::size_t... I>
+reduce_states<ForwardIt, Reducers...> reduce_if_impl(
+    ForwardIt first, ForwardIt last, ForwardIt end, UnaryPredicate &up,
+    const std::tuple<Reducers...> &reducers, std::index_sequence<I...> seq,
+    std::true_type) {
+  using value_type = typename std::iterator_traits<ForwardIt>::value_type;
+  using predicate = simd_predicate<UnaryPredicate, value_type>;
+  detail_simd_trx::match_stats stats;
+  if (first == last ||
+      !detail_simd_trx::match_stats_of<predicate::op>(
+          static_cast<const value_type *>(std::addressof(*first)),
+          static_cast<std::size_t>(std::distance(first, last)),
+          predicate::bound(up), stats) ||
+      stats.nan)
+    return reduce_if_impl(first, last, end, up, reducers, seq,
+                          std::false_type());
+  return reduce_states<ForwardIt, Reducers...>(
+      simd_reducer<Reducers, value_type>::state(stats, first, end)...);
+}
+
+//! Folds [first, last) into the states of a range ending at end.
+template <class ForwardIt, class UnaryPredicate, class... Reducers>
+reduce_states<ForwardIt, Reducers...> reduce_range(
+    ForwardIt first, ForwardIt last, ForwardIt end, UnaryPredicate &up,
+    const std::tuple<Reducers...> &reducers) {
+  return reduce_if_impl(first, last, end, up, reducers,
+                        std::index_sequence_for<Reducers...>(),
+                        is_simd_reduce_if<ForwardIt, UnaryPredicate,
+                                          std::tuple<Reducers...> >());
+}
+
+//! Folds right, the states of the range following that of left, into left.
+template <class ForwardIt, class... Reducers, std::size_t... I>
+void merge_states(reduce_states<ForwardIt, Reducers...> &left,
+                  const reduce_states<ForwardIt, Reducers...> &right,
+                  ForwardIt end, const std::tuple<Reducers...> &reducers,
+                  std::index_sequence<I...>) {
+  const int expand[] = {0, (std::get<I>(reducers).merge(
+      std::get<I>(left), std::get<I>(right), end), 0)...};
+  (void)expand;
+}
+
+//! Returns the first greatest argument as ordered by comp. Only pointers to
+//! the arguments are stored, so that nothing is copied.
+template <class Comp, class Arg, class... Args>
+constexpr const Arg &max_among_impl(Comp &comp, const Arg &first,
+                                    const Args &... rest) {
+  static_assert(tlx_all_same<Arg, Args...>(),
+                "All arguments must have the same type.");
+  const Arg *arguments[] = {&first, &rest...};
+  const Arg *best = arguments[0];
+  for (const Arg *argument : arguments)
+    if (comp(*best, *argument))
+      best = argument;
+  return *best;
+}
+
+//! Returns the first smallest argument as ordered by comp.
+template <class Comp, class Arg, class... Args>
+constexpr const Arg &min_among_impl(Comp &comp, const Arg &first,
+                                    const Args &... rest) {
+  static_assert(tlx_all_same<Arg, Args...>(),
+                "All arguments must have the same type.");
+  const Arg *arguments[] = {&first, &rest...};
+  const Arg *best = arguments[0];
+  for (const Arg *argument : arguments)
+    if (comp(*argument, *best))
+      best = argument;
+  return *best;
+}
+
+//! Returns the first smallest and the last greatest arguments as ordered by
+//! comp, like std::minmax.
+template <class Comp, class Arg, class... Args>
+constexpr std::pair<const Arg &, const Arg &> minmax_among_impl(
+    Comp &comp, const Arg &first, const Args &... rest) {
+  static_assert(tlx_all_same<Arg, Args...>(),
+                "All arguments must have the same type.");
+  const Arg *arguments[] = {&first, &rest...};
+  const Arg *min = arguments[0], *max = arguments[0];
+  for (const Arg *argument : arguments) {
+    if (comp(*argument, *min))
+      min = argument;
+    if (!comp(*argument, *max))
+      max = argument;
+  }
+  return std::pair<const Arg &, const Arg &>(*min, *max);
+}
+
+//! max_among_common's helper for arguments of the same type: the winner is
+//! found by reference and copied once.
+template <class Common, class Arg, class... Args>
+constexpr Common max_among_common_impl(std::integral_constant<int, 2>,
+                                       const Arg &first,
+                                       const Args &... rest) {
+  std::less<> comp;
+  return max_among_impl(comp, first, rest...);
+}
+
+//! max_among_common's helper for arithmetic arguments: every argument is
+//! promoted, and the selection below has no branch, so that it lowers to
+//! max/cmov instructions.
+template <class Common, class... Args>
+constexpr Common max_among_common_impl(std::integral_constant<int, 1>,
+                                       const Args &... args) {
+  const Common arguments[] = {static_cast<Common>(args)...};
+  Common best = arguments[0];
+  for (Common argument : arguments)
+    best = best < argument ? argument : best;
+  return best;
+}
+
+//! max_among_common's helper for other heterogeneous arguments, which are
+//! compared as Common.
+template <class Common, class... Args>
+constexpr Common max_among_common_impl(std::integral_constant<int, 0>,
+                                       const Args &... args) {
+  const Common arguments[] = {static_cast<Common>(args)...};
+  const Common *best = arguments;
+  for (const Common &argument : arguments)
+    if (*best < argument)
+      best = &argument;
+  return *best;
+}
+
+//! A tournament tree over k sorted sources, whose inner nodes hold the loser
+//! of the match played there, so that replacing the winner replays a single
+//! path of logk matches. Ties go to the earlier source, exhausted sources
+//! lose to all others.
+template <class Source, class Comp>
+class loser_tree {
+public:
+  loser_tree(scratch_vector<Source *> sources, Comp &comp)
+      : sources_(std::move(sources)), tree_(sources_.size()), comp_(comp) {
+    tree_[0] = build(1);
+  }
+
+  bool empty() const noexcept { return sources_[tree_[0]]->empty(); }
+
+  //! Returns the source holding the smallest record.
+  Source &top() const noexcept { return *sources_[tree_[0]]; }
+
+  //! Restores the tree once the front of top() has been popped.
+  void replay() {
+    const std::size_t k = sources_.size();
+    std::size_t winner = tree_[0];
+    for (std::size_t node = (winner+k)/2; node != 0; node /= 2)
+      if (beats(tree_[node], winner))
+        std::swap(tree_[node], winner);
+    tree_[0] = winner;
+  }
+
+private:
+  bool beats(std::size_t lhs, std::size_t rhs) const {
+    const Source &left = *sources_[lhs], &right = *sources_[rhs];
+    if (left.empty() || right.empty())
+      return right.empty() && (!left.empty() || lhs < rhs);
+    if (comp_(left.front(), right.front()))
+      return true;
+    return !comp_(right.front(), left.front()) && lhs < rhs;
+  }
+
+  //! Plays the matches below node, the leaves being the nodes from k on, and
+  //! returns the winner.
+  std::size_t build(std::size_t node) {
+    const std::size_t k = sources_.size();
+    if (node >= k)
+      return node-k;
+    const std::size_t lhs = build(2*node), rhs = build(2*node+1);
+    const bool left_wins = beats(lhs, rhs);
+    tree_[node] = left_wins ? rhs : lhs;
+    return left_wins ? lhs : rhs;
+  }
+
+  scratch_vector<Source *> sources_;
+  scratch_vector<std::size_t> tree_;
+  Comp &comp_;
+};
+
+//! Inputs are galloped over when one is this many times longer than the
+//! other, and merged linearly otherwise.
+constexpr std::size_t gallop_ratio = 64;
+
+//! Integers are intersected by the SIMD kernels when the longer input is
+//! less than this many times longer than the other: past it, the scalar
+//! loop is as fast, as it mostly advances in the longer one.
+constexpr std::size_t simd_intersection_ratio = 10;
+
+//! Returns the first iterator of [first, last) whose element fails pred,
+//! which must be true on a prefix of the range: first+1, first+2, first+4...
+//! are probed before a binary search, so that a result at distance d costs
+//! O(logd) calls of pred.
+template <class RandomIt, class Pred>
+RandomIt gallop(RandomIt first, RandomIt last, Pred pred) {
+  const std::size_t n = std::distance(first, last);
+  std::size_t lo = 0, hi = 1;
+  while (hi <= n && pred(first[hi-1])) {
+    lo = hi;
+    hi *= 2;
+  }
+  return std::partition_point(first+lo, first+std::min(hi, n), pred);
+}
+
+//! Checks whether the set operations can gallop over ranges of It1 and It2,
+//! which is when both are random access.
+template <class It1, class It2>
+struct can_gallop : std::integral_constant<bool,
+    std::is_base_of<std::random_access_iterator_tag,
+        typename std::iterator_traits<It1>::iterator_category>::value &&
+    std::is_base_of<std::random_access_iterator_tag,
+        typename std::iterator_traits<It2>::iterator_category>::value> {};
+
+//! merge's helper for other iterators
+template <class It1, class It2, class OutputIt, class Comp>
+inline OutputIt merge_range(It1 first1, It1 last1, It2 first2, It2 last2,
+                            OutputIt out, Comp &comp, std::false_type) {
+  return std::merge(first1, last1, first2, last2, out, comp);
+}
+
+//! merge's helper for random access iterators: each element of the shorter
+//! range is preceded by the elements of the longer one found by galloping
+//! from the previous one, when the sizes are skewed enough
+template <class It1, class It2, class OutputIt, class Comp>
+OutputIt merge_range(It1 first1, It1 last1, It2 first2, It2 last2,
+                     OutputIt out, Comp &comp, std::true_type) {
+  const std::size_t n1 = std::distance(first1, last1);
+  const std::size_t n2 = std::distance(first2, last2);
+  if (n1 > n2/gallop_ratio && n2 > n1/gallop_ratio)
+    return std::merge(first1, last1, first2, last2, out, comp);
+  if (n1 <= n2) {
+    // the elements of the second range equivalent to x go after it
+    for (; first1 != last1; ++first1) {
+      const auto &x = *first1;
+      const It2 next = gallop(first2, last2,
+                              [&](const auto &y){ return comp(y, x); });
+      out = std::copy(first2, next, out);
+      *out = x;
+      ++out;
+      first2 = next;
+    }
+    return std::copy(first2, last2, out);
+  }
+  for (; first2 != last2; ++first2) {
+    const auto &y = *first2;
+    const It1 next = gallop(first1, last1,
+                            [&](const auto &x){ return !comp(y, x); });
+    out = std::copy(first1, next, out);
+    *out = y;
+    ++out;
+    first1 = next;
+  }
+  return std::copy(first1, last1, out);
+}
+
+//! Merges [first1, last1) and [first2, last2) into out as std::merge does.
+template <class It1, class It2, class OutputIt, class Comp>
+inline OutputIt merge_range(It1 first1, It1 last1, It2 first2, It2 last2,
+                            OutputIt out, Comp &comp) {
+  return merge_range(first1, last1, first2, last2, out, comp,
+                     can_gallop<It1, It2>());
+}
+
+//! Checks whether set_intersection can intersect ranges of It1 and It2 with
+//! comp through the SIMD kernels: contiguous ranges of the same integers,
+//! in ascending order.
+template <class It1, class It2, class Comp>
+struct is_simd_intersection : std::integral_constant<bool,
+    is_contiguous_iterator<It1>::value &&
+    is_contiguous_iterator<It2>::value &&
+    std::is_same<typename std::iterator_traits<It1>::value_type,
+                 typename std::iterator_traits<It2>::value_type>::value &&
+    std::is_integral<typename std::iterator_traits<It1>::value_type>::value &&
+    detail_simd_trx::is_simd_element<
+        typename std::iterator_traits<It1>::value_type>::value &&
+    radix_direction<typename std::iterator_traits<It1>::value_type,
+                    Comp>::value == 1> {};
+
+//! set_intersection's helper for ranges of similar sizes
+template <class It1, class It2, class OutputIt, class Comp>
+inline OutputIt intersect_linear(It1 first1, It1 last1, It2 first2,
+                                 It2 last2, OutputIt out, Comp &comp,
+                                 std::false_type) {
+  return std::set_intersection(first1, last1, first2, last2, out, comp);
+}
+
+//! set_intersection's helper for integers of similar sizes, intersected by
+//! the SIMD kernels when both ranges are strictly increasing and neither is
+//! much longer
+template <class It1, class It2, class OutputIt, class Comp>
+OutputIt intersect_linear(It1 first1, It1 last1, It2 first2, It2 last2,
+                          OutputIt out, Comp &comp, std::true_type) {
+  using value_type = typename std::iterator_traits<It1>::value_type;
+  const std::size_t n1 = std::distance(first1, last1);
+  const std::size_t n2 = std::distance(first2, last2);
+  const std::size_t most = std::min(n1, n2);
+  if (most == 0)
+    return out;
+  if (std::max(n1, n2)/simd_intersection_ratio >= most)
+    return std::set_intersection(first1, last1, first2, last2, out, comp);
+  scratch_vector<value_type> found(most+1);
+  const std::size_t count = detail_simd_trx::intersect_sorted(
+      static_cast<const value_type *>(std::addressof(*first1)), n1,
+      static_cast<const value_type *>(std::addressof(*first2)), n2,
+      found.data());
+  if (count > most)
+    return std::set_intersection(first1, last1, first2, last2, out, comp);
+  return std::copy(found.begin(), found.begin()+count, out);
+}
+
+//! set_intersection's helper for other iterators
+template <class It1, class It2, class OutputIt, class Comp>
+inline OutputIt intersect_range(It1 first1, It1 last1, It2 first2,
+                                It2 last2, OutputIt out, Comp &comp,
+                                std::false_type) {
+  return std::set_intersection(first1, last1, first2, last2, out, comp);
+}
+
+//! set_intersection's helper for random access iterators: each element of
+//! the shorter range is looked for by galloping in the longer one from the
+//! previous match, when the sizes are skewed enough
+template <class It1, class It2, class OutputIt, class Comp>
+OutputIt intersect_range(It1 first1, It1 last1, It2 first2, It2 last2,
+                         OutputIt out, Comp &comp, std::true_type) {
+  const std::size_t n1 = std::distance(first1, last1);
+  const std::size_t n2 = std::distance(first2, last2);
+  if (n1 > n2/gallop_ratio && n2 > n1/gallop_ratio)
+    return intersect_linear(first1, last1, first2, last2, out, comp,
+                            is_simd_intersection<It1, It2, Comp>());
+  if (n1 <= n2) {
+    for (; first1 != last1 && first2 != last2; ++first1) {
+      const auto &x = *first1;
+      first2 = gallop(first2, last2, [&](const auto &y){ return comp(y, x); });
+      if (first2 != last2 && !comp(x, *first2)) {
+        *out = x;
+        ++out;
+        ++first2;
+      }
+    }
+    return out;
+  }
+  for (; first2 != last2 && first1 != last1; ++first2) {
+    const auto &y = *first2;
+    first1 = gallop(first1, last1, [&](const auto &x){ return comp(x, y); });
+    if (first1 != last1 && !comp(y, *first1)) {
+      *out = *first1;
+      ++out;
+      ++first1;
+    }
+  }
+  return out;
+}
+
+//! Intersects [first1, last1) and [first2, last2) into out as
+//! std::set_intersection does.
+template <class It1, class It2, class OutputIt, class Comp>
+inline OutputIt intersect_range(It1 first1, It1 last1, It2 first2,
+                                It2 last2, OutputIt out, Comp &comp) {
+  return intersect_range(first1, last1, first2, last2, out, comp,
+                         can_gallop<It1, It2>());
+}
+
+//! set_union's helper for other iterators
+template <class It1, class It2, class OutputIt, class Comp>
+inline OutputIt unite_range(It1 first1, It1 last1, It2 first2, It2 last2,
+                            OutputIt out, Comp &comp, std::false_type) {
+  return std::set_union(first1, last1, first2, last2, out, comp);
+}
+
+//! set_union's helper for random access iterators: the elements of the
+//! longer range between two elements of the shorter one are found by
+//! galloping, when the sizes are skewed enough
+template <class It1, class It2, class OutputIt, class Comp>
+OutputIt unite_range(It1 first1, It1 last1, It2 first2, It2 last2,
+                     OutputIt out, Comp &comp, std::true_type) {
+  const std::size_t n1 = std::distance(first1, last1);
+  const std::size_t n2 = std::distance(first2, last2);
+  if (n1 > n2/gallop_ratio && n2 > n1/gallop_ratio)
+    return std::set_union(first1, last1, first2, last2, out, comp);
+  if (n1 <= n2) {
+    // x stands for an equivalent element of the second range
+    for (; first1 != last1; ++first1) {
+      const auto &x = *first1;
+      const It2 next = gallop(first2, last2,
+                              [&](const auto &y){ return comp(y, x); });
+      out = std::copy(first2, next, out);
+      *out = x;
+      ++out;
+      first2 = next != last2 && !comp(x, *next) ? std::next(next) : next;
+    }
+    return std::copy(first2, last2, out);
+  }
+  // an equivalent element of the first range stands for y
+  for (; first2 != last2; ++first2) {
+    const auto &y = *first2;
+    const It1 next = gallop(first1, last1,
+                            [&](const auto &x){ return comp(x, y); });
+    out = std::copy(first1, next, out);
+    first1 = next;
+    if (first1 != last1 && !comp(y, *first1)) {
+      *out = *first1;
+      ++first1;
+    } else {
+      *out = y;
+    }
+    ++out;
+  }
+  return std::copy(first1, last1, out);
+}
+
+//! Unites [first1, last1) and [first2, last2) into out as std::set_union
+//! does.
+template <class It1, class It2, class OutputIt, class Comp>
+inline OutputIt unite_range(It1 first1, It1 last1, It2 first2, It2 last2,
+                            OutputIt out, Comp &comp) {
+  return unite_range(first1, last1, first2, last2, out, comp,
+                     can_gallop<It1, It2>());
+}
+
+//! Cuts the sorted ranges [first1, first1+n1) and [first2, first2+n2) into
+//! the given number of parts of about equal total size, part k of each
+//! range being [cuts[k], cuts[k+1]). The cuts are placed at ranks of the
+//! merged ranges; unless exact, they are then moved before the elements
+//! equivalent to the element at that rank, so that equivalent elements
+//! fall into the same part.
+template <class RandomIt1, class RandomIt2, class Comp>
+void cut_sorted(RandomIt1 first1, std::size_t n1, RandomIt2 first2,
+                std::size_t n2, Comp &comp, bool exact,
+                scratch_vector<std::size_t> &cuts1,
+                scratch_vector<std::size_t> &cuts2) {
+  const std::size_t parts = cuts1.size()-1;
+  cuts1.back() = n1;
+  cuts2.back() = n2;
+  for (std::size_t k = 1; k != parts; ++k) {
+    const std::size_t rank = (n1+n2)/parts*k;
+    // the elements of the first range among the rank first of the merge
+    std::size_t lo = rank > n2 ? rank-n2 : 0, hi = std::min(rank, n1);
+    while (lo < hi) {
+      const std::size_t i = lo+(hi-lo)/2;
+      if (comp(first2[rank-i-1], first1[i]))
+        hi = i;
+      else
+        lo = i+1;
+    }
+    std::size_t i = lo, j = rank-lo;
+    if (!exact) {
+      if (i != n1 && (j == n2 || !comp(first2[j], first1[i]))) {
+        const auto &value = first1[i];
+        j = std::lower_bound(first2, first2+n2, value, comp)-first2;
+        i = std::lower_bound(first1, first1+i, value, comp)-first1;
+      } else {
+        const auto &value = first2[j];
+        i = std::lower_bound(first1, first1+i, value, comp)-first1;
+        j = std::lower_bound(first2, first2+j, value, comp)-first2;
+      }
+    }
+    // the cuts of equal ranks must stay ordered
+    cuts1[k] = std::max(i, cuts1[k-1]);
+    cuts2[k] = std::max(j, cuts2[k-1]);
+  }
+}
+
+//! Runs the set operation op(first1, last1, first2, last2, out) over the
+//! parts of the not exact cut_sorted of the ranges on the pool, each part
+//! into a buffer, and moves the buffers into out in order.
+template <class RandomIt1, class RandomIt2, class OutputIt, class Comp,
+          class Op>
+OutputIt parallel_set_operation(thread_pool &pool, RandomIt1 first1,
+                                RandomIt1 last1, RandomIt2 first2,
+                                RandomIt2 last2, OutputIt out, Comp &comp,
+                                Op op) {
+  using value_type = typename std::iterator_traits<RandomIt1>::value_type;
+  const std::size_t n1 = std::distance(first1, last1);
+  const std::size_t n2 = std::distance(first2, last2);
+  const std::size_t parts = std::min(pool.size(), (n1+n2)/parallel_cutoff);
+  if (parts < 2)
+    return op(first1, last1, first2, last2, out);
+  scratch_vector<std::size_t> cuts1(parts+1), cuts2(parts+1);
+  cut_sorted(first1, n1, first2, n2, comp, false, cuts1, cuts2);
+  // the buffers outlive the tasks, so they are not taken from the arenas of
+  // the pool's threads
+  std::vector<std::vector<value_type> > results(parts);
+  pool.run(parts, [&](std::size_t k) {
+    op(first1+cuts1[k], first1+cuts1[k+1], first2+cuts2[k],
+       first2+cuts2[k+1], std::back_inserter(results[k]));
+  });
+  for (auto &result : results)
+    out = std::move(result.begin(), result.end(), out);
+  return out;
+}
+
+//! merge's helper on a pool: the exact cuts of the ranges are merged
+//! concurrently, straight into out if it is random access
+template <class RandomIt1, class RandomIt2, class OutputIt, class Comp>
+OutputIt parallel_merge(thread_pool &pool, RandomIt1 first1, RandomIt1 last1,
+                        RandomIt2 first2, RandomIt2 last2, OutputIt out,
+                        Comp &comp, std::true_type) {
+  const std::size_t n1 = std::distance(first1, last1);
+  const std::size_t n2 = std::distance(first2, last2);
+  const std::size_t parts = std::min(pool.size(), (n1+n2)/parallel_cutoff);
+  if (parts < 2)
+    return merge_range(first1, last1, first2, last2, out, comp);
+  scratch_vector<std::size_t> cuts1(parts+1), cuts2(parts+1);
+  cut_sorted(first1, n1, first2, n2, comp, true, cuts1, cuts2);
+  pool.run(parts, [&](std::size_t k) {
+    merge_range(first1+cuts1[k], first1+cuts1[k+1], first2+cuts2[k],
+                first2+cuts2[k+1], out+(cuts1[k]+cuts2[k]), comp);
+  });
+  return out+(n1+n2);
+}
+
+template <class RandomIt1, class RandomIt2, class OutputIt, class Comp>
+inline OutputIt parallel_merge(thread_pool &pool, RandomIt1 first1,
+                               RandomIt1 last1, RandomIt2 first2,
+                               RandomIt2 last2, OutputIt out, Comp &comp,
+                               std::false_type) {
+  return parallel_set_operation(
+      pool, first1, last1, first2, last2, out, comp,
+      [&comp](auto f1, auto l1, auto f2, auto l2, auto o) {
+        return merge_range(f1, l1, f2, l2, o, comp);
+      });
+}
+
+//! merge's(policy) helper for iterators which are not random access
+template <class It1, class It2, class OutputIt, class Comp>
+inline OutputIt merge_on(thread_pool *, It1 first1, It1 last1, It2 first2,
+                         It2 last2, OutputIt out, Comp &comp,
+                         std::false_type) {
+  return merge_range(first1, last1, first2, last2, out, comp);
+}
+
+//! merge's(policy) helper for random access iterators
+template <class It1, class It2, class OutputIt, class Comp>
+inline OutputIt merge_on(thread_pool *pool, It1 first1, It1 last1,
+                         It2 first2, It2 last2, OutputIt out, Comp &comp,
+                         std::true_type) {
+  using category = typename std::iterator_traits<OutputIt>::iterator_category;
+  if (!pool)
+    return merge_range(first1, last1, first2, last2, out, comp);
+  return parallel_merge(
+      *pool, first1, last1, first2, last2, out, comp,
+      std::is_base_of<std::random_access_iterator_tag, category>());
+}
+
+//! set_intersection's(policy) helper for iterators which are not random
+//! access
+template <class It1, class It2, class OutputIt, class Comp>
+inline OutputIt intersect_on(thread_pool *, It1 first1, It1 last1,
+                             It2 first2, It2 last2, OutputIt out, Comp &comp,
+                             std::false_type) {
+  return intersect_range(first1, last1, first2, last2, out, comp);
+}
+
+//! set_intersection's(policy) helper for random access iterators
+template <class It1, class It2, class OutputIt, class Comp>
+inline OutputIt intersect_on(thread_pool *pool, It1 first1, It1 last1,
+                             It2 first2, It2 last2, OutputIt out, Comp &comp,
+                             std::true_type) {
+  if (!pool)
+    return intersect_range(first1, last1, first2, last2, out, comp);
+  return parallel_set_operation(
+      *pool, first1, last1, first2, last2, out, comp,
+      [&comp](auto f1, auto l1, auto f2, auto l2, auto to) {
+        return intersect_range(f1, l1, f2, l2, to, comp);
+      });
+}
+
+//! set_union's(policy) helper for iterators which are not random access
+template <class It1, class It2, class OutputIt, class Comp>
+inline OutputIt unite_on(thread_pool *, It1 first1, It1 last1, It2 first2,
+                         It2 last2, OutputIt out, Comp &comp,
+                         std::false_type) {
+  return unite_range(first1, last1, first2, last2, out, comp);
+}
+
+//! set_union's(policy) helper for random access iterators
+template <class It1, class It2, class OutputIt, class Comp>
+inline OutputIt unite_on(thread_pool *pool, It1 first1, It1 last1,
+                         It2 first2, It2 last2, OutputIt out, Comp &comp,
+                         std::true_type) {
+  if (!pool)
+    return unite_range(first1, last1, first2, last2, out, comp);
+  return parallel_set_operation(
+      *pool, first1, last1, first2, last2, out, comp,
+      [&comp](auto f1, auto l1, auto f2, auto l2, auto to) {
+        return unite_range(f1, l1, f2, l2, to, comp);
+      });
+}
+
+//! merge_k's source: the remaining elements of a sorted container.
+template <class It>
+struct merge_cursor {
+  It first, last;
+
+  bool empty() const { return first == last; }
+  decltype(auto) front() const { return *first; }
+  void pop() { ++first; }
+};
+
+//! merge_k's helper: the non-empty containers are merged by a loser tree,
+//! two of them by merge_range
+template <class Range, class OutputIt, class Comp>
+OutputIt merge_k_impl(const Range &containers, OutputIt out, Comp &comp) {
+  using iterator = decltype(adl_begin(*adl_begin(containers)));
+  using cursor = merge_cursor<iterator>;
+  scratch_vector<cursor> cursors;
+  for (auto &&container : containers)
+    if (adl_begin(container) != adl_end(container))
+      cursors.push_back(cursor{adl_begin(container), adl_end(container)});
+  if (cursors.empty())
+    return out;
+  if (cursors.size() == 1)
+    return std::copy(cursors[0].first, cursors[0].last, out);
+  if (cursors.size() == 2)
+    return merge_range(cursors[0].first, cursors[0].last, cursors[1].first,
+                       cursors[1].last, out, comp);
+  scratch_vector<cursor *> sources;
+  sources.reserve(cursors.size());
+  for (cursor &source : cursors)
+    sources.push_back(&source);
+  loser_tree<cursor, Comp> tree(std::move(sources), comp);
+  do {
+    cursor &source = tree.top();
+    *out = source.front();
+    ++out;
+    source.pop();
+    tree.replay();
+  } while (!tree.empty());
+  return out;
+}
+
+} // namespace detail_algorithm_trx
+
+//! Searches for the best element among those for which predicate returns true.
+/*!
+  Searches for the best element among those for which predicate returns true.
+  If there are more than one best element, then the first one will be returned.
+  Contiguous ranges of arithmetic values are searched by SIMD kernels picked
+  for the running CPU (AVX-512, AVX2, SSE2 or NEON), when up is any_value or
+  one of less_than, greater_than, not_greater_than, not_less_than with a
+  bound of the element type, and bp is std::greater or std::less. Ranges of
+  segmented iterators, like those of std::deque (see
+  trx::segmented_iterator), are searched one block of contiguous elements
+  after the other, each as a contiguous range.
+  
+  Parameters
+  first, last - the range of elements to examine
+  up - unary predicate which returns true for the required sub range
+  bp - binary predicate which returns true if the first argument is better
+       than the second
+
+  Type requirements
+  ForwardIt must meet the requirements of ForwardIterator
+  UnaryPredicate must meet the requirements of unary predicate
+  BinaryPredicate must meet the requirements of binary predicate
+
+  Return value
+  Iterator to the best element in the sub range of [first, last). If several
+  elements in the range are equivalent to the best element, returns the
+  iterator to the first such element. Returns last if the sub range is empty.
+
+  Time Complexity
+  O(n), where n = std::distance(first, last).
+
+  Space Complexity
+  O(1)
+
+  Example
+  int numbers[] = {1,2,3,4,5,6,7,8,9,10};
+  assert(*best_if(numbers, std::end(numbers),
+                  [](int x){return x%2==1;}, // subranges of all odd numbers
+                  std::greater<int>()) // the biggest
+             == 9);
+*/
+template <class ForwardIt, class UnaryPredicate, class BinaryPredicate>
+ForwardIt best_if(ForwardIt first, ForwardIt last, UnaryPredicate up,
+                  BinaryPredicate bp) {
+  return detail_algorithm_trx::best_if_range(
+      first, last, up, bp, is_segmented_iterator<ForwardIt>());
+}
+
+//! Searches for the best element among those for which predicate returns true.
+/*!
+  Searches for the best element among those for which predicate returns true,
+  executed according to policy. The range is cut into chunks which are
+  searched concurrently, then the best elements of the chunks are combined
+  from left to right, so the first best element is still the one returned.
+  Ranges whose iterators are not random access are searched sequentially.
+
+  Parameters
+  policy - one of trx::execution::seq, par, par_unseq or
+           trx::execution::on(pool)
+  first, last - the range of elements to examine
+  up - unary predicate which returns true for the required sub range
+  bp - binary predicate which returns true if the first argument is better
+       than the second, it must induce a strict weak ordering
+
+  Type requirements
+  ForwardIt must meet the requirements of ForwardIterator
+  UnaryPredicate must meet the requirements of unary predicate
+  BinaryPredicate must meet the requirements of binary predicate
+  up and bp must be safe to call concurrently
+
+  Return value
+  Iterator to the best element in the sub range of [first, last). If several
+  elements in the range are equivalent to the best element, returns the
+  iterator to the first such element. Returns last if the sub range is empty.
+
+  Time Complexity
+  O(n/p+p), where n = std::distance(first, last) and p is the number of
+  threads.
+
+  Space Complexity
+  O(p)
+
+  Example
+  std::vector<int> numbers(1000000);
+  std::iota(numbers.begin(), numbers.end(), 0);
+  assert(*best_if(trx::execution::par, numbers.begin(), numbers.end(),
+                  [](int x){return x%2==1;}, std::greater<int>())
+             == 999999);
+*/
+template <class ExecutionPolicy, class ForwardIt, class UnaryPredicate,
+          class BinaryPredicate>
+std::enable_if_t<is_execution_policy<std::decay_t<ExecutionPolicy> >::value,
+                 ForwardIt>
+best_if(ExecutionPolicy &&policy, ForwardIt first, ForwardIt last,
+        UnaryPredicate up, BinaryPredicate bp) {
+  using category = typename std::iterator_traits<ForwardIt>::iterator_category;
+  thread_pool *pool = detail_execution_trx::pool_of(policy);
+  if (!pool || !std::is_base_of<std::random_access_iterator_tag,
+                                category>::value)
+    return best_if(first, last, up, bp);
+  const std::size_t n = std::distance(first, last);
+  const std::size_t chunk = std::max(
+      detail_algorithm_trx::parallel_cutoff, n/(pool->size()*4)+1);
+  scratch_vector<ForwardIt> bests((n+chunk-1)/chunk, last);
+  pool->run(bests.size(), [&](std::size_t k) {
+    ForwardIt chunk_first = first, chunk_last = first;
+    std::advance(chunk_first, k*chunk);
+    std::advance(chunk_last, std::min(n, (k+1)*chunk));
+    ForwardIt best = best_if(chunk_first, chunk_last, up, bp);
+    if (best != chunk_last)
+      bests[k] = best;
+  });
+  ForwardIt best = last;
+  for (ForwardIt candidate : bests)
+    if (candidate != last && (best == last || bp(*candidate, *best)))
+      best = candidate;
+  return best;
+}
+
+//! Folds the elements for which predicate returns true with several reducers
+//! in a single pass.
+/*!
+  Folds the elements for which predicate returns true with several reducers
+  in a single pass, so that asking for the min, the max and the count of a
+  range reads it once instead of three times. The reducers are returned by
+  reduce_best, reduce_min, reduce_max, reduce_count, reduce_sum,
+  reduce_first and reduce_last, or are user types following the interface
+  described at best_reducer.
+  Contiguous ranges of arithmetic values are folded by a single SIMD kernel
+  picked for the running CPU, under the same conditions on up as best_if,
+  when every reducer is reduce_min, reduce_max, reduce_count, or reduce_best
+  with std::less or std::greater.
+
+  Parameters
+  first, last - the range of elements to examine
+  up - unary predicate which returns true for the required sub range
+  reducers - the reducers folding the sub range
+
+  Type requirements
+  ForwardIt must meet the requirements of ForwardIterator
+  UnaryPredicate must meet the requirements of unary predicate
+
+  Return value
+  A std::tuple holding the result of each reducer in order: an iterator to
+  the first best, first or last matching element, or last if there is none,
+  for reduce_best, reduce_min, reduce_max, reduce_first and reduce_last; the
+  number of matching elements for reduce_count; their sum for reduce_sum.
+
+  Time Complexity
+  O(n*r), where n = std::distance(first, last) and r = sizeof...(Reducers),
+  with a single pass over the range.
+
+  Space Complexity
+  O(r)
+
+  Example
+  std::vector<double> prices = {3.5, 1.25, 8.0, 2.0, 8.0};
+  auto stats = trx::reduce_if(prices.begin(), prices.end(),
+                              trx::greater_than(1.5), trx::reduce_min(),
+                              trx::reduce_max(), trx::reduce_count(),
+                              trx::reduce_sum());
+  assert(*std::get<0>(stats) == 2.0);
+  assert(std::get<1>(stats) == prices.begin() + 2);
+  assert(std::get<2>(stats) == 4);
+  assert(std::get<3>(stats) == 21.5);
+*/
+template <class ForwardIt, class UnaryPredicate, class... Reducers>
+std::enable_if_t<!is_execution_policy<std::decay_t<ForwardIt> >::value,
+                 detail_algorithm_trx::reduce_states<ForwardIt, Reducers...> >
+reduce_if(ForwardIt first, ForwardIt last, UnaryPredicate up,
+          Reducers... reducers) {
+  const std::tuple<Reducers...> folded(reducers...);
+  return detail_algorithm_trx::reduce_range(first, last, last, up, folded);
+}
+
+//! Folds the elements for which predicate returns true with several reducers
+//! in a single pass.
+/*!
+  Folds the elements for which predicate returns true with several reducers
+  in a single pass, executed according to policy. The range is cut into
+  chunks which are folded concurrently, then the states of the chunks are
+  merged from left to right, so the first and last elements found are still
+  those of a sequential fold. Sums of floating-point values are associated
+  differently, and may differ in the last bits. Ranges whose iterators are
+  not random access are folded sequentially.
+
+  Parameters
+  policy - one of trx::execution::seq, par, par_unseq or
+           trx::execution::on(pool)
+  first, last - the range of elements to examine
+  up - unary predicate which returns true for the required sub range
+  reducers - the reducers folding the sub range
+
+  Type requirements
+  ForwardIt must meet the requirements of ForwardIterator
+  UnaryPredicate must meet the requirements of unary predicate
+  up and the reducers must be safe to call concurrently
+
+  Return value
+  As reduce_if(first, last, up, reducers...).
+
+  Time Complexity
+  O(n*r/p+p*r), where n = std::distance(first, last),
+  r = sizeof...(Reducers) and p is the number of threads.
+
+  Space Complexity
+  O(p*r)
+
+  Example
+  std::vector<int> numbers(1000000);
+  std::iota(numbers.begin(), numbers.end(), 0);
+  auto stats = trx::reduce_if(trx::execution::par, numbers.begin(),
+                              numbers.end(), [](int x){return x%2==1;},
+                              trx::reduce_max(), trx::reduce_count(),
+                              trx::reduce_sum<long long>());
+  assert(*std::get<0>(stats) == 999999);
+  assert(std::get<1>(stats) == 500000);
+  assert(std::get<2>(stats) == 250000000000LL);
+*/
+template <class ExecutionPolicy, class ForwardIt, class UnaryPredicate,
+          class... Reducers>
+std::enable_if_t<is_execution_policy<std::decay_t<ExecutionPolicy> >::value,
+                 detail_algorithm_trx::reduce_states<ForwardIt, Reducers...> >
+reduce_if(ExecutionPolicy &&policy, ForwardIt first, ForwardIt last,
+          UnaryPredicate up, Reducers... reducers) {
+  using category = typename std::iterator_traits<ForwardIt>::iterator_category;
+  using states = detail_algorithm_trx::reduce_states<ForwardIt, Reducers...>;
+  const std::tuple<Reducers...> folded(reducers...);
+  thread_pool *pool = detail_execution_trx::pool_of(policy);
+  if (!pool || !std::is_base_of<std::random_access_iterator_tag,
+                                category>::value)
+    return detail_algorithm_trx::reduce_range(first, last, last, up, folded);
+  const std::size_t n = std::distance(first, last);
+  const std::size_t chunk = std::max(
+      detail_algorithm_trx::parallel_cutoff, n/(pool->size()*4)+1);
+  scratch_vector<states> partial(
+      (n+chunk-1)/chunk,
+      detail_algorithm_trx::reduce_range(last, last, last, up, folded));
+  pool->run(partial.size(), [&](std::size_t k) {
+    ForwardIt chunk_first = first, chunk_last = first;
+    std::advance(chunk_first, k*chunk);
+    std::advance(chunk_last, std::min(n, (k+1)*chunk));
+    partial[k] = detail_algorithm_trx::reduce_range(chunk_first, chunk_last,
+                                                    last, up, folded);
+  });
+  states result = detail_algorithm_trx::reduce_range(last, last, last, up,
+                                                     folded);
+  for (const states &state : partial)
+    detail_algorithm_trx::merge_states(result, state, last, folded,
+                                       std::index_sequence_for<Reducers...>());
+  return result;
+}
+
+//! Searches the first n elements for the best one for which predicate returns
+//! true, stopping as soon as an optimum is found.
+/*!
+  Searches for the best element among the first n elements for which
+  predicate returns true, like best_if_n(first, n, up, bp) below, but returns as
+  soon as the best element found so far satisfies is_optimum, i.e. when the
+  caller knows that no element can be better. For instance a scheduler
+  looking for the most urgent task stops at the first task of the highest
+  priority.
+
+  Parameters
+  first - the beginning of the range of elements to examine
+  n - the number of elements to examine
+  up - unary predicate which returns true for the required sub range
+  bp - binary predicate which returns true if the first argument is better
+       than the second
+  is_optimum - unary predicate which returns true for an element no other
+               element can be better than
+
+  Type requirements
+  ForwardIt must meet the requirements of ForwardIterator
+  Size must be convertible to an integral type
+  UnaryPredicate and OptimumPredicate must meet the requirements of unary
+  predicate
+  BinaryPredicate must meet the requirements of binary predicate
+
+  Return value
+  Iterator to the first element satisfying both up and is_optimum, if any.
+  Otherwise as best_if_n(first, n, up, bp).
+
+  Time Complexity
+  O(n), at most k calls of up when the optimum is the k-th element.
+
+  Space Complexity
+  O(1)
+
+  Example
+  std::vector<int> priorities{3,1,0,2,0};
+  assert(best_if_n(priorities.begin(), priorities.size(), trx::any_value(),
+                   std::less<int>(), [](int p){return p==0;})
+             == priorities.begin()+2);
+*/
+template <class ForwardIt, class Size, class UnaryPredicate,
+          class BinaryPredicate, class OptimumPredicate>
+ForwardIt best_if_n(ForwardIt first, Size n, UnaryPredicate up,
+                    BinaryPredicate bp, OptimumPredicate is_optimum) {
+  ForwardIt best = first;
+  bool found = false;
+  for (; n > 0; ++first, --n) {
+    if (up(*first) && (!found || bp(*first, *best))) {
+      best = first;
+      found = true;
+      if (is_optimum(*best))
+        return best;
+    }
+  }
+  return found ? best : first;
+}
+
+//! Searches the first n elements for the best one for which predicate returns
+//! true.
+/*!
+  Searches for the best element among the first n elements for which
+  predicate returns true. If there are more than one best element, then the
+  first one will be returned. The range is given by its size, so it may be
+  delimited by an input iterator only.
+
+  Parameters
+  first - the beginning of the range of elements to examine
+  n - the number of elements to examine
+  up - unary predicate which returns true for the required sub range
+  bp - binary predicate which returns true if the first argument is better
+       than the second
+
+  Type requirements
+  ForwardIt must meet the requirements of ForwardIterator
+  Size must be convertible to an integral type
+  UnaryPredicate must meet the requirements of unary predicate
+  BinaryPredicate must meet the requirements of binary predicate
+
+  Return value
+  Iterator to the best element in the sub range of [first, first+n). If
+  several elements in the range are equivalent to the best element, returns
+  the iterator to the first such element. Returns first+n if the sub range is
+  empty.
+
+  Time Complexity
+  O(n)
+
+  Space Complexity
+  O(1)
+
+  Example
+  std::forward_list<int> numbers{1,2,3,4,5,6,7,8,9,10};
+  assert(*best_if_n(numbers.begin(), 5, [](int x){return x%2==1;},
+                    std::greater<int>()) == 5);
+*/
+template <class ForwardIt, class Size, class UnaryPredicate,
+          class BinaryPredicate>
+ForwardIt best_if_n(ForwardIt first, Size n, UnaryPredicate up,
+                    BinaryPredicate bp) {
+  return best_if_n(first, n, up, bp, [](const auto &){ return false; });
+}
+
+//! Returns the max element among the arguments.
+/*!
+  Returns the max element among the arguments.
+  All arguments must have the same type, while value category can be different.
+  Usable in constant expressions.
+  
+  Parameters
+  first - the first element.
+  rest... - the rest elements.
+
+  Return value
+  The max element, which is returned by value. If several elements are
+  equivalent to the max element, the first one is returned.
+
+  Time Complexity
+  O(n)
+
+  Space Complexity
+  O(n)
+  Note : n pointers are stored, only the max element is copied.
+
+  Example
+  static_assert(max_among(1, 2, 5, 4, 3) == 5, "");
+*/
+template <class Arg, class... Args>
+constexpr Arg max_among(const Arg &first, const Args&... rest) {
+  std::less<> comp;
+  return detail_algorithm_trx::max_among_impl(comp, first, rest...);
+}
+
+//! Returns a reference to the max element among the arguments.
+/*!
+  Returns a reference to the max element among the arguments, so that no
+  element is copied. All arguments must have the same type, while value
+  category can be different. Usable in constant expressions.
+  
+  Parameters
+  first - the first element.
+  rest... - the rest elements.
+
+  Return value
+  Reference to the max element. If several elements are equivalent to the max
+  element, the first one is returned. The reference dangles once the full
+  expression ends if the max element was a temporary.
+
+  Time Complexity
+  O(n)
+
+  Space Complexity
+  O(n)
+  Note : n pointers are stored, no data is copied.
+
+  Example
+  std::string a = "pear", b = "apple";
+  const std::string &last = max_among_ref(a, b);
+  assert(&last == &a);
+*/
+template <class Arg, class... Args>
+constexpr const Arg &max_among_ref(const Arg &first, const Args&... rest) {
+  std::less<> comp;
+  return detail_algorithm_trx::max_among_impl(comp, first, rest...);
+}
+
+//! Returns a reference to the max element among the arguments.
+/*!
+  Returns a reference to the max element among the arguments, using the
+  given comparison function comp to compare them. All arguments must have the
+  same type, while value category can be different. Usable in constant
+  expressions if comp is.
+  
+  Parameters
+  comp - comparison function object, returning true if the first argument is
+         less than the second.
+  first - the first element.
+  rest... - the rest elements.
+
+  Return value
+  Reference to the max element. If several elements are equivalent to the max
+  element, the first one is returned.
+
+  Time Complexity
+  O(n) calls of comp
+
+  Space Complexity
+  O(n)
+  Note : n pointers are stored, no data is copied.
+
+  Example
+  assert(max_among_by(std::greater<>(), 1, 2, 5, 4, 3) == 1);
+*/
+template <class Comp, class Arg, class... Args>
+constexpr const Arg &max_among_by(Comp comp, const Arg &first,
+                                  const Args&... rest) {
+  return detail_algorithm_trx::max_among_impl(comp, first, rest...);
+}
+
+//! Returns the min element among the arguments.
+/*!
+  Returns the min element among the arguments.
+  All arguments must have the same type, while value category can be different.
+  Usable in constant expressions.
+  
+  Parameters
+  first - the first element.
+  rest... - the rest elements.
+
+  Return value
+  The min element, which is returned by value. If several elements are
+  equivalent to the min element, the first one is returned.
+
+  Time Complexity
+  O(n)
+
+  Space Complexity
+  O(n)
+  Note : n pointers are stored, only the min element is copied.
+
+  Example
+  static_assert(min_among(4, 2, 5, 1, 3) == 1, "");
+*/
+template <class Arg, class... Args>
+constexpr Arg min_among(const Arg &first, const Args&... rest) {
+  std::less<> comp;
+  return detail_algorithm_trx::min_among_impl(comp, first, rest...);
+}
+
+//! Returns a reference to the min element among the arguments.
+/*!
+  Returns a reference to the min element among the arguments, so that no
+  element is copied. See max_among_ref.
+  
+  Parameters
+  first - the first element.
+  rest... - the rest elements.
+
+  Return value
+  Reference to the min element. If several elements are equivalent to the min
+  element, the first one is returned.
+
+  Time Complexity
+  O(n)
+
+  Space Complexity
+  O(n)
+  Note : n pointers are stored, no data is copied.
+
+  Example
+  std::string a = "pear", b = "apple";
+  assert(&min_among_ref(a, b) == &b);
+*/
+template <class Arg, class... Args>
+constexpr const Arg &min_among_ref(const Arg &first, const Args&... rest) {
+  std::less<> comp;
+  return detail_algorithm_trx::min_among_impl(comp, first, rest...);
+}
+
+//! Returns a reference to the min element among the arguments.
+/*!
+  Returns a reference to the min element among the arguments, using the
+  given comparison function comp to compare them. See max_among_by.
+  
+  Parameters
+  comp - comparison function object, returning true if the first argument is
+         less than the second.
+  first - the first element.
+  rest... - the rest elements.
+
+  Return value
+  Reference to the min element. If several elements are equivalent to the min
+  element, the first one is returned.
+
+  Time Complexity
+  O(n) calls of comp
+
+  Space Complexity
+  O(n)
+  Note : n pointers are stored, no data is copied.
+
+  Example
+  assert(min_among_by(std::greater<>(), 1, 2, 5, 4, 3) == 5);
+*/
+template <class Comp, class Arg, class... Args>
+constexpr const Arg &min_among_by(Comp comp, const Arg &first,
+                                  const Args&... rest) {
+  return detail_algorithm_trx::min_among_impl(comp, first, rest...);
+}
+
+//! Returns the min and the max elements among the arguments.
+/*!
+  Returns the min and the max elements among the arguments in a single pass.
+  All arguments must have the same type, while value category can be
+  different. Usable in constant expressions.
+  
+  Parameters
+  first - the first element.
+  rest... - the rest elements.
+
+  Return value
+  A pair of the min and the max elements, which are returned by value. As
+  std::minmax, the first min element and the last max element are returned.
+
+  Time Complexity
+  O(n)
+
+  Space Complexity
+  O(n)
+  Note : n pointers are stored, only the min and the max elements are copied.
+
+  Example
+  static_assert(minmax_among(4, 2, 5, 1, 3) == std::make_pair(1, 5), "");
+*/
+template <class Arg, class... Args>
+constexpr std::pair<Arg, Arg> minmax_among(const Arg &first,
+                                           const Args&... rest) {
+  std::less<> comp;
+  return detail_algorithm_trx::minmax_among_impl(comp, first, rest...);
+}
+
+//! Returns references to the min and the max elements among the arguments.
+/*!
+  Returns references to the min and the max elements among the arguments, so
+  that no element is copied. See minmax_among.
+  
+  Parameters
+  first - the first element.
+  rest... - the rest elements.
+
+  Return value
+  A pair of references to the first min element and the last max element.
+
+  Time Complexity
+  O(n)
+
+  Space Complexity
+  O(n)
+  Note : n pointers are stored, no data is copied.
+
+  Example
+  std::string a = "pear", b = "apple";
+  assert(&minmax_among_ref(a, b).second == &a);
+*/
+template <class Arg, class... Args>
+constexpr std::pair<const Arg &, const Arg &> minmax_among_ref(
+    const Arg &first, const Args&... rest) {
+  std::less<> comp;
+  return detail_algorithm_trx::minmax_among_impl(comp, first, rest...);
+}
+
+//! Returns references to the min and the max elements among the arguments.
+/*!
+  Returns references to the min and the max elements among the arguments,
+  using the given comparison function comp to compare them. See
+  minmax_among.
+  
+  Parameters
+  comp - comparison function object, returning true if the first argument is
+         less than the second.
+  first - the first element.
+  rest... - the rest elements.
+
+  Return value
+  A pair of references to the first min element and the last max element.
+
+  Time Complexity
+  O(n) calls of comp
+
+  Space Complexity
+  O(n)
+  Note : n pointers are stored, no data is copied.
+
+  Example
+  const int a = 1, b = 5, c = 3;
+  auto extremes = minmax_among_by(std::greater<>(), a, b, c);
+  assert(extremes.first == 5 && extremes.second == 1);
+*/
+template <class Comp, class Arg, class... Args>
+constexpr std::pair<const Arg &, const Arg &> minmax_among_by(
+    Comp comp, const Arg &first, const Args&... rest) {
+  return detail_algorithm_trx::minmax_among_impl(comp, first, rest...);
+}
+
+//! Returns the max element among the arguments.
+/*!
+  Returns the max element among the arguments.
+  All arguments must can be static_cast to Args, i.e. static_cast<Arg>(rest)
+  must be a valide expression.
+  
+  Parameters
+  first - the first element.
+  rest... - the rest elements.
+
+  Return value
+  The max element, which is returned by value(cast to the type of the first
+  element).
+
+  Time Complexity
+  O(n)
+
+  Space Complexity
+  O(n)
+  Note : n temporaries of type Arg are constructed.
+
+  Example
+  assert(max_among_trunc(1, 2, 5.0, 4.3, 3) == 5);
+*/
+template <class Arg, class... Args>
+constexpr Arg max_among_trunc(const Arg &first, const Args&... rest) {
+  return max_among(first, static_cast<Arg>(rest)...);
+}
+
+//! Returns the max element among the arguments, compared in their common type.
+/*!
+  Returns the max element among the arguments, compared in their common type
+  std::common_type_t<Arg, Args...> instead of the type of the first argument,
+  so that max_among_common(1, 1.9) is 1.9 where max_among_trunc(1, 1.9) is 1.
+  Usable in constant expressions.
+  
+  Parameters
+  first - the first element.
+  rest... - the rest elements.
+
+  Type requirements
+  std::common_type_t<Arg, Args...> must exist, and every argument must be
+  convertible to it.
+
+  Return value
+  The max element converted to the common type. If several elements are
+  equivalent to the max element, the first one is returned.
+
+  Time Complexity
+  O(n)
+
+  Space Complexity
+  O(n)
+  Note : if all arguments have the same type, n pointers are stored and only
+  the max element is copied. Otherwise, n elements of the common type are
+  constructed; for arithmetic types, the selection is branchless.
+
+  Example
+  assert(max_among_common(1, 1.9, 1u) == 1.9);
+*/
+template <class Arg, class... Args>
+constexpr std::common_type_t<Arg, Args...> max_among_common(
+    const Arg &first, const Args&... rest) {
+  using all_same = std::integral_constant<bool,
+      tlx_all_same<Arg, Args...>()>;
+  using all_arithmetic = std::integral_constant<bool,
+      tlx_and<std::is_arithmetic<Arg>::value,
+              std::is_arithmetic<Args>::value...>()>;
+  return detail_algorithm_trx::max_among_common_impl<
+      std::common_type_t<Arg, Args...> >(
+          std::integral_constant<int,
+              all_same::value ? 2 : all_arithmetic::value ? 1 : 0>(),
+          first, rest...);
+}
+
+//! Sorts the given container in ascending order.
+/*!
+  Sorts the given container in ascending order. Uses operator< to compare the
+  elements. Any container or view with random access iterators is sorted in
+  place (std::vector, std::deque, std::array, std::basic_string, C arrays,
+  std::span, any allocator), the elements satisfying trx::is_radix_sortable
+  (arithmetic types, and the records given a trx::radix_sort_key) by a radix
+  sort. Presorted ones are merged from their ascending and strictly
+  descending runs, so that sorted and reverse sorted containers take a linear
+  time. std::arrays of up to 8 elements, or up to 32 elements satisfying
+  trx::is_cheap_to_compare, are sorted by a sorting network unrolled at
+  compile time, made of branchless compare-exchanges for arithmetic
+  elements, which can be evaluated in constant expressions since C++17.
+  Others are sorted by their sort member function, like std::list and
+  std::forward_list. trx::sorter can be specialized for other containers.
+  Containers of segmented iterators, like std::deque (see
+  trx::segmented_iterator), which are not radix sorted are moved to a
+  contiguous buffer one block after the other, sorted there and moved back,
+  as comparing through pointers is faster.
+  
+  Parameters
+  container - the container, or a view of it.
+
+  Return value
+  (none)
+
+  Time Complexity
+  O(nlogn)
+
+  Space Complexity
+  (unspecified)
+
+  Example
+  std::vector<int> vtr{9,1,3,4,2};
+  sort(vtr);
+*/
+template <class Container>
+TRX_INSTRUMENTED_CONSTEXPR void sort(Container &&container) {
+  std::less<> comp;
+  detail_algorithm_trx::sort_impl(container, comp);
+}
+
+//! Sorts the given container in ascending order.
+/*!
+  Sorts the given container in ascending order. Uses the given comparison
+  function comp to compare the elements. See sort(container) for the
+  supported containers.
+  
+  Parameters
+  container - the container, or a view of it.
+  comp - comparision function object.
+
+  Return value
+  (none)
+
+  Time Complexity
+  O(nlogn)
+
+  Space Complexity
+  (unspecified)
+
+  Example
+  std::vector<int> vtr{9,1,3,4,2};
+  sort(vtr, std::greater<>());
+*/
+template <class Container, class Comp>
+TRX_INSTRUMENTED_CONSTEXPR std::enable_if_t<
+    !is_execution_policy<std::decay_t<Container> >::value, void>
+sort(Container &&container, Comp comp) {
+  detail_algorithm_trx::sort_impl(container, comp);
+}
+
+//! Sorts the given container in ascending order, taking the scratch memory
+//! from the given resource.
+/*!
+  Sorts the given container in ascending order as sort(container) does, but
+  its scratch buffers, those of the radix sort and of the merges of
+  presorted runs, are taken from the resource of the tag. With
+  trx::thread_scratch, or a trx::scratch_arena reused from call to call, the
+  sorts allocate nothing once the arena has grown to their largest size.
+
+  Parameters
+  container - the container, or a view of it.
+  scratch - trx::thread_scratch, or scratch_from(resource).
+
+  Return value
+  (none)
+
+  Time Complexity
+  O(nlogn)
+
+  Space Complexity
+  O(n), taken from the tag's resource.
+
+  Example
+  std::vector<int> vtr{9,1,3,4,2};
+  sort(vtr, trx::thread_scratch);
+*/
+template <class Container>
+inline void sort(Container &&container, scratch_t scratch) {
+  const detail_memory_resource_trx::scratch_scope scope(scratch);
+  std::less<> comp;
+  detail_algorithm_trx::sort_impl(container, comp);
+}
+
+//! Sorts the given container in ascending order, taking the scratch memory
+//! from the given resource.
+/*!
+  Sorts the given container as sort(container, comp) does, taking its
+  scratch buffers from the resource of the tag, see sort(container, scratch).
+
+  Parameters
+  container - the container, or a view of it.
+  comp - comparision function object.
+  scratch - trx::thread_scratch, or scratch_from(resource).
+
+  Return value
+  (none)
+
+  Time Complexity
+  O(nlogn)
+
+  Space Complexity
+  O(n), taken from the tag's resource.
+
+  Example
+  trx::scratch_arena arena;
+  std::vector<int> vtr{9,1,3,4,2};
+  sort(vtr, std::greater<>(), trx::scratch_from(&arena));
+*/
+template <class Container, class Comp>
+inline void sort(Container &&container, Comp comp, scratch_t scratch) {
+  const detail_memory_resource_trx::scratch_scope scope(scratch);
+  detail_algorithm_trx::sort_impl(container, comp);
+}
+
+//! Sorts the given container in ascending order.
+/*!
+  Sorts the given container in ascending order, executed according to
+  policy. Uses operator< to compare the elements. Containers with random
+  access iterators are sorted in parallel by the parallel policies: one chunk
+  per thread is sorted, then the chunks are merged along their merge paths.
+  The other containers, like std::list and std::forward_list, and those
+  customized through trx::sorter are sorted in the calling thread.
+
+  Parameters
+  policy - one of trx::execution::seq, par, par_unseq or
+           trx::execution::on(pool)
+  container - the container, or a view of it.
+
+  Return value
+  (none)
+
+  Time Complexity
+  O(nlogn/p+n*logp), where p is the number of threads.
+
+  Space Complexity
+  O(n) for the parallel policies
+
+  Example
+  std::vector<int> vtr{9,1,3,4,2};
+  sort(trx::execution::par, vtr);
+*/
+template <class ExecutionPolicy, class Container>
+inline std::enable_if_t<
+    is_execution_policy<std::decay_t<ExecutionPolicy> >::value, void>
+sort(ExecutionPolicy &&policy, Container &&container) {
+  std::less<> comp;
+  detail_algorithm_trx::sort_impl(detail_execution_trx::pool_of(policy),
+                                  container, comp);
+}
+
+//! Sorts the given container in ascending order.
+/*!
+  Sorts the given container in ascending order, executed according to
+  policy. Uses the given comparison function comp to compare the elements.
+  See sort(policy, container) for how each container is handled.
+
+  Parameters
+  policy - one of trx::execution::seq, par, par_unseq or
+           trx::execution::on(pool)
+  container - the container, or a view of it.
+  comp - comparision function object, which must be safe to call
+         concurrently.
+
+  Return value
+  (none)
+
+  Time Complexity
+  O(nlogn/p+n*logp), where p is the number of threads.
+
+  Space Complexity
+  O(n) for the parallel policies
+
+  Example
+  trx::thread_pool pool(4);
+  std::vector<int> vtr{9,1,3,4,2};
+  sort(trx::execution::on(pool), vtr, std::greater<>());
+*/
+template <class ExecutionPolicy, class Container, class Comp>
+inline std::enable_if_t<
+    is_execution_policy<std::decay_t<ExecutionPolicy> >::value, void>
+sort(ExecutionPolicy &&policy, Container &&container, Comp comp) {
+  detail_algorithm_trx::sort_impl(detail_execution_trx::pool_of(policy),
+                                  container, comp);
+}
+
+//! Sorts the given container in ascending order, taking the scratch memory
+//! from the given resource.
+/*!
+  Sorts the given container as sort(policy, container, comp) does, taking
+  the scratch buffers of every thread from the resource of the tag. With
+  the parallel policies, the resource must be thread-safe, or
+  trx::thread_scratch, so that each thread allocates from its own arena.
+
+  Parameters
+  policy - one of trx::execution::seq, par, par_unseq or
+           trx::execution::on(pool)
+  container - the container, or a view of it.
+  comp - comparision function object, which must be safe to call
+         concurrently.
+  scratch - trx::thread_scratch, or scratch_from(resource).
+
+  Return value
+  (none)
+
+  Time Complexity
+  O(nlogn/p+n*logp), where p is the number of threads.
+
+  Space Complexity
+  O(n), taken from the tag's resource.
+
+  Example
+  std::vector<int> vtr{9,1,3,4,2};
+  sort(trx::execution::par, vtr, std::less<>(), trx::thread_scratch);
+*/
+template <class ExecutionPolicy, class Container, class Comp>
+inline std::enable_if_t<
+    is_execution_policy<std::decay_t<ExecutionPolicy> >::value, void>
+sort(ExecutionPolicy &&policy, Container &&container, Comp comp,
+     scratch_t scratch) {
+  const detail_memory_resource_trx::scratch_scope scope(scratch);
+  detail_algorithm_trx::sort_impl(detail_execution_trx::pool_of(policy),
+                                  container, comp);
+}
+
+//! Sorts the given list by relinking its nodes gathered in a buffer.
+/*!
+  Sorts the given std::list or std::forward_list in ascending order. Uses
+  operator< to compare the elements. See sort(container, comp, tag).
+
+  Parameters
+  container - the container by non-const lvalue reference.
+  tag - list_gather, or list_gather_with(allocator).
+
+  Return value
+  (none)
+
+  Time Complexity
+  O(nlogn)
+
+  Space Complexity
+  O(n), taken from the tag's allocator.
+
+  Example
+  std::list<int> lst{9,1,3,4,2};
+  sort(lst, trx::list_gather);
+*/
+template <class Container, class Allocator>
+inline void sort(Container &&container, list_gather_t<Allocator> tag) {
+  std::less<> comp;
+  detail_algorithm_trx::sort_impl(container, comp, tag);
+}
+
+//! Sorts the given list by relinking its nodes gathered in a buffer.
+/*!
+  Sorts the given std::list or std::forward_list in ascending order. Uses the
+  given comparison function comp to compare the elements. Instead of the
+  pointer chasing merge sort of the sort member function, handles to the
+  nodes are gathered in a contiguous buffer, which is sorted, then the nodes
+  are relinked in order by splicing, so no element is moved. Small trivially
+  copyable elements are copied next to their handles, so the sort does not
+  touch the nodes at all and arithmetic elements are radix sorted. The sort
+  is not stable. Other containers are sorted as by sort(container, comp).
+
+  Parameters
+  container - the container by non-const lvalue reference.
+  comp - comparision function object.
+  tag - list_gather, or list_gather_with(allocator) to take the buffer from
+        the given allocator.
+
+  Return value
+  (none)
+
+  Time Complexity
+  O(nlogn)
+
+  Space Complexity
+  O(n), taken from the tag's allocator.
+
+  Example
+  std::pmr::monotonic_buffer_resource arena;
+  std::list<int> lst{9,1,3,4,2};
+  sort(lst, std::greater<>(),
+       trx::list_gather_with(std::pmr::polymorphic_allocator<int>(&arena)));
+*/
+template <class Container, class Comp, class Allocator>
+inline void sort(Container &&container, Comp comp,
+                 list_gather_t<Allocator> tag) {
+  detail_algorithm_trx::sort_impl(container, comp, tag);
+}
+
+//! Sorts every container of the given range in ascending order.
+/*!
+  Sorts every container of the given range in ascending order, as
+  sort(container, comp) would, using the given comparison function comp to
+  compare the elements, operator< if none is given. The scratch memory of
+  the sorts is kept by each thread from one container to the next, and the
+  containers of up to 8 elements with random access iterators are sorted by
+  the optimal sorting networks, std::arrays of up to 32 elements by the
+  networks trx::sort uses for them. When the range has random access
+  iterators and its containers hold enough elements in total, they are
+  sorted concurrently on trx::thread_pool::default_pool(), by groups of
+  about the same total size.
+  
+  Parameters
+  containers - the range of containers, e.g. a std::vector<std::vector<T> >.
+  comp - comparision function object.
+
+  Return value
+  (none)
+
+  Time Complexity
+  O(sum of n_i*logn_i)
+
+  Space Complexity
+  (unspecified)
+
+  Example
+  std::vector<std::vector<int> > buckets{{3,1,2},{9,7},{5,4,6,8}};
+  sort_each(buckets);
+*/
+template <class Range, class Comp = std::less<> >
+inline std::enable_if_t<!is_execution_policy<std::decay_t<Range> >::value,
+                        void>
+sort_each(Range &&containers, Comp comp = Comp()) {
+  auto get_pool = [] { return &thread_pool::default_pool(); };
+  detail_algorithm_trx::sort_each_impl(
+      containers, comp, get_pool,
+      detail_algorithm_trx::is_random_access_container<Range>());
+}
+
+//! Sorts every container of the given range in ascending order, taking the
+//! scratch memory from the given resource.
+/*!
+  Sorts every container of the given range as sort_each(containers, comp)
+  does, taking the scratch buffers of every thread from the resource of the
+  tag, which must be thread-safe unless it is trx::thread_scratch.
+
+  Parameters
+  containers - the range of containers, e.g. a std::vector<std::vector<T> >.
+  comp - comparision function object.
+  scratch - trx::thread_scratch, or scratch_from(resource).
+
+  Return value
+  (none)
+
+  Time Complexity
+  O(sum of n_i*logn_i)
+
+  Space Complexity
+  (unspecified), taken from the tag's resource.
+
+  Example
+  std::vector<std::vector<int> > buckets{{3,1,2},{9,7},{5,4,6,8}};
+  sort_each(buckets, std::less<>(), trx::thread_scratch);
+*/
+template <class Range, class Comp>
+inline std::enable_if_t<!is_execution_policy<std::decay_t<Range> >::value,
+                        void>
+sort_each(Range &&containers, Comp comp, scratch_t scratch) {
+  const detail_memory_resource_trx::scratch_scope scope(scratch);
+  auto get_pool = [] { return &thread_pool::default_pool(); };
+  detail_algorithm_trx::sort_each_impl(
+      containers, comp, get_pool,
+      detail_algorithm_trx::is_random_access_container<Range>());
+}
+
+//! Sorts every container of the given range in ascending order.
+/*!
+  Sorts every container of the given range in ascending order as
+  sort_each(containers, comp) does, executed according to policy: the
+  sequenced policy sorts all the containers in the calling thread, the
+  parallel ones on their pools when the containers hold enough elements.
+  
+  Parameters
+  policy - the execution policy to use.
+  containers - the range of containers, e.g. a std::vector<std::vector<T> >.
+  comp - comparision function object.
+
+  Return value
+  (none)
+
+  Time Complexity
+  O(sum of n_i*logn_i)
+
+  Space Complexity
+  (unspecified)
+
+  Example
+  trx::thread_pool pool(4);
+  std::vector<std::vector<int> > buckets{{3,1,2},{9,7},{5,4,6,8}};
+  sort_each(trx::execution::on(pool), buckets, std::greater<>());
+*/
+template <class ExecutionPolicy, class Range, class Comp = std::less<> >
+inline std::enable_if_t<
+    is_execution_policy<std::decay_t<ExecutionPolicy> >::value, void>
+sort_each(ExecutionPolicy &&policy, Range &&containers, Comp comp = Comp()) {
+  auto get_pool = [&policy] {
+    return detail_execution_trx::pool_of(policy);
+  };
+  detail_algorithm_trx::sort_each_impl(
+      containers, comp, get_pool,
+      detail_algorithm_trx::is_random_access_container<Range>());
+}
+
+//! Sorts every container of the given range in ascending order, taking the
+//! scratch memory from the given resource.
+/*!
+  Sorts every container of the given range as
+  sort_each(policy, containers, comp) does, taking the scratch buffers of
+  every thread from the resource of the tag, which must be thread-safe with
+  the parallel policies unless it is trx::thread_scratch.
+
+  Parameters
+  policy - the execution policy to use.
+  containers - the range of containers, e.g. a std::vector<std::vector<T> >.
+  comp - comparision function object.
+  scratch - trx::thread_scratch, or scratch_from(resource).
+
+  Return value
+  (none)
+
+  Time Complexity
+  O(sum of n_i*logn_i)
+
+  Space Complexity
+  (unspecified), taken from the tag's resource.
+
+  Example
+  std::vector<std::vector<int> > buckets{{3,1,2},{9,7},{5,4,6,8}};
+  sort_each(trx::execution::par, buckets, std::less<>(), trx::thread_scratch);
+*/
+template <class ExecutionPolicy, class Range, class Comp>
+inline std::enable_if_t<
+    is_execution_policy<std::decay_t<ExecutionPolicy> >::value, void>
+sort_each(ExecutionPolicy &&policy, Range &&containers, Comp comp,
+          scratch_t scratch) {
+  const detail_memory_resource_trx::scratch_scope scope(scratch);
+  auto get_pool = [&policy] {
+    return detail_execution_trx::pool_of(policy);
+  };
+  detail_algorithm_trx::sort_each_impl(
+      containers, comp, get_pool,
+      detail_algorithm_trx::is_random_access_container<Range>());
+}
+
+//! Sorts the given container in ascending order, keeping the order of
+//! equivalent elements.
+/*!
+  Sorts the given container in ascending order, keeping the order of
+  equivalent elements. Uses the given comparison function comp to compare
+  the elements, operator< if none is given. Containers with random access
+  iterators are sorted in place; when they are presorted, their ascending
+  and strictly descending runs are detected and merged, so that sorted and
+  reverse sorted containers take a linear time. std::list and
+  std::forward_list are sorted by their sort member function. trx::sorter
+  can be specialized with a stable_sort member function for other
+  containers.
+  
+  Parameters
+  container - the container, or a view of it.
+  comp - comparision function object.
+
+  Return value
+  (none)
+
+  Time Complexity
+  O(nlogn), O(n) for sorted and reverse sorted containers
+
+  Space Complexity
+  O(n)
+
+  Example
+  std::vector<std::pair<int, char> > vtr{{2,'a'},{1,'b'},{2,'c'},{1,'d'}};
+  stable_sort(vtr, [](auto &lhs, auto &rhs){ return lhs.first < rhs.first; });
+  // {{1,'b'},{1,'d'},{2,'a'},{2,'c'}}
+*/
+template <class Container, class Comp = std::less<> >
+inline void stable_sort(Container &&container, Comp comp = Comp()) {
+  detail_algorithm_trx::stable_sort_impl(container, comp);
+}
+
+//! Sorts the given container in ascending order, keeping the order of
+//! equivalent elements, taking the scratch memory from the given resource.
+/*!
+  Sorts the given container as stable_sort(container, comp) does, taking
+  its merge buffers from the resource of the tag. The sort itself never
+  allocates, so that with trx::thread_scratch or a reused
+  trx::scratch_arena nothing is allocated once the arena has grown.
+
+  Parameters
+  container - the container, or a view of it.
+  comp - comparision function object.
+  scratch - trx::thread_scratch, or scratch_from(resource).
+
+  Return value
+  (none)
+
+  Time Complexity
+  O(nlogn), O(n) for sorted and reverse sorted containers
+
+  Space Complexity
+  O(n), taken from the tag's resource.
+
+  Example
+  trx::scratch_arena arena;
+  std::vector<std::pair<int, char> > vtr{{2,'a'},{1,'b'},{2,'c'},{1,'d'}};
+  stable_sort(vtr, [](auto &lhs, auto &rhs){ return lhs.first < rhs.first; },
+              trx::scratch_from(&arena));
+*/
+template <class Container, class Comp>
+inline void stable_sort(Container &&container, Comp comp, scratch_t scratch) {
+  const detail_memory_resource_trx::scratch_scope scope(scratch);
+  detail_algorithm_trx::stable_sort_impl(container, comp);
+}
+
+//! Sorts the given container by the keys of its elements.
+/*!
+  Sorts the given container in ascending order of proj(element),
+  using operator< to compare the keys. Each key is computed once: the keys
+  are cached next to the elements, or next to their indices when the elements
+  are not small enough to be copied, then the cache is sorted and the
+  elements are permuted accordingly, by copying their bytes if they satisfy
+  trx::is_trivially_relocatable. Radix sortable keys are radix sorted.
+  Any container with random access iterators is supported, as well as
+  std::list and std::forward_list, which are relinked without moving any
+  element.
+
+  Parameters
+  container - the container, or a view of it.
+  proj - projection function object, called once per element.
+
+  Return value
+  (none)
+
+  Time Complexity
+  O(nlogn) comparisons of the keys, n calls of proj.
+
+  Space Complexity
+  O(n)
+
+  Example
+  std::vector<std::string> names{"bob", "al", "chris"};
+  sort_by(names, [](const std::string &name){ return name.size(); });
+*/
+template <class Container, class Proj>
+inline void sort_by(Container &&container, Proj proj) {
+  std::less<> comp;
+  detail_algorithm_trx::sort_by_impl(container, proj, comp);
+}
+
+//! Sorts the given container by the keys of its elements.
+/*!
+  Sorts the given container by proj(element), using the given
+  comparison function comp to compare the keys. Each key is computed once, see
+  sort_by(container, proj).
+
+  Parameters
+  container - the container, or a view of it.
+  proj - projection function object, called once per element.
+  comp - comparision function object for the keys.
+
+  Return value
+  (none)
+
+  Time Complexity
+  O(nlogn) calls of comp, n calls of proj.
+
+  Space Complexity
+  O(n)
+
+  Example
+  std::vector<std::string> names{"bob", "al", "chris"};
+  sort_by(names, [](const std::string &name){ return name.size(); },
+          std::greater<>());
+*/
+template <class Container, class Proj, class Comp>
+inline void sort_by(Container &&container, Proj proj, Comp comp) {
+  detail_algorithm_trx::sort_by_impl(container, proj, comp);
+}
+
+//! Sorts the given container by the keys of its elements, taking the scratch
+//! memory from the given resource.
+/*!
+  Sorts the given container as sort_by(container, proj, comp) does, taking
+  the cache of the keys and the permutation from the resource of the tag.
+
+  Parameters
+  container - the container, or a view of it.
+  proj - projection function object, called once per element.
+  comp - comparision function object for the keys.
+  scratch - trx::thread_scratch, or scratch_from(resource).
+
+  Return value
+  (none)
+
+  Time Complexity
+  O(nlogn) calls of comp, n calls of proj.
+
+  Space Complexity
+  O(n), taken from the tag's resource.
+
+  Example
+  std::vector<std::string> names{"bob", "al", "chris"};
+  sort_by(names, [](const std::string &name){ return name.size(); },
+          std::less<>(), trx::thread_scratch);
+*/
+template <class Container, class Proj, class Comp>
+inline void sort_by(Container &&container, Proj proj, Comp comp,
+                    scratch_t scratch) {
+  const detail_memory_resource_trx::scratch_scope scope(scratch);
+  detail_algorithm_trx::sort_by_impl(container, proj, comp);
+}
+
+//! Sorts the rows of a table stored as columns by the given key columns.
+/*!
+  Sorts the rows of a table stored as separate columns, the row i being made
+  of the i-th element of each column, in the lexicographic order of the key
+  columns compared with operator<: by the first key, then by the second one
+  among rows of equal first keys, and so on. Rows with equal keys keep their
+  order. The key columns are sorted along with the payload columns.
+  The rows are sorted as positions, without building the rows: each key is
+  radix sorted along with the positions when trx::radix_sort_key is
+  specialized for it, most significant key first and only among the rows
+  whose previous keys are equal, and compared otherwise. Every column is
+  then permuted through a buffer, one column at a time.
+
+  Parameters
+  keys - a std::tuple of references to the key columns, as made by std::tie.
+  payloads - the other columns.
+  Every column is a random access container, or a view of it, of the size
+  of the first key column.
+
+  Type requirements
+  The elements of the key columns must meet the requirements of
+  LessThanComparable, and every element those of MoveConstructible and
+  MoveAssignable.
+
+  Return value
+  (none)
+
+  Time Complexity
+  O(nk) for radix sortable keys, O(nlogn) comparisons of rows otherwise,
+  where k is the total size of the keys in bytes; O(nc) moves, where c is the
+  number of columns.
+
+  Space Complexity
+  O(n) positions, and a buffer of the largest column.
+
+  Example
+  std::vector<int> year{2021, 2020, 2021};
+  std::vector<double> price{3.5, 9.0, 1.25};
+  std::vector<std::string> name{"c", "a", "b"};
+  sort_columns(std::tie(year, price), name);
+  assert((name == std::vector<std::string>{"a", "b", "c"}));
+*/
+template <class... Keys, class... Payloads>
+inline void sort_columns(std::tuple<Keys...> keys, Payloads &&...payloads) {
+  static_assert(sizeof...(Keys) != 0, "sort_columns needs a key column.");
+  static_assert(tlx_and<std::is_lvalue_reference<Keys>::value...>(),
+                "The key columns must be given by reference, as by std::tie.");
+  detail_algorithm_trx::sort_columns_impl(
+      keys, std::index_sequence_for<Keys...>(), payloads...);
+}
+
+//! Returns the positions of the elements of the given container in sorted
+//! order, without moving the elements.
+/*!
+  Returns the permutation perm sorting the given container: its element at
+  perm[0] comes first in ascending order, then its element at perm[1], and
+  so on, equivalent elements being kept in the order of their positions.
+  The container is left untouched, which suits elements too large to be
+  moved around by a sort. Uses the given comparison function comp to compare
+  the elements, operator< if none is given.
+  Radix sortable types ordered by std::less<> or std::greater<> are radix
+  sorted as (key, position) pairs, with 32-bit positions when the container
+  holds fewer than 2^32 elements; equivalent elements, like 0.0 and -0.0,
+  have equal keys, so they keep the order of their positions as well. Other
+  elements are compared through their positions by trx's stable merge sort.
+  Positions are returned as Index, std::size_t by default: std::uint32_t
+  halves the memory of the result for containers of fewer than 2^32
+  elements. Containers which can be traversed by forward iterators,
+  std::list and std::forward_list included, are supported.
+  
+  Parameters
+  container - the container, or a view of it.
+  comp - comparision function object.
+
+  Type requirements
+  Index must be an unsigned integer type able to hold the positions.
+
+  Return value
+  A std::vector of the positions of the elements in the order of comp.
+
+  Time Complexity
+  O(nlogn), O(n) for radix sortable types ordered by std::less<> or
+  std::greater<>
+
+  Space Complexity
+  O(n)
+
+  Example
+  std::vector<std::string> names{"c", "a", "b"};
+  assert(argsort<std::uint32_t>(names) ==
+         std::vector<std::uint32_t>({1, 2, 0}));
+*/
+template <class Index = std::size_t, class Container,
+          class Comp = std::less<> >
+inline std::vector<Index> argsort(const Container &container,
+                                  Comp comp = Comp()) {
+  static_assert(std::is_integral<Index>::value &&
+                std::is_unsigned<Index>::value,
+                "The positions must be of an unsigned integer type.");
+  return detail_algorithm_trx::argsort_impl<Index>(container, comp);
 }
 
-//! sort's helper for std::vector and std::deque
-template <class T, class Allo, template <class, class> class Container>
-inline std::enable_if_t<
-    std::is_same<Container<T, Allo>, std::vector<T, Allo> >::value ||
-    std::is_same<Container<T, Allo>, std::deque<T, Allo> >::value,
-    void> sort_impl(Container<T, Allo> &container) {
-  std::sort(container.begin(), container.end());
-}
+//! Rearranges the given container by the given permutation.
+/*!
+  Rearranges the given container so that its element at position i is the
+  one which was at position perm[i], as returned by argsort: applying
+  argsort(container, comp) sorts the container. Containers with random
+  access iterators are permuted in place by following the cycles of the
+  permutation, so that each element is moved once, plus once per cycle;
+  std::list and std::forward_list are relinked without moving any element.
+  perm itself is left untouched.
+  
+  Parameters
+  container - the container, or a view of it.
+  perm - a permutation of the positions of the container, as a range of
+         integers.
 
-//! sort's helper for std::array
-template <class T, size_t N>
-inline void sort_impl(std::array<T, N> &container) {
-  std::sort(container.begin(), container.end());
-}
+  Return value
+  (none)
 
-//! sort's(comp) helper for std::list and std::forward_list
-template <class T, class Allo, template <class, class> class Container,
-          class Comp>
-inline std::enable_if_t<
-    std::is_same<Container<T, Allo>, std::list<T, Allo> >::value ||
-    std::is_same<Container<T, Allo>, std::forward_list<T, Allo> >::value,
-    void> sort_impl(Container<T, Allo> &container, Comp &comp) {
-  container.sort(comp);
-}
+  Time Complexity
+  O(n)
 
-//! sort's(comp) helper for std::vector and std::deque
-template <class T, class Allo, template <class, class> class Container,
-          class Comp>
-inline std::enable_if_t<
-    std::is_same<Container<T, Allo>, std::vector<T, Allo> >::value ||
-    std::is_same<Container<T, Allo>, std::deque<T, Allo> >::value,
-    void> sort_impl(Container<T, Allo> &container, Comp &comp) {
-  std::sort(container.begin(), container.end(), comp);
-}
+  Space Complexity
+  O(n), for a copy of perm or the nodes of a list.
 
-//! sort's(comp) helper for std::array
-template <class T, size_t N, class Comp>
-inline void sort_impl(std::array<T, N> &container, Comp &comp) {
-  std::sort(container.begin(), container.end(), comp);
+  Example
+  std::vector<std::string> names{"c", "a", "b"};
+  apply_permutation(names, argsort(names));
+  // {"a", "b", "c"}
+*/
+template <class Container, class Indices>
+inline void apply_permutation(Container &&container, const Indices &perm) {
+  detail_algorithm_trx::apply_permutation_dispatch(
+      container, perm, detail_algorithm_trx::priority_tag<1>());
 }
 
-} // namespace detail_algorithm_trx
+//! Sorts the given container in ascending order and removes its duplicates.
+/*!
+  Sorts the given container as sort(container, comp) does and removes the
+  elements equal by eq to their predecessor, as std::unique does, keeping
+  the first of each group of equal elements. Uses operator< and operator==
+  if no comp nor eq is given; eq must hold for elements equivalent by comp.
+  When radix_sort sorts the container, its last pass goes through the
+  scratch buffer for about half of the inputs, and the duplicates are then
+  dropped while the elements are moved back, instead of in a pass of their
+  own. Containers with an erase member function, like std::vector and
+  std::deque, are shrunk to the unique elements; std::list and
+  std::forward_list are sorted and deduplicated by their sort and unique
+  member functions. The other containers, like std::array and views, keep
+  their size: their elements past the returned size are left valid but
+  unspecified.
+  
+  Parameters
+  container - the container, or a view of it.
+  comp - comparision function object.
+  eq - equality function object, compatible with comp.
 
-//! Searches for the best element among those for which predicate returns true.
+  Return value
+  The number of unique elements.
+
+  Time Complexity
+  O(nlogn), O(n) for radix sortable types ordered by std::less<> or
+  std::greater<>
+
+  Space Complexity
+  O(n)
+
+  Example
+  std::vector<int> vtr{3,1,3,2,1};
+  assert(sort_unique(vtr) == 3 && vtr == std::vector<int>({1,2,3}));
+*/
+template <class Container, class Comp = std::less<>,
+          class Eq = std::equal_to<> >
+inline std::size_t sort_unique(Container &&container, Comp comp = Comp(),
+                               Eq eq = Eq()) {
+  return detail_algorithm_trx::sort_unique_impl(container, comp, eq);
+}
+
+//! Removes the duplicates of the given container, keeping the order of the
+//! others.
 /*!
-  Searches for the best element among those for which predicate returns true.
-  If there are more than one best element, then the first one will be returned.
+  Removes the elements of the given container equal by operator== to an
+  earlier one, keeping the first occurrence of each value and the order of
+  the unique elements, without sorting them. The elements seen are looked up
+  in a hash table of pointers to them, hashed by std::hash.
+  Containers with an erase member function are shrunk to the unique
+  elements, whose values are moved to the front; the duplicate nodes of
+  std::list and std::forward_list are erased. The other containers keep
+  their size, as with sort_unique.
   
   Parameters
-  first, last - the range of elements to examine
-  up - unary predicate which returns true for the required sub range
-  bp - binary predicate which returns true if the first argument is better
-       than the second
+  container - the container, or a view of it.
 
   Type requirements
-  ForwardIt must meet the requirements of ForwardIterator
-  UnaryPredicate must meet the requirements of unary predicate
-  BinaryPredicate must meet the requirements of binary predicate
+  The elements must be MoveAssignable, unless the container is a std::list
+  or a std::forward_list.
 
   Return value
-  Iterator to the best element in the sub range of [first, last). If several
-  elements in the range are equivalent to the best element, returns the
-  iterator to the first such element. Returns last if the sub range is empty.
+  The number of unique elements.
 
   Time Complexity
-  O(n), where n = std::distance(first, last).
+  O(n) on average
 
   Space Complexity
-  O(1)
+  O(n)
 
   Example
-  int numbers[] = {1,2,3,4,5,6,7,8,9,10};
-  assert(*best_if(numbers, std::end(numbers),
-                  [](int x){return x%2==1;}, // subranges of all odd numbers
-                  std::greater<int>()) // the biggest
-             == 9);
+  std::vector<int> vtr{3,1,3,2,1};
+  assert(hash_unique(vtr) == 3 && vtr == std::vector<int>({3,1,2}));
 */
-template <class ForwardIt, class UnaryPredicate, class BinaryPredicate>
-ForwardIt best_if(ForwardIt first, ForwardIt last, UnaryPredicate up,
-                  BinaryPredicate bp) {
-  ForwardIt best = last;
-  for (; first!=last; ++first)
-    if (up(*first) && (first==last || bp(*first, *best)))
-      best = first;
-  return best;
+template <class Container>
+inline std::size_t hash_unique(Container &&container) {
+  using value_type = std::decay_t<decltype(*detail_algorithm_trx::adl_begin(
+      container))>;
+  std::hash<value_type> hash;
+  std::equal_to<> eq;
+  return detail_algorithm_trx::hash_unique_dispatch(
+      container, hash, eq, detail_algorithm_trx::priority_tag<1>());
 }
 
-//! Returns the max element among the arguments.
+//! Removes the duplicates of the given container, keeping the order of the
+//! others.
 /*!
-  Returns the max element among the arguments.
-  All arguments must have the same type, while value category can be different.
+  Removes the elements of the given container equal by eq to an earlier one
+  as hash_unique(container) does, hashing them by hash.
   
   Parameters
-  first - the first element.
-  rest... - the rest elements.
+  container - the container, or a view of it.
+  hash - hash function object, giving the same hash to elements equal by eq.
+  eq - equality function object.
 
   Return value
-  The max element, which is returned by value.
+  The number of unique elements.
 
   Time Complexity
-  O(n)
+  O(n) on average
 
   Space Complexity
   O(n)
-  Note : n std::reference_wrappers is constructed, no data is copied.
 
   Example
-  assert(max_among(1, 2, 5, 4, 3) == 5);
+  std::list<int> lst{12,5,22,15,3};
+  auto digit = [](int x){ return x%10; };
+  hash_unique(lst, [&](int x){ return std::hash<int>()(digit(x)); },
+              [&](int x, int y){ return digit(x) == digit(y); });
+  // {12,5,3}
 */
-template <class Arg, class... Args>
-inline Arg max_among(const Arg &first, const Args&... rest) {
-  static_assert(sizeof...(rest)==0 ||
-                    tlx_and<std::is_same<Arg, Args>::value...>(),
-                "All arguments must have the same type.");
-  std::array<std::reference_wrapper<const Arg>, sizeof...(rest)+1> arguments{
-    std::ref(first), std::ref(static_cast<const Arg &>(rest))...};
-  return *std::max_element(arguments.begin(), arguments.end());
+template <class Container, class Hash, class Eq = std::equal_to<> >
+inline std::size_t hash_unique(Container &&container, Hash hash,
+                               Eq eq = Eq()) {
+  return detail_algorithm_trx::hash_unique_dispatch(
+      container, hash, eq, detail_algorithm_trx::priority_tag<1>());
 }
 
-//! Returns the max element among the arguments.
+//! Partially sorts the given container.
 /*!
-  Returns the max element among the arguments.
-  All arguments must can be static_cast to Args, i.e. static_cast<Arg>(rest)
-  must be a valide expression.
+  Rearranges the given container so that its k first elements are the k
+  smallest ones, sorted in ascending order, as std::partial_sort does. The
+  order of the remaining elements is unspecified. Uses the given comparison
+  function comp to compare the elements, operator< if none is given.
+  The k elements are selected by a bounded heap when k is small compared to
+  the size n of the container, and by introselect otherwise. std::list and
+  std::forward_list are rearranged by relinking their nodes, without sorting
+  the whole list. Other containers with a sort member function are sorted
+  entirely. trx::sorter can be specialized for other containers.
   
   Parameters
-  first - the first element.
-  rest... - the rest elements.
+  container - the container, or a view of it.
+  k - the number of elements to sort. All elements are sorted if k >= n.
+  comp - comparision function object.
 
   Return value
-  The max element, which is returned by value(cast to the type of the first
-  element).
+  (none)
 
   Time Complexity
-  O(n)
+  O(nlogk) for small k, O(n+klogk) otherwise
 
   Space Complexity
-  O(n)
-  Note : n std::reference_wrappers is constructed, no data is copied.
+  O(1) for random access containers, O(k) for small k and O(n) otherwise for
+  lists.
 
   Example
-  assert(max_among_trunc(1, 2, 5.0, 4.3, 3) == 5);
+  std::list<int> lst{9,1,3,4,2};
+  partial_sort(lst, 2);
+  assert(lst.front() == 1 && *std::next(lst.begin()) == 2);
 */
-template <class Arg, class... Args>
-inline Arg max_among_trunc(const Arg &first, const Args&... rest) {
-  return max_among(first, static_cast<Arg>(rest)...);
+template <class Container, class Comp = std::less<> >
+inline void partial_sort(Container &&container, std::size_t k,
+                         Comp comp = Comp()) {
+  detail_algorithm_trx::partial_sort_dispatch(
+      container, k, comp, detail_algorithm_trx::priority_tag<4>());
+}
+
+//! Partially sorts the given container, taking the scratch memory from the
+//! given resource.
+/*!
+  Rearranges the given container as partial_sort(container, k, comp) does,
+  taking its scratch buffers, like the selected nodes of the lists, from the
+  resource of the tag.
+
+  Parameters
+  container - the container, or a view of it.
+  k - the number of elements to sort.
+  comp - comparision function object.
+  scratch - trx::thread_scratch, or scratch_from(resource).
+
+  Return value
+  (none)
+
+  Time Complexity
+  O(nlogk) for small k, O(n+klogk) otherwise
+
+  Space Complexity
+  O(k) for small k and O(n) otherwise for lists, taken from the tag's
+  resource.
+
+  Example
+  std::list<int> lst{9,1,3,4,2};
+  partial_sort(lst, 2, std::less<>(), trx::thread_scratch);
+*/
+template <class Container, class Comp>
+inline void partial_sort(Container &&container, std::size_t k, Comp comp,
+                         scratch_t scratch) {
+  const detail_memory_resource_trx::scratch_scope scope(scratch);
+  detail_algorithm_trx::partial_sort_dispatch(
+      container, k, comp, detail_algorithm_trx::priority_tag<4>());
 }
 
-//! Sorts the given standard container in ascending order.
+//! Partially sorts the given container around its nth element.
 /*!
-  Sorts the given standard container in ascending order. Uses operator< to
-  compare the elements.
+  Rearranges the given container as std::nth_element does: the element at
+  position n is the one which would be there if the container was sorted,
+  no element before it is greater and no element after it is less. Uses the
+  given comparison function comp to compare the elements, operator< if none
+  is given. The elements are selected by introselect; std::list and
+  std::forward_list are rearranged by relinking their nodes. Other containers
+  with a sort member function are sorted entirely. trx::sorter can be
+  specialized for other containers.
   
   Parameters
-  container - the container by non-const lvalue reference.
+  container - the container, or a view of it.
+  n - the position of the element to put in place. Nothing is done if n is
+      not less than the size of the container.
+  comp - comparision function object.
 
   Return value
   (none)
 
   Time Complexity
-  O(nlogn)
+  O(n) on average
 
   Space Complexity
-  (unspecified)
+  O(1) for random access containers, O(n) for lists.
 
   Example
   std::vector<int> vtr{9,1,3,4,2};
-  sort(vtr);
+  nth_element(vtr, 2);
+  assert(vtr[2] == 3);
 */
-template <class Container>
-inline void sort(Container &container) {
-  detail_algorithm_trx::sort_impl(container);
+template <class Container, class Comp = std::less<> >
+inline void nth_element(Container &&container, std::size_t n,
+                        Comp comp = Comp()) {
+  detail_algorithm_trx::nth_element_dispatch(
+      container, n, comp, detail_algorithm_trx::priority_tag<4>());
 }
 
-//! Sorts the given standard container in ascending order.
+//! Partially sorts the given container around its nth element, taking the
+//! scratch memory from the given resource.
 /*!
-  Sorts the given standard container in ascending order. Uses the given
-  comparison function comp to compare the elements.
-  
+  Rearranges the given container as nth_element(container, n, comp) does,
+  taking the handles to the nodes of the lists from the resource of the
+  tag.
+
   Parameters
-  container - the container by non-const lvalue reference.
+  container - the container, or a view of it.
+  n - the position of the element to place.
   comp - comparision function object.
+  scratch - trx::thread_scratch, or scratch_from(resource).
 
   Return value
   (none)
 
   Time Complexity
-  O(nlogn)
+  O(n) on average
 
   Space Complexity
-  (unspecified)
+  O(1) for random access containers, O(n) for lists, taken from the tag's
+  resource.
+
+  Example
+  std::list<int> lst{9,1,3,4,2};
+  nth_element(lst, 2, std::less<>(), trx::thread_scratch);
+*/
+template <class Container, class Comp>
+inline void nth_element(Container &&container, std::size_t n, Comp comp,
+                        scratch_t scratch) {
+  const detail_memory_resource_trx::scratch_scope scope(scratch);
+  detail_algorithm_trx::nth_element_dispatch(
+      container, n, comp, detail_algorithm_trx::priority_tag<4>());
+}
+
+//! Returns copies of the k greatest elements of the given container.
+/*!
+  Returns copies of the k first elements of the given container in the order
+  defined by the comparison function comp, sorted: the k greatest elements in
+  descending order by default, the k smallest ones with std::less<>. The
+  container is left untouched and only needs to be traversable by forward
+  iterators, so that std::list and std::forward_list are read in a single
+  pass. For small k, only the k best elements seen so far are kept in a
+  bounded heap; otherwise the elements are copied and partitioned by
+  introselect.
+  
+  Parameters
+  container - the container, or a view of it.
+  k - the number of elements to return. All elements are returned if k is
+      greater than the size n of the container.
+  comp - comparision function object.
+
+  Type requirements
+  The elements must be CopyConstructible and CopyAssignable.
+
+  Return value
+  A std::vector holding the k first elements in the order of comp.
+
+  Time Complexity
+  O(nlogk) for small k, O(n+klogk) otherwise
+
+  Space Complexity
+  O(k) for small k, O(n) otherwise
+
+  Example
+  std::list<int> lst{9,1,3,4,2};
+  assert(top_k(lst, 2) == std::vector<int>({9,4}));
+  assert(top_k(lst, 2, std::less<>()) == std::vector<int>({1,2}));
+*/
+template <class Container, class Comp = std::greater<> >
+inline auto top_k(const Container &container, std::size_t k,
+                  Comp comp = Comp()) {
+  return detail_algorithm_trx::top_k_impl(container, k, comp);
+}
+
+//! Returns the k best elements of the given container, taking the scratch
+//! memory from the given resource.
+/*!
+  Returns the k first elements of the given container in the order of comp
+  as top_k(container, k, comp) does. The returned std::vector is allocated
+  as usual; the scratch buffers of the selection are taken from the
+  resource of the tag.
+
+  Parameters
+  container - the container, or a view of it.
+  k - the number of elements to return.
+  comp - comparision function object.
+  scratch - trx::thread_scratch, or scratch_from(resource).
+
+  Return value
+  A std::vector holding the k first elements in the order of comp.
+
+  Time Complexity
+  O(nlogk) for small k, O(n+klogk) otherwise
+
+  Space Complexity
+  O(k) for small k, O(n) otherwise
 
   Example
   std::vector<int> vtr{9,1,3,4,2};
-  sort(vtr, std::greater<>());
+  assert(top_k(vtr, 2, std::greater<>(), trx::thread_scratch) ==
+         std::vector<int>({9,4}));
 */
 template <class Container, class Comp>
-inline void sort(Container &container, Comp comp) {
-  detail_algorithm_trx::sort_impl(container, comp);
+inline auto top_k(const Container &container, std::size_t k, Comp comp,
+                  scratch_t scratch) {
+  const detail_memory_resource_trx::scratch_scope scope(scratch);
+  return detail_algorithm_trx::top_k_impl(container, k, comp);
+}
+
+//! Merges two sorted containers into out.
+/*!
+  Merges the sorted containers a and b into the range beginning at out, as
+  std::merge does: the result is sorted by comp, and of equivalent elements
+  those of a come first, in their order. When one container is at least 64
+  times longer than the other and both are random access, the elements of
+  the longer one between two elements of the shorter one are found by an
+  exponential search and copied at once.
+
+  Parameters
+  a, b - the sorted containers, or views of them.
+  out - the beginning of the destination range.
+  comp - comparision function object, by which a and b are sorted.
+
+  Return value
+  An output iterator past the last element written.
+
+  Time Complexity
+  O(n) copies, O(n) comparisons, or O(mlog(n/m)) when galloping, where m and
+  n are the sizes of the shorter and the longer container.
+
+  Space Complexity
+  O(1)
+
+  Example
+  std::vector<int> a{1,4,9}, b{2,3,10}, merged;
+  merge(a, b, std::back_inserter(merged));
+  assert((merged == std::vector<int>{1,2,3,4,9,10}));
+*/
+template <class Container1, class Container2, class OutputIt,
+          class Comp = std::less<> >
+inline std::enable_if_t<
+    !is_execution_policy<std::decay_t<Container1> >::value, OutputIt>
+merge(const Container1 &a, const Container2 &b, OutputIt out,
+      Comp comp = Comp()) {
+  return detail_algorithm_trx::merge_range(
+      detail_algorithm_trx::adl_begin(a), detail_algorithm_trx::adl_end(a),
+      detail_algorithm_trx::adl_begin(b), detail_algorithm_trx::adl_end(b),
+      out, comp);
+}
+
+//! Merges two sorted containers into out, using the given execution policy.
+/*!
+  Merges a and b into out as merge(a, b, out, comp) does. With a parallel
+  policy and random access containers, the merged sequence is cut into one
+  part per thread of the pool by binary searches, and the parts are merged
+  concurrently: straight into out if it is a random access iterator,
+  through buffers otherwise.
+
+  Parameters
+  policy - trx::execution::seq, par, par_unseq, or on(pool).
+  a, b - the sorted containers, or views of them.
+  out - the beginning of the destination range.
+  comp - comparision function object, safe to call concurrently.
+
+  Return value
+  An output iterator past the last element written.
+
+  Time Complexity
+  O(n/p+plogn), where n is the total size and p the number of threads.
+
+  Space Complexity
+  O(p), O(n) if out is not random access.
+
+  Example
+  std::vector<int> a(1000000), b(1000000), merged(2000000);
+  std::iota(a.begin(), a.end(), 0);
+  std::iota(b.begin(), b.end(), 500000);
+  merge(trx::execution::par, a, b, merged.begin());
+  assert(std::is_sorted(merged.begin(), merged.end()));
+*/
+template <class ExecutionPolicy, class Container1, class Container2,
+          class OutputIt, class Comp = std::less<> >
+inline std::enable_if_t<
+    is_execution_policy<std::decay_t<ExecutionPolicy> >::value, OutputIt>
+merge(ExecutionPolicy &&policy, const Container1 &a, const Container2 &b,
+      OutputIt out, Comp comp = Comp()) {
+  using detail_algorithm_trx::adl_begin;
+  using detail_algorithm_trx::adl_end;
+  return detail_algorithm_trx::merge_on(
+      detail_execution_trx::pool_of(policy), adl_begin(a), adl_end(a),
+      adl_begin(b), adl_end(b), out, comp,
+      detail_algorithm_trx::can_gallop<decltype(adl_begin(a)),
+                                       decltype(adl_begin(b))>());
+}
+
+//! Merges k sorted containers into out.
+/*!
+  Merges the sorted containers of the given range into the range beginning
+  at out: the result is sorted by comp, and of equivalent elements those of
+  an earlier container come first. The containers are merged by a loser
+  tree, so that each element costs logk comparisons.
+
+  Parameters
+  containers - a range of sorted containers, or of views of them.
+  out - the beginning of the destination range.
+  comp - comparision function object, by which the containers are sorted.
+
+  Return value
+  An output iterator past the last element written.
+
+  Time Complexity
+  O(nlogk) comparisons, where n is the total size and k the number of
+  containers.
+
+  Space Complexity
+  O(k)
+
+  Example
+  std::vector<std::vector<int> > lists{{1,5,9}, {2,6}, {0,7,8}};
+  std::vector<int> merged;
+  merge_k(lists, std::back_inserter(merged));
+  assert((merged == std::vector<int>{0,1,2,5,6,7,8,9}));
+*/
+template <class Range, class OutputIt, class Comp = std::less<> >
+inline OutputIt merge_k(const Range &containers, OutputIt out,
+                        Comp comp = Comp()) {
+  return detail_algorithm_trx::merge_k_impl(containers, out, comp);
+}
+
+//! Writes the elements of two sorted containers found in both into out.
+/*!
+  Writes the elements of the sorted container a which are also found in the
+  sorted container b into the range beginning at out, as
+  std::set_intersection does: an element found m times in a and n times in
+  b is written min(m, n) times, taken from a. When one container is at
+  least 64 times longer than the other and both are random access, each
+  element of the shorter one is looked for by an exponential search in the
+  longer one. Contiguous containers of the same integer type sorted by
+  std::less, neither 10 times longer than the other, are intersected by the
+  SIMD kernels when both are strictly increasing, which takes one more pass
+  over them to check.
+
+  Parameters
+  a, b - the sorted containers, or views of them.
+  out - the beginning of the destination range.
+  comp - comparision function object, by which a and b are sorted.
+
+  Return value
+  An output iterator past the last element written.
+
+  Time Complexity
+  O(m+n) comparisons, or O(mlog(n/m)) when galloping, where m and n are
+  the sizes of the shorter and the longer container.
+
+  Space Complexity
+  O(1), O(m) when intersected by the SIMD kernels.
+
+  Example
+  std::vector<int> a{1,3,4,8,9}, b{2,3,8,10}, common;
+  set_intersection(a, b, std::back_inserter(common));
+  assert((common == std::vector<int>{3,8}));
+*/
+template <class Container1, class Container2, class OutputIt,
+          class Comp = std::less<> >
+inline std::enable_if_t<
+    !is_execution_policy<std::decay_t<Container1> >::value, OutputIt>
+set_intersection(const Container1 &a, const Container2 &b, OutputIt out,
+                 Comp comp = Comp()) {
+  return detail_algorithm_trx::intersect_range(
+      detail_algorithm_trx::adl_begin(a), detail_algorithm_trx::adl_end(a),
+      detail_algorithm_trx::adl_begin(b), detail_algorithm_trx::adl_end(b),
+      out, comp);
+}
+
+//! Writes the elements of two sorted containers found in both into out,
+//! using the given execution policy.
+/*!
+  Writes the intersection of a and b into out as
+  set_intersection(a, b, out, comp) does. With a parallel policy and random
+  access containers, both are cut into one part per thread of the pool at
+  the same values, equivalent elements falling into the same part, and the
+  parts are intersected concurrently into buffers moved into out in order.
+
+  Parameters
+  policy - trx::execution::seq, par, par_unseq, or on(pool).
+  a, b - the sorted containers, or views of them.
+  out - the beginning of the destination range.
+  comp - comparision function object, safe to call concurrently.
+
+  Return value
+  An output iterator past the last element written.
+
+  Time Complexity
+  O((m+n)/p+plog(m+n)), where p is the number of threads.
+
+  Space Complexity
+  O(m), where m is the size of the shorter container.
+
+  Example
+  std::vector<int> a(1000000), b(1000000), common;
+  std::iota(a.begin(), a.end(), 0);
+  std::iota(b.begin(), b.end(), 500000);
+  set_intersection(trx::execution::par, a, b, std::back_inserter(common));
+  assert(common.size() == 500000);
+*/
+template <class ExecutionPolicy, class Container1, class Container2,
+          class OutputIt, class Comp = std::less<> >
+inline std::enable_if_t<
+    is_execution_policy<std::decay_t<ExecutionPolicy> >::value, OutputIt>
+set_intersection(ExecutionPolicy &&policy, const Container1 &a,
+                 const Container2 &b, OutputIt out, Comp comp = Comp()) {
+  using detail_algorithm_trx::adl_begin;
+  using detail_algorithm_trx::adl_end;
+  return detail_algorithm_trx::intersect_on(
+      detail_execution_trx::pool_of(policy), adl_begin(a), adl_end(a),
+      adl_begin(b), adl_end(b), out, comp,
+      detail_algorithm_trx::can_gallop<decltype(adl_begin(a)),
+                                       decltype(adl_begin(b))>());
+}
+
+//! Writes the elements found in either of two sorted containers into out.
+/*!
+  Writes the elements found in the sorted container a or in the sorted
+  container b into the range beginning at out, as std::set_union does: an
+  element found m times in a and n times in b is written max(m, n) times,
+  the first m of them taken from a. When one container is at least 64 times
+  longer than the other and both are random access, the elements of the
+  longer one between two elements of the shorter one are found by an
+  exponential search and copied at once.
+
+  Parameters
+  a, b - the sorted containers, or views of them.
+  out - the beginning of the destination range.
+  comp - comparision function object, by which a and b are sorted.
+
+  Return value
+  An output iterator past the last element written.
+
+  Time Complexity
+  O(m+n) comparisons, or O(mlog(n/m)) when galloping, where m and n are
+  the sizes of the shorter and the longer container.
+
+  Space Complexity
+  O(1)
+
+  Example
+  std::vector<int> a{1,3,8}, b{2,3,10}, all;
+  set_union(a, b, std::back_inserter(all));
+  assert((all == std::vector<int>{1,2,3,8,10}));
+*/
+template <class Container1, class Container2, class OutputIt,
+          class Comp = std::less<> >
+inline std::enable_if_t<
+    !is_execution_policy<std::decay_t<Container1> >::value, OutputIt>
+set_union(const Container1 &a, const Container2 &b, OutputIt out,
+          Comp comp = Comp()) {
+  return detail_algorithm_trx::unite_range(
+      detail_algorithm_trx::adl_begin(a), detail_algorithm_trx::adl_end(a),
+      detail_algorithm_trx::adl_begin(b), detail_algorithm_trx::adl_end(b),
+      out, comp);
+}
+
+//! Writes the elements found in either of two sorted containers into out,
+//! using the given execution policy.
+/*!
+  Writes the union of a and b into out as set_union(a, b, out, comp) does.
+  With a parallel policy and random access containers, both are cut into
+  one part per thread of the pool at the same values, equivalent elements
+  falling into the same part, and the parts are united concurrently into
+  buffers moved into out in order.
+
+  Parameters
+  policy - trx::execution::seq, par, par_unseq, or on(pool).
+  a, b - the sorted containers, or views of them.
+  out - the beginning of the destination range.
+  comp - comparision function object, safe to call concurrently.
+
+  Return value
+  An output iterator past the last element written.
+
+  Time Complexity
+  O((m+n)/p+plog(m+n)), where p is the number of threads.
+
+  Space Complexity
+  O(m+n)
+
+  Example
+  std::vector<int> a(1000000), b(1000000), all;
+  std::iota(a.begin(), a.end(), 0);
+  std::iota(b.begin(), b.end(), 500000);
+  set_union(trx::execution::par, a, b, std::back_inserter(all));
+  assert(all.size() == 1500000);
+*/
+template <class ExecutionPolicy, class Container1, class Container2,
+          class OutputIt, class Comp = std::less<> >
+inline std::enable_if_t<
+    is_execution_policy<std::decay_t<ExecutionPolicy> >::value, OutputIt>
+set_union(ExecutionPolicy &&policy, const Container1 &a, const Container2 &b,
+          OutputIt out, Comp comp = Comp()) {
+  using detail_algorithm_trx::adl_begin;
+  using detail_algorithm_trx::adl_end;
+  return detail_algorithm_trx::unite_on(
+      detail_execution_trx::pool_of(policy), adl_begin(a), adl_end(a),
+      adl_begin(b), adl_end(b), out, comp,
+      detail_algorithm_trx::can_gallop<decltype(adl_begin(a)),
+                                       decltype(adl_begin(b))>());
 }
 
 } // namespace trx
@@ -0,0 +1,702 @@
+#ifndef _STL_EXTENSION_TRX_ASYNC_H_
+#define _STL_EXTENSION_TRX_ASYNC_H_
+
+#if !defined(__cpp_impl_coroutine)
+#error "trx/felix/async.h requires C++20 coroutines."
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "algorithm.h"
+#include "execution.h"
+#include "memory_resource.h"
+
+namespace trx {
+//! A lazily started coroutine returning a T, awaited once.
+/*!
+  A lazily started coroutine returning a T, the result of trx's awaitable
+  algorithms. Nothing runs until the task is awaited; the awaiting coroutine
+  is then resumed when the task returns, in the thread which ran its last
+  step. An exception thrown by the task is rethrown by co_await.
+
+  Example
+  trx::task<void> refresh(std::vector<int> &vtr, loop_executor executor) {
+    co_await trx::async_sort(vtr, executor);
+  }
+*/
+template <class T = void>
+class task;
+
+//! Helper function/class templates for the current header.
+namespace detail_async_trx {
+//! The state of a task shared by both kinds of results.
+struct promise_base {
+  //! Resumes the awaiting coroutine when the task returns.
+  struct final_awaiter {
+    bool await_ready() const noexcept { return false; }
+
+    template <class Promise>
+    std::coroutine_handle<> await_suspend(
+        std::coroutine_handle<Promise> handle) const noexcept {
+      const std::coroutine_handle<> continuation =
+          handle.promise().continuation;
+      return continuation ? continuation : std::noop_coroutine();
+    }
+
+    void await_resume() const noexcept {}
+  };
+
+  std::suspend_always initial_suspend() const noexcept { return {}; }
+  final_awaiter final_suspend() const noexcept { return {}; }
+
+  void unhandled_exception() noexcept { error = std::current_exception(); }
+
+  void rethrow_if_failed() const {
+    if (error)
+      std::rethrow_exception(error);
+  }
+
+  std::coroutine_handle<> continuation;
+  std::exception_ptr error;
+};
+
+template <class T>
+struct promise : promise_base {
+  task<T> get_return_object() noexcept;
+
+  template <class U>
+  void return_value(U &&value) {
+    result.emplace(std::forward<U>(value));
+  }
+
+  T take() {
+    rethrow_if_failed();
+    return std::move(*result);
+  }
+
+  std::optional<T> result;
+};
+
+template <>
+struct promise<void> : promise_base {
+  task<void> get_return_object() noexcept;
+
+  void return_void() const noexcept {}
+
+  void take() const { rethrow_if_failed(); }
+};
+
+} // namespace detail_async_trx
+
+template <class T>
+class task {
+public:
+  using promise_type = detail_async_trx::promise<T>;
+
+  task(task &&other) noexcept
+      : handle_(std::exchange(other.handle_, nullptr)) {}
+
+  task &operator=(task other) noexcept {
+    std::swap(handle_, other.handle_);
+    return *this;
+  }
+
+  ~task() {
+    if (handle_)
+      handle_.destroy();
+  }
+
+  bool await_ready() const noexcept { return false; }
+
+  //! Starts the task, which resumes continuation when it returns.
+  std::coroutine_handle<> await_suspend(
+      std::coroutine_handle<> continuation) noexcept {
+    handle_.promise().continuation = continuation;
+    return handle_;
+  }
+
+  T await_resume() { return handle_.promise().take(); }
+
+private:
+  friend promise_type;
+
+  explicit task(std::coroutine_handle<promise_type> handle) noexcept
+      : handle_(handle) {}
+
+  std::coroutine_handle<promise_type> handle_;
+};
+
+namespace detail_async_trx {
+template <class T>
+inline task<T> promise<T>::get_return_object() noexcept {
+  return task<T>(std::coroutine_handle<promise<T> >::from_promise(*this));
+}
+
+inline task<void> promise<void>::get_return_object() noexcept {
+  return task<void>(
+      std::coroutine_handle<promise<void> >::from_promise(*this));
+}
+
+using detail_algorithm_trx::priority_tag;
+
+//! Hands fn to the executor through its post member function, or through
+//! its execute member function.
+template <class Executor, class Fn>
+inline auto post(Executor &executor, Fn &&fn, priority_tag<1>)
+    -> decltype(executor.post(std::forward<Fn>(fn)), void()) {
+  executor.post(std::forward<Fn>(fn));
+}
+
+template <class Executor, class Fn>
+inline auto post(Executor &executor, Fn &&fn, priority_tag<0>)
+    -> decltype(executor.execute(std::forward<Fn>(fn)), void()) {
+  executor.execute(std::forward<Fn>(fn));
+}
+
+//! Checks whether Executor can be handed a std::function<void()> by post.
+template <class Executor, class Enable = void>
+struct is_executor : std::false_type {};
+
+template <class Executor>
+struct is_executor<Executor, std::conditional_t<true, void,
+    decltype(post(std::declval<Executor &>(),
+                  std::declval<std::function<void()> >(),
+                  priority_tag<1>()))> > : std::true_type {};
+
+//! Steps of this many elements are the unit of work of the awaitable
+//! algorithms: a sort step sorts or merges that many elements, a search
+//! step reads eight times as many.
+constexpr std::size_t step_size = std::size_t(1) << 14;
+
+//! Cuts a coroutine into time slices: expired() tells when the current one
+//! is over, and co_await yield() suspends the coroutine until the executor
+//! resumes it with a new one.
+template <class Executor>
+class slicer {
+public:
+  slicer(Executor &executor, std::chrono::nanoseconds slice)
+      : executor_(executor), slice_(slice),
+        deadline_(clock::now()+slice) {}
+
+  bool expired() const { return clock::now() >= deadline_; }
+
+  struct yield_awaiter {
+    bool await_ready() const noexcept { return false; }
+
+    void await_suspend(std::coroutine_handle<> handle) const {
+      post(owner.executor_, [handle]{ handle.resume(); }, priority_tag<1>());
+    }
+
+    void await_resume() const { owner.deadline_ = clock::now()+owner.slice_; }
+
+    slicer &owner;
+  };
+
+  yield_awaiter yield() noexcept { return {*this}; }
+
+private:
+  using clock = std::chrono::steady_clock;
+
+  Executor &executor_;
+  std::chrono::nanoseconds slice_;
+  clock::time_point deadline_;
+};
+
+//! Calls fn(k) for every k in [0, count), on the pool when there is one.
+//! The pool's threads take the scratch setting of the caller.
+template <class Fn>
+void run_steps(thread_pool *pool, std::size_t count, Fn &&fn) {
+  if (!pool || count == 1) {
+    for (std::size_t k = 0; k != count; ++k)
+      fn(k);
+    return;
+  }
+  const detail_algorithm_trx::scratch_setting setting =
+      detail_algorithm_trx::current_scratch_setting();
+  pool->run(count, [&](std::size_t k) {
+    const detail_algorithm_trx::scratch_scope scope(setting);
+    fn(k);
+  });
+}
+
+//! Sorts [first, last) by sort_range, one step of step_size elements per
+//! thread at a time, yielding to the executor between time slices: the
+//! steps are sorted, then merged pairwise through a scratch buffer, each
+//! merge being cut into steps along its merge path as parallel_sort does.
+template <class RandomIt, class Comp, class Executor>
+task<void> sort_steps(RandomIt first, RandomIt last, Comp comp,
+                      Executor executor, thread_pool *pool,
+                      std::chrono::nanoseconds slice) {
+  using namespace detail_algorithm_trx;
+  using value_type = typename std::iterator_traits<RandomIt>::value_type;
+  slicer<Executor> slices(executor, slice);
+  const std::size_t n = std::distance(first, last);
+  const std::size_t lanes = pool ? pool->size() : 1;
+  const std::size_t runs = (n+step_size-1)/step_size;
+  for (std::size_t k = 0; k < runs; k += lanes) {
+    if (slices.expired())
+      co_await slices.yield();
+    run_steps(pool, std::min(lanes, runs-k), [&](std::size_t i) {
+      auto &&counting_comp = counted(comp);
+      const std::size_t lo = (k+i)*step_size;
+      sort_random_access(first+lo, first+std::min(n, lo+step_size),
+                         counting_comp, is_segmented_iterator<RandomIt>());
+    });
+  }
+  bool presorted = true;
+  for (std::size_t k = 1; k < runs && presorted; ++k)
+    presorted = !comp(first[k*step_size], first[k*step_size-1]);
+  if (presorted)
+    co_return;
+  scratch_vector<value_type> buffer;
+  buffer.reserve(n);
+  for (std::size_t lo = 0; lo < n; lo += step_size) {
+    if (slices.expired())
+      co_await slices.yield();
+    buffer.insert(buffer.end(), std::make_move_iterator(first+lo),
+                  std::make_move_iterator(first+std::min(n, lo+step_size)));
+    count_moves(std::min(n, lo+step_size)-lo);
+  }
+  bool in_buffer = true;
+  for (std::size_t w = step_size; w < n; w *= 2, in_buffer = !in_buffer) {
+    const scratch_vector<merge_piece> pieces = merge_pieces(n, w, step_size);
+    for (std::size_t k = 0; k < pieces.size(); k += lanes) {
+      if (slices.expired())
+        co_await slices.yield();
+      run_steps(pool, std::min(lanes, pieces.size()-k), [&](std::size_t i) {
+        auto &&counting_comp = counted(comp);
+        if (in_buffer)
+          merge_piece_to(buffer.begin(), first, pieces[k+i], counting_comp);
+        else
+          merge_piece_to(first, buffer.begin(), pieces[k+i], counting_comp);
+      });
+    }
+  }
+  if (!in_buffer)
+    co_return;
+  for (std::size_t lo = 0; lo < n; lo += step_size) {
+    if (slices.expired())
+      co_await slices.yield();
+    std::move(buffer.begin()+lo, buffer.begin()+std::min(n, lo+step_size),
+              first+lo);
+    count_moves(std::min(n, lo+step_size)-lo);
+  }
+}
+
+//! Sorts the container by sort_impl in a single step, for the containers
+//! which cannot be cut into steps.
+template <class Container, class Comp>
+task<void> sort_whole(Container &container, Comp comp, thread_pool *pool) {
+  detail_algorithm_trx::sort_impl(pool, container, comp);
+  co_return;
+}
+
+//! async_sort's helper for containers whose trx::sorter is specialized
+template <class Container, class Comp, class Executor>
+inline auto async_sort_dispatch(Container &container, Comp &comp,
+                                Executor &, thread_pool *pool,
+                                std::chrono::nanoseconds, priority_tag<3>)
+    -> decltype(sorter<Container>::sort(container, comp), task<void>()) {
+  return sort_whole(container, comp, pool);
+}
+
+//! async_sort's helper for contiguous containers, sorted through pointers
+template <class Container, class Comp, class Executor>
+inline std::enable_if_t<
+    is_contiguous_container<Container>::value,
+    task<void> >
+async_sort_dispatch(Container &container, Comp &comp, Executor &executor,
+                    thread_pool *pool, std::chrono::nanoseconds slice,
+                    priority_tag<2>) {
+  using detail_algorithm_trx::adl_begin;
+  using detail_algorithm_trx::adl_end;
+  const std::size_t n = std::distance(adl_begin(container),
+                                      adl_end(container));
+  if (n <= step_size)
+    return sort_whole(container, comp, pool);
+  const auto first = detail_algorithm_trx::contiguous_data(container);
+  return sort_steps(first, first+n, comp, executor, pool, slice);
+}
+
+//! async_sort's helper for the other random access containers
+template <class Container, class Comp, class Executor>
+inline std::enable_if_t<
+    detail_algorithm_trx::is_random_access_container<Container>::value &&
+    !is_contiguous_container<Container>::value,
+    task<void> >
+async_sort_dispatch(Container &container, Comp &comp, Executor &executor,
+                    thread_pool *pool, std::chrono::nanoseconds slice,
+                    priority_tag<2>) {
+  using detail_algorithm_trx::adl_begin;
+  using detail_algorithm_trx::adl_end;
+  if (static_cast<std::size_t>(std::distance(adl_begin(container),
+                                             adl_end(container))) <=
+      step_size)
+    return sort_whole(container, comp, pool);
+  return sort_steps(adl_begin(container), adl_end(container), comp, executor,
+                    pool, slice);
+}
+
+//! async_sort's helper for the other containers, like std::list
+template <class Container, class Comp, class Executor>
+inline task<void> async_sort_dispatch(Container &container, Comp &comp,
+                                      Executor &, thread_pool *pool,
+                                      std::chrono::nanoseconds,
+                                      priority_tag<1>) {
+  return sort_whole(container, comp, pool);
+}
+
+//! Searches [first, last) as best_if does, one step at a time per thread,
+//! yielding to the executor between time slices. The best elements of the
+//! steps are combined from left to right.
+template <class ForwardIt, class UnaryPredicate, class BinaryPredicate,
+          class Executor>
+task<ForwardIt> best_if_steps(ForwardIt first, ForwardIt last,
+                              UnaryPredicate up, BinaryPredicate bp,
+                              Executor executor, thread_pool *pool,
+                              std::chrono::nanoseconds slice) {
+  using category = typename std::iterator_traits<ForwardIt>::iterator_category;
+  constexpr std::size_t chunk = 8*step_size;
+  slicer<Executor> slices(executor, slice);
+  ForwardIt best = last;
+  const auto offer = [&](ForwardIt candidate, ForwardIt chunk_last) {
+    if (candidate != chunk_last && (best == last || bp(*candidate, *best)))
+      best = candidate;
+  };
+  if constexpr (std::is_base_of<std::random_access_iterator_tag,
+                                category>::value) {
+    const std::size_t n = std::distance(first, last);
+    const std::size_t lanes = pool ? pool->size() : 1;
+    const std::size_t chunks = (n+chunk-1)/chunk;
+    scratch_vector<ForwardIt> bests(std::min(lanes, chunks), last);
+    for (std::size_t k = 0; k < chunks; k += lanes) {
+      if (slices.expired())
+        co_await slices.yield();
+      const std::size_t count = std::min(lanes, chunks-k);
+      run_steps(pool, count, [&](std::size_t i) {
+        const std::size_t lo = (k+i)*chunk;
+        const ForwardIt chunk_last = first+std::min(n, lo+chunk);
+        bests[i] = trx::best_if(first+lo, chunk_last, up, bp);
+        if (bests[i] == chunk_last)
+          bests[i] = last;
+      });
+      for (std::size_t i = 0; i != count; ++i)
+        offer(bests[i], last);
+    }
+  } else {
+    while (first != last) {
+      if (slices.expired())
+        co_await slices.yield();
+      ForwardIt chunk_last = first;
+      for (std::size_t i = 0; i != chunk && chunk_last != last; ++i)
+        ++chunk_last;
+      offer(trx::best_if(first, chunk_last, up, bp), chunk_last);
+      first = chunk_last;
+    }
+  }
+  co_return best;
+}
+
+} // namespace detail_async_trx
+
+//! Checks whether T can be given to trx's awaitable algorithms as their
+//! executor: its post or execute member function accepts a
+//! std::function<void()>, which it calls later.
+template <class T>
+struct is_executor : detail_async_trx::is_executor<T> {};
+
+template <class T>
+constexpr bool is_executor_v = is_executor<T>::value;
+
+//! Time slices of trx's awaitable algorithms, unless another one is given.
+constexpr std::chrono::nanoseconds default_time_slice =
+    std::chrono::milliseconds(1);
+
+//! Sorts the given container in ascending order without stalling the
+//! executor.
+/*!
+  Sorts the given container in ascending order, as sort(container) does,
+  but in steps of a few thousand elements, and yields to the executor
+  whenever a time slice is over, so that the other coroutines of the
+  executor keep running. Random access containers are cut into steps which
+  are sorted by the same algorithms as sort(container), then merged
+  pairwise through a scratch buffer, each merge being cut into steps along
+  its merge path. Containers of a few thousand elements, the other
+  containers, like std::list, and those customized through trx::sorter are
+  sorted in a single step by sort(container).
+  The awaitable starts when it is awaited, in the awaiting thread, and
+  later steps run wherever the executor resumes the coroutine. The
+  container must not be accessed until the awaitable returns.
+
+  Parameters
+  container - the container, or a view of it, which must outlive the
+              awaitable.
+  executor - copied into the awaitable; its post or execute member function
+             is given the std::function<void()> resuming the sort.
+  slice - the time after which the sort yields to the executor.
+
+  Return value
+  A trx::task<void> completing once the container is sorted.
+
+  Time Complexity
+  O(nlogn)
+
+  Space Complexity
+  O(n)
+
+  Example
+  trx::task<void> refresh(std::vector<int> &vtr, loop_executor executor) {
+    co_await trx::async_sort(vtr, executor);
+  }
+*/
+template <class Container, class Executor>
+inline std::enable_if_t<is_executor<Executor>::value, task<void> >
+async_sort(Container &&container, Executor executor,
+           std::chrono::nanoseconds slice = default_time_slice) {
+  std::less<> comp;
+  return detail_async_trx::async_sort_dispatch(
+      container, comp, executor, nullptr, slice,
+      detail_algorithm_trx::priority_tag<3>());
+}
+
+//! Sorts the given container without stalling the executor.
+/*!
+  Sorts the given container as sort(container, comp) does, in steps run
+  between the yields to the executor, see async_sort(container, executor).
+
+  Parameters
+  container - the container, or a view of it, which must outlive the
+              awaitable.
+  comp - comparision function object, copied into the awaitable.
+  executor - copied into the awaitable; its post or execute member function
+             is given the std::function<void()> resuming the sort.
+  slice - the time after which the sort yields to the executor.
+
+  Return value
+  A trx::task<void> completing once the container is sorted.
+
+  Time Complexity
+  O(nlogn)
+
+  Space Complexity
+  O(n)
+
+  Example
+  co_await trx::async_sort(vtr, std::greater<>(), executor,
+                           std::chrono::microseconds(200));
+*/
+template <class Container, class Comp, class Executor>
+inline std::enable_if_t<
+    !is_execution_policy<std::decay_t<Container> >::value &&
+        is_executor<Executor>::value, task<void> >
+async_sort(Container &&container, Comp comp, Executor executor,
+           std::chrono::nanoseconds slice = default_time_slice) {
+  return detail_async_trx::async_sort_dispatch(
+      container, comp, executor, nullptr, slice,
+      detail_algorithm_trx::priority_tag<3>());
+}
+
+//! Sorts the given container in ascending order without stalling the
+//! executor, borrowing the threads of a pool.
+/*!
+  Sorts the given container as async_sort(container, executor) does, but
+  each step of a parallel policy runs one piece of the sort per thread of
+  its pool, the thread of the executor included. The executor thread is
+  then held for the longest piece of a step at most.
+
+  Parameters
+  policy - one of trx::execution::seq, par, par_unseq or
+           trx::execution::on(pool)
+  container - the container, or a view of it, which must outlive the
+              awaitable.
+  executor - copied into the awaitable; its post or execute member function
+             is given the std::function<void()> resuming the sort.
+  slice - the time after which the sort yields to the executor.
+
+  Return value
+  A trx::task<void> completing once the container is sorted.
+
+  Time Complexity
+  O(nlogn/p+n*logp), where p is the number of threads.
+
+  Space Complexity
+  O(n)
+
+  Example
+  co_await trx::async_sort(trx::execution::par, vtr, executor);
+*/
+template <class ExecutionPolicy, class Container, class Executor>
+inline std::enable_if_t<
+    is_execution_policy<std::decay_t<ExecutionPolicy> >::value &&
+        is_executor<Executor>::value, task<void> >
+async_sort(ExecutionPolicy &&policy, Container &&container,
+           Executor executor,
+           std::chrono::nanoseconds slice = default_time_slice) {
+  std::less<> comp;
+  return detail_async_trx::async_sort_dispatch(
+      container, comp, executor, detail_execution_trx::pool_of(policy),
+      slice, detail_algorithm_trx::priority_tag<3>());
+}
+
+//! Sorts the given container without stalling the executor, borrowing the
+//! threads of a pool.
+/*!
+  Sorts the given container as sort(policy, container, comp) does, in steps
+  run between the yields to the executor, see
+  async_sort(policy, container, executor).
+
+  Parameters
+  policy - one of trx::execution::seq, par, par_unseq or
+           trx::execution::on(pool)
+  container - the container, or a view of it, which must outlive the
+              awaitable.
+  comp - comparision function object, copied into the awaitable, which
+         must be safe to call concurrently.
+  executor - copied into the awaitable; its post or execute member function
+             is given the std::function<void()> resuming the sort.
+  slice - the time after which the sort yields to the executor.
+
+  Return value
+  A trx::task<void> completing once the container is sorted.
+
+  Time Complexity
+  O(nlogn/p+n*logp), where p is the number of threads.
+
+  Space Complexity
+  O(n)
+
+  Example
+  trx::thread_pool pool(4);
+  co_await trx::async_sort(trx::execution::on(pool), vtr, std::greater<>(),
+                           executor);
+*/
+template <class ExecutionPolicy, class Container, class Comp, class Executor>
+inline std::enable_if_t<
+    is_execution_policy<std::decay_t<ExecutionPolicy> >::value &&
+        is_executor<Executor>::value, task<void> >
+async_sort(ExecutionPolicy &&policy, Container &&container, Comp comp,
+           Executor executor,
+           std::chrono::nanoseconds slice = default_time_slice) {
+  return detail_async_trx::async_sort_dispatch(
+      container, comp, executor, detail_execution_trx::pool_of(policy),
+      slice, detail_algorithm_trx::priority_tag<3>());
+}
+
+//! Searches for the best element among those for which predicate returns
+//! true, without stalling the executor.
+/*!
+  Searches for the best element among those for which predicate returns
+  true, as best_if(first, last, up, bp) does, but in chunks of about a
+  hundred thousand elements, each searched by best_if, and yields to the
+  executor whenever a time slice is over. The best elements of the chunks
+  are combined from left to right, so the first best element is still the
+  one returned.
+
+  Parameters
+  first, last - the range of elements to examine, which must outlive the
+                awaitable.
+  up - unary predicate which returns true for the required sub range
+  bp - binary predicate which returns true if the first argument is better
+       than the second, it must induce a strict weak ordering
+  executor - copied into the awaitable; its post or execute member function
+             is given the std::function<void()> resuming the search.
+  slice - the time after which the search yields to the executor.
+
+  Type requirements
+  ForwardIt must meet the requirements of ForwardIterator
+  UnaryPredicate must meet the requirements of unary predicate
+  BinaryPredicate must meet the requirements of binary predicate
+
+  Return value
+  A trx::task<ForwardIt> returning the iterator to the first best element in
+  the sub range of [first, last), or last if the sub range is empty.
+
+  Time Complexity
+  O(n), where n = std::distance(first, last).
+
+  Space Complexity
+  O(1)
+
+  Example
+  auto it = co_await trx::async_best_if(prices.begin(), prices.end(),
+                                        trx::greater_than(0.0),
+                                        std::less<>(), executor);
+*/
+template <class ForwardIt, class UnaryPredicate, class BinaryPredicate,
+          class Executor>
+inline std::enable_if_t<is_executor<Executor>::value, task<ForwardIt> >
+async_best_if(ForwardIt first, ForwardIt last, UnaryPredicate up,
+              BinaryPredicate bp, Executor executor,
+              std::chrono::nanoseconds slice = default_time_slice) {
+  return detail_async_trx::best_if_steps(first, last, up, bp, executor,
+                                         nullptr, slice);
+}
+
+//! Searches for the best element among those for which predicate returns
+//! true, without stalling the executor, borrowing the threads of a pool.
+/*!
+  Searches as async_best_if(first, last, up, bp, executor) does, but each
+  step of a parallel policy searches one chunk per thread of its pool, the
+  thread of the executor included. Ranges whose iterators are not random
+  access are searched in the executor's thread.
+
+  Parameters
+  policy - one of trx::execution::seq, par, par_unseq or
+           trx::execution::on(pool)
+  first, last - the range of elements to examine, which must outlive the
+                awaitable.
+  up - unary predicate which returns true for the required sub range
+  bp - binary predicate which returns true if the first argument is better
+       than the second, it must induce a strict weak ordering
+  executor - copied into the awaitable; its post or execute member function
+             is given the std::function<void()> resuming the search.
+  slice - the time after which the search yields to the executor.
+
+  Type requirements
+  ForwardIt must meet the requirements of ForwardIterator
+  UnaryPredicate must meet the requirements of unary predicate
+  BinaryPredicate must meet the requirements of binary predicate
+  up and bp must be safe to call concurrently
+
+  Return value
+  A trx::task<ForwardIt> returning the iterator to the first best element in
+  the sub range of [first, last), or last if the sub range is empty.
+
+  Time Complexity
+  O(n/p), where n = std::distance(first, last) and p is the number of
+  threads.
+
+  Space Complexity
+  O(p)
+
+  Example
+  auto it = co_await trx::async_best_if(trx::execution::par, prices.begin(),
+                                        prices.end(), trx::any_value(),
+                                        std::greater<>(), executor);
+*/
+template <class ExecutionPolicy, class ForwardIt, class UnaryPredicate,
+          class BinaryPredicate, class Executor>
+inline std::enable_if_t<
+    is_execution_policy<std::decay_t<ExecutionPolicy> >::value &&
+        is_executor<Executor>::value, task<ForwardIt> >
+async_best_if(ExecutionPolicy &&policy, ForwardIt first, ForwardIt last,
+              UnaryPredicate up, BinaryPredicate bp, Executor executor,
+              std::chrono::nanoseconds slice = default_time_slice) {
+  return detail_async_trx::best_if_steps(
+      first, last, up, bp, executor, detail_execution_trx::pool_of(policy),
+      slice);
+}
+
+} // namespace trx
+
+#endif // _STL_EXTENSION_TRX_ASYNC_H_
@@ -0,0 +1,241 @@
+#ifndef _STL_EXTENSION_TRX_CONCURRENT_BEST_H_
+#define _STL_EXTENSION_TRX_CONCURRENT_BEST_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+namespace trx {
+//! Helper function/class templates for the current header.
+namespace detail_concurrent_best_trx {
+//! Checks whether T fits in a lock-free 64-bit word, so that concurrent_best
+//! keeps it in a single atomic.
+template <class T>
+struct is_packable : std::integral_constant<bool,
+    std::is_trivially_copyable<T>::value &&
+    sizeof(T) <= sizeof(std::uint64_t) && ATOMIC_LLONG_LOCK_FREE == 2> {};
+
+//! concurrent_best's state for packable T: the bytes of the best value in
+//! an atomic word, replaced by compare-and-swap. An offer which is not
+//! better than the current best only loads the word.
+template <class T, class Comp>
+class packed_best {
+public:
+  explicit packed_best(const Comp &comp) : comp_(comp) {}
+
+  void offer(const T &value) {
+    const std::uint64_t packed = pack(value);
+    if (state_.load(std::memory_order_acquire) != ready) {
+      unsigned char expected = empty;
+      if (state_.compare_exchange_strong(expected, publishing,
+                                         std::memory_order_acq_rel)) {
+        word_.store(packed, std::memory_order_relaxed);
+        state_.store(ready, std::memory_order_release);
+        return;
+      }
+      // another thread is storing the first value, which takes one store
+      while (state_.load(std::memory_order_acquire) != ready)
+        std::this_thread::yield();
+    }
+    std::uint64_t current = word_.load(std::memory_order_relaxed);
+    while (comp_(value, unpack(current)))
+      if (word_.compare_exchange_weak(current, packed,
+                                      std::memory_order_release,
+                                      std::memory_order_relaxed))
+        return;
+  }
+
+  bool has_value() const noexcept {
+    return state_.load(std::memory_order_acquire) == ready;
+  }
+
+  T get() const noexcept {
+    return unpack(word_.load(std::memory_order_acquire));
+  }
+
+private:
+  enum : unsigned char { empty, publishing, ready };
+
+  static std::uint64_t pack(const T &value) noexcept {
+    std::uint64_t word = 0;
+    std::memcpy(&word, std::addressof(value), sizeof(T));
+    return word;
+  }
+
+  //! T need not be default constructible: its bytes are copied into the
+  //! storage of a union.
+  static T unpack(std::uint64_t word) noexcept {
+    union storage {
+      storage() noexcept {}
+      T value;
+    } unpacked;
+    std::memcpy(static_cast<void *>(std::addressof(unpacked.value)), &word,
+                sizeof(T));
+    return unpacked.value;
+  }
+
+  Comp comp_;
+  std::atomic<std::uint64_t> word_{0};
+  std::atomic<unsigned char> state_{empty};
+};
+
+//! Returns the index of the calling thread, given out in the order threads
+//! first ask for it.
+inline std::size_t thread_index() {
+  static std::atomic<std::size_t> next{0};
+  static thread_local const std::size_t index =
+      next.fetch_add(1, std::memory_order_relaxed);
+  return index;
+}
+
+//! concurrent_best's state for other T: one slot per hardware thread, each
+//! holding the best value offered by the threads mapped to it under its own
+//! lock. Threads are mapped to the slots by their index modulo the number
+//! of slots, so offers only contend when more threads than slots offer, or
+//! with get(). Every value entering a slot takes a ticket, so that get()
+//! keeps the first offered of equivalent values across slots.
+template <class T, class Comp>
+class slotted_best {
+public:
+  explicit slotted_best(const Comp &comp)
+      : comp_(comp),
+        count_(std::max(1u, std::thread::hardware_concurrency())),
+        slots_(new slot[count_]) {}
+
+  void offer(const T &value) {
+    slot &own = slots_[thread_index()%count_];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    if (own.has_value && !comp_(value, own.value))
+      return;
+    own.value = value;
+    own.ticket = tickets_.fetch_add(1, std::memory_order_relaxed);
+    own.has_value = true;
+  }
+
+  bool has_value() const {
+    for (std::size_t i = 0; i != count_; ++i) {
+      std::lock_guard<std::mutex> lock(slots_[i].mutex);
+      if (slots_[i].has_value)
+        return true;
+    }
+    return false;
+  }
+
+  T get() const {
+    T best = T();
+    std::uint64_t ticket = 0;
+    bool found = false;
+    for (std::size_t i = 0; i != count_; ++i) {
+      const slot &candidate = slots_[i];
+      std::lock_guard<std::mutex> lock(candidate.mutex);
+      if (!candidate.has_value)
+        continue;
+      if (!found || comp_(candidate.value, best) ||
+          (!comp_(best, candidate.value) && candidate.ticket < ticket)) {
+        best = candidate.value;
+        ticket = candidate.ticket;
+        found = true;
+      }
+    }
+    return best;
+  }
+
+private:
+  //! A slot, padded so that two slots never share a cache line.
+  struct slot {
+    mutable std::mutex mutex;
+    bool has_value = false;
+    std::uint64_t ticket = 0;
+    T value = T();
+    char padding[64];
+  };
+
+  Comp comp_;
+  std::size_t count_;
+  std::unique_ptr<slot[]> slots_;
+  std::atomic<std::uint64_t> tickets_{0};
+};
+
+} // namespace detail_concurrent_best_trx
+
+//! The best value offered so far by any number of threads.
+/*!
+  The best value offered so far by any number of threads, as ordered by
+  comp: comp(a, b) returns true if a is better than b. Of several equivalent
+  values, the first one offered is kept, like best_if keeps the first of
+  equivalent elements; concurrent offers are ordered by the moment they take
+  effect.
+  A trivially copyable T of at most 8 bytes is kept in a single atomic word:
+  offer() then never locks, and an offer which is not better than the
+  current best costs one load. Other types are kept in one slot per
+  hardware thread, each behind its own lock, and are combined by get().
+  Threads share the slots in turn, so their offers contend only when more
+  threads than hardware threads offer values, and with get().
+
+  Type requirements
+  T must meet the requirements of CopyConstructible and CopyAssignable, and of
+  DefaultConstructible if it is not trivially copyable or larger than 8 bytes
+  Comp must meet the requirements of Compare, and be safe to call
+  concurrently
+
+  Example
+  trx::concurrent_best<int, std::greater<> > highest;
+  trx::thread_pool pool(4);
+  pool.run(1000, [&](std::size_t i){ highest.offer(int(i*7%1000)); });
+  assert(highest.has_value() && highest.get() == 999);
+*/
+template <class T, class Comp = std::less<> >
+class concurrent_best {
+public:
+  //! Creates a tracker to which nothing has been offered.
+  explicit concurrent_best(const Comp &comp = Comp()) : state_(comp) {}
+
+  //! Creates a tracker to which initial has been offered.
+  explicit concurrent_best(const T &initial, const Comp &comp = Comp())
+      : state_(comp) {
+    state_.offer(initial);
+  }
+
+  concurrent_best(const concurrent_best &) = delete;
+  concurrent_best &operator=(const concurrent_best &) = delete;
+
+  //! Makes value the best one if it is better than the current best, or if
+  //! nothing has been offered yet.
+  /*!
+    Time Complexity
+    O(1), lock-free for packable T when value is not the first one offered.
+  */
+  void offer(const T &value) { state_.offer(value); }
+
+  //! Returns whether a value has been offered.
+  bool has_value() const { return state_.has_value(); }
+
+  //! Returns the best value offered so far. Every offer which returned
+  //! before the call is taken into account.
+  /*!
+    Precondition, has_value() is true.
+
+    Time Complexity
+    O(1) for packable T, O(t) otherwise, where t is the number of hardware
+    threads.
+  */
+  T get() const { return state_.get(); }
+
+private:
+  std::conditional_t<detail_concurrent_best_trx::is_packable<T>::value,
+                     detail_concurrent_best_trx::packed_best<T, Comp>,
+                     detail_concurrent_best_trx::slotted_best<T, Comp> >
+      state_;
+};
+
+} // namespace trx
+
+#endif // _STL_EXTENSION_TRX_CONCURRENT_BEST_H_
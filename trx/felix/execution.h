@@ -0,0 +1,220 @@
+#ifndef _STL_EXTENSION_TRX_EXECUTION_H_
+#define _STL_EXTENSION_TRX_EXECUTION_H_
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace trx {
+//! A fixed-size pool of worker threads driving trx's parallel algorithms.
+/*!
+  A fixed-size pool of worker threads driving trx's parallel algorithms.
+  The pool only offers fork-join execution through run(): the calling thread
+  takes part in the work, so nested calls of run() from inside a task never
+  deadlock, they merely run with less parallelism.
+
+  Example
+  trx::thread_pool pool(8);
+  std::vector<int> out(100);
+  pool.run(out.size(), [&](std::size_t i){ out[i] = i*i; });
+*/
+class thread_pool {
+public:
+  //! Creates a pool with the given number of threads. A pool of size 0 or 1
+  //! has no worker and runs everything in the calling thread.
+  explicit thread_pool(std::size_t threads =
+                           std::thread::hardware_concurrency()) {
+    for (std::size_t i = 1; i < threads; ++i)
+      workers_.emplace_back([this]{ work(); });
+  }
+
+  thread_pool(const thread_pool &) = delete;
+  thread_pool &operator=(const thread_pool &) = delete;
+
+  ~thread_pool() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopping_ = true;
+    }
+    wakeup_.notify_all();
+    for (auto &worker : workers_)
+      worker.join();
+  }
+
+  //! Returns the number of threads taking part in run(), the caller included.
+  std::size_t size() const noexcept { return workers_.size()+1; }
+
+  //! Calls fn(i) for every i in [0, count) and waits for all calls to finish.
+  //! The first exception thrown by fn is rethrown in the calling thread.
+  template <class Fn>
+  void run(std::size_t count, Fn &&fn) {
+    if (count == 0)
+      return;
+    if (count == 1 || workers_.empty()) {
+      for (std::size_t i = 0; i != count; ++i)
+        fn(i);
+      return;
+    }
+    auto batch = std::make_shared<batch_state>(count);
+    batch->task = [&fn](std::size_t i){ fn(i); };
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      for (std::size_t i = 1; i < std::min(count, size()); ++i)
+        queue_.emplace_back([batch]{ batch->drain(); });
+    }
+    wakeup_.notify_all();
+    batch->drain();
+    std::unique_lock<std::mutex> lock(batch->mutex);
+    batch->finished.wait(lock, [&]{ return batch->done == batch->count; });
+    if (batch->error)
+      std::rethrow_exception(batch->error);
+  }
+
+  //! Returns the process-wide pool used by trx::execution::par and par_unseq.
+  static thread_pool &default_pool() {
+    static thread_pool pool;
+    return pool;
+  }
+
+private:
+  //! Shared state of one run() call. Helpers that start after the batch has
+  //! been drained find no index left and never touch task.
+  struct batch_state {
+    explicit batch_state(std::size_t n) : count(n) {}
+
+    void drain() {
+      std::size_t finished_here = 0;
+      for (std::size_t i; (i = next.fetch_add(1)) < count; ++finished_here) {
+        try {
+          task(i);
+        } catch (...) {
+          std::lock_guard<std::mutex> lock(mutex);
+          if (!error)
+            error = std::current_exception();
+        }
+      }
+      if (finished_here != 0) {
+        std::lock_guard<std::mutex> lock(mutex);
+        done += finished_here;
+        if (done == count)
+          finished.notify_all();
+      }
+    }
+
+    const std::size_t count;
+    std::atomic<std::size_t> next{0};
+    std::size_t done = 0;
+    std::function<void(std::size_t)> task;
+    std::exception_ptr error;
+    std::mutex mutex;
+    std::condition_variable finished;
+  };
+
+  void work() {
+    for (;;) {
+      std::function<void()> job;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        wakeup_.wait(lock, [this]{ return stopping_ || !queue_.empty(); });
+        if (queue_.empty())
+          return;
+        job = std::move(queue_.front());
+        queue_.pop_front();
+      }
+      job();
+    }
+  }
+
+  std::vector<std::thread> workers_;
+  std::deque<std::function<void()> > queue_;
+  std::mutex mutex_;
+  std::condition_variable wakeup_;
+  bool stopping_ = false;
+};
+
+//! Execution policies of trx's algorithms, mirroring std::execution.
+namespace execution {
+//! Runs the algorithm in the calling thread.
+struct sequenced_policy {};
+
+//! Runs the algorithm on trx::thread_pool::default_pool().
+struct parallel_policy {};
+
+//! Same as parallel_policy; trx's algorithms do not interleave element
+//! accesses inside a thread, so no extra freedom is taken.
+struct parallel_unsequenced_policy {};
+
+//! Runs the algorithm on a caller-owned trx::thread_pool.
+class thread_pool_policy {
+public:
+  explicit thread_pool_policy(thread_pool &pool) noexcept : pool_(&pool) {}
+
+  thread_pool &pool() const noexcept { return *pool_; }
+
+private:
+  thread_pool *pool_;
+};
+
+constexpr sequenced_policy seq{};
+constexpr parallel_policy par{};
+constexpr parallel_unsequenced_policy par_unseq{};
+
+//! Returns a policy running the algorithm on the given pool.
+inline thread_pool_policy on(thread_pool &pool) noexcept {
+  return thread_pool_policy(pool);
+}
+
+} // namespace execution
+
+//! Checks whether T is one of trx's execution policy types.
+template <class T>
+struct is_execution_policy : std::false_type {};
+
+template <>
+struct is_execution_policy<execution::sequenced_policy> : std::true_type {};
+
+template <>
+struct is_execution_policy<execution::parallel_policy> : std::true_type {};
+
+template <>
+struct is_execution_policy<execution::parallel_unsequenced_policy>
+    : std::true_type {};
+
+template <>
+struct is_execution_policy<execution::thread_pool_policy> : std::true_type {};
+
+//! Helper function/class templates for the current header.
+namespace detail_execution_trx {
+//! Returns the pool a parallel policy runs on, nullptr for sequenced_policy.
+inline thread_pool *pool_of(const execution::sequenced_policy &) noexcept {
+  return nullptr;
+}
+
+inline thread_pool *pool_of(const execution::parallel_policy &) {
+  return &thread_pool::default_pool();
+}
+
+inline thread_pool *pool_of(const execution::parallel_unsequenced_policy &) {
+  return &thread_pool::default_pool();
+}
+
+inline thread_pool *pool_of(const execution::thread_pool_policy &policy)
+    noexcept {
+  return &policy.pool();
+}
+
+} // namespace detail_execution_trx
+
+} // namespace trx
+
+#endif // _STL_EXTENSION_TRX_EXECUTION_H_
@@ -0,0 +1,759 @@
+#ifndef _STL_EXTENSION_TRX_EXTERNAL_SORT_H_
+#define _STL_EXTENSION_TRX_EXTERNAL_SORT_H_
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <future>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <sys/types.h>
+#endif
+
+#include "algorithm.h"
+#include "execution.h"
+#include "memory_resource.h"
+
+namespace trx {
+//! Helper function/class templates for the current header.
+namespace detail_external_sort_trx {
+//! Merge blocks are not made smaller than this many bytes, which bounds the
+//! number of runs merged at once by the memory budget.
+constexpr std::size_t min_block_bytes = std::size_t(1) << 16;
+
+//! Smaller memory budgets are raised to this many bytes, so that every
+//! asynchronous read or write moves a block worth a thread.
+constexpr std::size_t min_budget = 8*min_block_bytes;
+
+struct file_closer {
+  void operator()(std::FILE *file) const noexcept { std::fclose(file); }
+};
+
+using file_ptr = std::unique_ptr<std::FILE, file_closer>;
+
+inline file_ptr open_file(const std::string &path, const char *mode) {
+  file_ptr file(std::fopen(path.c_str(), mode));
+  if (!file)
+    throw std::system_error(errno, std::generic_category(),
+                            "trx::external_sort: cannot open " + path);
+  return file;
+}
+
+//! Returns an anonymous file, removed once closed.
+inline file_ptr temporary_file() {
+  file_ptr file(std::tmpfile());
+  if (!file)
+    throw std::system_error(errno, std::generic_category(),
+                            "trx::external_sort: cannot create a temporary "
+                            "file");
+  return file;
+}
+
+//! Reads up to n records from file, and returns the number of records read.
+template <class T>
+std::size_t read_records(std::FILE *file, T *data, std::size_t n) {
+  const std::size_t bytes = std::fread(data, 1, n*sizeof(T), file);
+  if (std::ferror(file))
+    throw std::system_error(errno, std::generic_category(),
+                            "trx::external_sort: read failed");
+  if (bytes%sizeof(T) != 0)
+    throw std::runtime_error("trx::external_sort: the file size is not a "
+                             "multiple of the record size");
+  return bytes/sizeof(T);
+}
+
+template <class T>
+void write_records(std::FILE *file, const T *data, std::size_t n) {
+  if (std::fwrite(data, sizeof(T), n, file) != n)
+    throw std::system_error(errno, std::generic_category(),
+                            "trx::external_sort: write failed");
+}
+
+//! Flushes a file written so far, to read it back.
+inline void flush_file(std::FILE *file) {
+  if (std::fflush(file) != 0)
+    throw std::system_error(errno, std::generic_category(),
+                            "trx::external_sort: write failed");
+}
+
+//! Moves the position of file to the given byte offset, which may exceed the
+//! range of long: run files are expected to outgrow the memory.
+inline void seek_file(std::FILE *file, std::uint64_t offset) {
+#if defined(_WIN32)
+  using offset_type = __int64;
+#else
+  using offset_type = off_t;
+#endif
+  if (offset > static_cast<std::uint64_t>(
+                   std::numeric_limits<offset_type>::max()))
+    throw std::system_error(EOVERFLOW, std::generic_category(),
+                            "trx::external_sort: read failed");
+#if defined(_WIN32)
+  const int result = _fseeki64(file, static_cast<offset_type>(offset),
+                               SEEK_SET);
+#else
+  const int result = fseeko(file, static_cast<offset_type>(offset), SEEK_SET);
+#endif
+  if (result != 0)
+    throw std::system_error(errno, std::generic_category(),
+                            "trx::external_sort: read failed");
+}
+
+//! A sorted run of records, stored from an offset of a run_file.
+struct run {
+  std::size_t offset, size;
+};
+
+//! A temporary file holding runs one after the other. Reads of the runs are
+//! serialized, as they share the file position.
+struct run_file {
+  run_file() : file(temporary_file()) {}
+
+  //! Reads n records starting at the record of the given index.
+  template <class T>
+  std::size_t read(std::size_t index, T *data, std::size_t n) {
+    std::lock_guard<std::mutex> lock(mutex);
+    seek_file(file.get(), std::uint64_t(index)*sizeof(T));
+    return read_records(file.get(), data, n);
+  }
+
+  file_ptr file;
+  std::mutex mutex;
+};
+
+//! A stream of the records of a run read by blocks, the next block being
+//! read asynchronously while the current one is consumed.
+template <class T>
+class block_reader {
+public:
+  block_reader(run_file &file, run source, std::size_t block)
+      : file_(file), next_index_(source.offset),
+        remaining_(source.size), current_(std::min(block, source.size)),
+        next_(current_.size()) {
+    size_ = file_.read(next_index_, current_.data(), current_.size());
+    advance(size_);
+    if (remaining_ != 0)
+      prefetch();
+  }
+
+  block_reader(const block_reader &) = delete;
+  block_reader &operator=(const block_reader &) = delete;
+
+  bool empty() const noexcept { return position_ == size_; }
+
+  const T &front() const noexcept { return current_[position_]; }
+
+  void pop() {
+    if (++position_ == size_ && pending_.valid()) {
+      size_ = pending_.get();
+      position_ = 0;
+      current_.swap(next_);
+      advance(size_);
+      if (remaining_ != 0)
+        prefetch();
+    }
+  }
+
+private:
+  void advance(std::size_t n) {
+    if (n == 0 && remaining_ != 0)
+      throw std::runtime_error("trx::external_sort: a temporary file is "
+                               "truncated");
+    next_index_ += n;
+    remaining_ -= n;
+  }
+
+  void prefetch() {
+    pending_ = std::async(std::launch::async, [this] {
+      return file_.read(next_index_, next_.data(),
+                        std::min(next_.size(), remaining_));
+    });
+  }
+
+  run_file &file_;
+  std::size_t next_index_, remaining_;
+  scratch_vector<T> current_, next_;
+  std::size_t position_ = 0, size_ = 0;
+  // declared last, so that a pending read finishes before the buffers go
+  std::future<std::size_t> pending_;
+};
+
+//! A stream of records in memory.
+template <class T>
+class span_reader {
+public:
+  span_reader(const T *first, const T *last) noexcept
+      : first_(first), last_(last) {}
+
+  bool empty() const noexcept { return first_ == last_; }
+
+  const T &front() const noexcept { return *first_; }
+
+  void pop() noexcept { ++first_; }
+
+private:
+  const T *first_, *last_;
+};
+
+//! A sink of records written to a file by blocks, each full block being
+//! written asynchronously while the next one is filled. The block buffer is
+//! only allocated by the first push, so a writer given whole chunks by
+//! write() holds no buffer of its own.
+template <class T>
+class block_writer {
+public:
+  block_writer(std::FILE *file, std::size_t block)
+      : file_(file), block_(block) {}
+
+  block_writer(const block_writer &) = delete;
+  block_writer &operator=(const block_writer &) = delete;
+
+  void push(const T &record) {
+    if (current_.empty())
+      current_.reserve(block_);
+    current_.push_back(record);
+    if (current_.size() == block_)
+      flush();
+  }
+
+  //! Writes the given records after those pushed so far, and leaves in
+  //! records a buffer to be reused.
+  void write(scratch_vector<T> &records) {
+    flush();
+    wait();
+    writing_.swap(records);
+    start();
+  }
+
+  //! Writes the pending records and waits for all writes to finish.
+  void finish() {
+    flush();
+    wait();
+  }
+
+private:
+  void flush() {
+    if (current_.empty())
+      return;
+    wait();
+    writing_.swap(current_);
+    current_.clear();
+    start();
+  }
+
+  void wait() {
+    if (pending_.valid())
+      pending_.get();
+  }
+
+  void start() {
+    pending_ = std::async(std::launch::async, [this] {
+      write_records(file_, writing_.data(), writing_.size());
+    });
+  }
+
+  std::FILE *file_;
+  std::size_t block_;
+  scratch_vector<T> current_, writing_;
+  // declared last, so that a pending write finishes before the buffers go
+  std::future<void> pending_;
+};
+
+//! Merges the given sorted sources into out.
+template <class Source, class T, class Comp>
+void merge_sources(scratch_vector<Source *> sources, block_writer<T> &out,
+                   Comp &comp) {
+  detail_algorithm_trx::loser_tree<Source, Comp> tree(std::move(sources),
+                                                      comp);
+  while (!tree.empty()) {
+    Source &source = tree.top();
+    out.push(source.front());
+    source.pop();
+    tree.replay();
+  }
+  out.finish();
+}
+
+//! Sorts a chunk in memory, on the pool if any.
+template <class T, class Comp>
+void sort_chunk(thread_pool *pool, T *first, T *last, Comp &comp) {
+  if (pool)
+    detail_algorithm_trx::parallel_sort(*pool, first, last, comp);
+  else
+    detail_algorithm_trx::sort_range(first, last, comp);
+}
+
+//! Returns the number of records of the blocks used when merging the given
+//! number of runs within the budget: every run and the output are double
+//! buffered.
+template <class T>
+std::size_t merge_block(std::size_t budget, std::size_t runs) {
+  return std::max<std::size_t>(1, budget/(2*(runs+1)*sizeof(T)));
+}
+
+//! Returns the number of runs which can be merged at once within the budget,
+//! so that merge_block gives every run and the output a block of at least
+//! min_block_bytes.
+template <class T>
+std::size_t max_fan_in(std::size_t budget) {
+  const std::size_t block = std::max(min_block_bytes, sizeof(T));
+  return std::max<std::size_t>(2, budget/(2*block)-1);
+}
+
+//! Merges the runs of the file into out. Runs are merged by groups into a
+//! new file first while they exceed the fan-in.
+template <class T, class Comp>
+void merge_runs(std::unique_ptr<run_file> file, scratch_vector<run> runs,
+                std::FILE *out, std::size_t budget, Comp &comp) {
+  const std::size_t fan_in = max_fan_in<T>(budget);
+  for (;;) {
+    const bool last_pass = runs.size() <= fan_in;
+    std::unique_ptr<run_file> merged_file;
+    scratch_vector<run> merged;
+    if (!last_pass)
+      merged_file.reset(new run_file);
+    for (std::size_t first = 0; first < runs.size(); first += fan_in) {
+      const std::size_t count = std::min(fan_in, runs.size()-first);
+      const std::size_t block = merge_block<T>(budget, count);
+      scratch_vector<std::unique_ptr<block_reader<T> > > readers;
+      scratch_vector<block_reader<T> *> sources;
+      run result{merged.empty() ? 0 : merged.back().offset+merged.back().size,
+                 0};
+      for (std::size_t i = first; i != first+count; ++i) {
+        readers.emplace_back(new block_reader<T>(*file, runs[i], block));
+        sources.push_back(readers.back().get());
+        result.size += runs[i].size;
+      }
+      block_writer<T> writer(last_pass ? out : merged_file->file.get(),
+                             block);
+      merge_sources(std::move(sources), writer, comp);
+      merged.push_back(result);
+    }
+    if (last_pass)
+      return;
+    flush_file(merged_file->file.get());
+    file = std::move(merged_file);
+    runs = std::move(merged);
+  }
+}
+
+//! external_sort's(file) helper: the input is read by chunks fitting in the
+//! budget, each chunk is sorted while the previous one is written as a run,
+//! then the runs are merged into the output.
+template <class T, class Comp>
+void external_sort_file(thread_pool *pool, const std::string &input,
+                        const std::string &output, std::size_t budget,
+                        Comp &comp) {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "trx::external_sort requires trivially copyable records.");
+  budget = std::max(budget, min_budget);
+  // one chunk being sorted, its sorting scratch and one chunk being written
+  const std::size_t chunk = std::max<std::size_t>(1, budget/(3*sizeof(T)));
+  std::unique_ptr<run_file> file(new run_file);
+  scratch_vector<run> runs;
+  scratch_vector<T> records(chunk);
+  {
+    file_ptr in = open_file(input, "rb");
+    std::size_t n = read_records(in.get(), records.data(), chunk);
+    if (n < chunk) {
+      in.reset();
+      records.resize(n);
+      sort_chunk(pool, records.data(), records.data()+n, comp);
+      file_ptr out = open_file(output, "wb");
+      write_records(out.get(), records.data(), n);
+      flush_file(out.get());
+      return;
+    }
+    block_writer<T> writer(file->file.get(), chunk);
+    for (std::size_t offset = 0; n != 0; ) {
+      records.resize(n);
+      sort_chunk(pool, records.data(), records.data()+n, comp);
+      writer.write(records);
+      runs.push_back(run{offset, n});
+      offset += n;
+      records.resize(chunk);
+      n = read_records(in.get(), records.data(), chunk);
+    }
+    writer.finish();
+  }
+  records.clear();
+  records.shrink_to_fit();
+  flush_file(file->file.get());
+  file_ptr out = open_file(output, "wb");
+  merge_runs<T>(std::move(file), std::move(runs), out.get(), budget, comp);
+  flush_file(out.get());
+}
+
+//! external_sort's(span) helper: chunks fitting in the budget are sorted in
+//! place, then merged into a temporary file which is read back.
+template <class T, class Comp>
+void external_sort_span(thread_pool *pool, T *first, T *last,
+                        std::size_t budget, Comp &comp) {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "trx::external_sort requires trivially copyable records.");
+  budget = std::max(budget, min_budget);
+  const std::size_t n = last-first;
+  const std::size_t chunk = std::max<std::size_t>(1, budget/(2*sizeof(T)));
+  if (n <= chunk) {
+    sort_chunk(pool, first, last, comp);
+    return;
+  }
+  scratch_vector<span_reader<T> > readers;
+  for (T *lo = first; lo != last; ) {
+    T *hi = lo+std::min<std::size_t>(chunk, last-lo);
+    sort_chunk(pool, lo, hi, comp);
+    readers.emplace_back(lo, hi);
+    lo = hi;
+  }
+  scratch_vector<span_reader<T> *> sources;
+  for (auto &reader : readers)
+    sources.push_back(&reader);
+  file_ptr merged = temporary_file();
+  block_writer<T> writer(merged.get(), std::max<std::size_t>(
+      1, budget/(2*sizeof(T))));
+  merge_sources(std::move(sources), writer, comp);
+  flush_file(merged.get());
+  std::rewind(merged.get());
+  if (read_records(merged.get(), first, n) != n)
+    throw std::runtime_error("trx::external_sort: the temporary file is "
+                             "truncated");
+}
+
+} // namespace detail_external_sort_trx
+
+//! Sorts a file of records which may not fit in memory.
+/*!
+  Sorts a binary file of records of type T, which may be larger than the
+  memory, into another file, using the given comparison function comp to
+  compare the records, operator< if none is given. The input is read by
+  chunks of a third of the memory budget; each chunk is sorted by trx::sort
+  while the previous one is written asynchronously to a temporary run file.
+  The runs are then merged through a loser tree, every run being read ahead
+  and the output written behind by blocks on other threads. When the runs
+  are too many for the budget to give each one a block of at least 64KiB,
+  they are merged by groups first. The sort is not stable.
+
+  Parameters
+  input - the path of the input file, holding records of type T.
+  output - the path of the output file, which may be the input file.
+  memory_budget - the number of bytes of records kept in memory, at least
+                  512KiB.
+  comp - comparision function object.
+
+  Type requirements
+  T must be TriviallyCopyable, the files holding its object representation.
+
+  Return value
+  (none)
+
+  Exceptions
+  std::system_error if a file cannot be opened, read or written,
+  std::runtime_error if the input size is not a multiple of sizeof(T).
+
+  Time Complexity
+  O(nlogn) comparisons, O(nlog(n/m)/log(m/B)) I/O of blocks of B bytes,
+  where m is the memory budget
+
+  Space Complexity
+  O(m) in memory, O(n) on disk
+
+  Example
+  struct record { std::uint64_t key; char payload[56]; };
+  external_sort<record>("in.bin", "out.bin", std::size_t(1) << 30,
+      [](const record &lhs, const record &rhs){ return lhs.key < rhs.key; });
+*/
+template <class T, class Comp = std::less<> >
+inline void external_sort(const std::string &input, const std::string &output,
+                          std::size_t memory_budget, Comp comp = Comp()) {
+  detail_external_sort_trx::external_sort_file<T>(nullptr, input, output,
+                                                   memory_budget, comp);
+}
+
+//! Sorts a file of records which may not fit in memory, taking the buffers
+//! from the given resource.
+/*!
+  Sorts a binary file of records of type T into another file as
+  external_sort(input, output, memory_budget, comp) does, taking the chunk
+  and the blocks from the resource of the tag.
+
+  Parameters
+  input - the path of the input file, holding records of type T.
+  output - the path of the output file, which may be the input file.
+  memory_budget - the number of bytes of records kept in memory, at least
+                  512KiB.
+  comp - comparision function object.
+  scratch - trx::thread_scratch, or scratch_from(resource).
+
+  Return value
+  (none)
+
+  Time Complexity
+  O(nlogn) comparisons
+
+  Space Complexity
+  O(m) in memory, taken from the tag's resource, O(n) on disk
+
+  Example
+  external_sort<std::uint64_t>("in.bin", "out.bin", std::size_t(1) << 30,
+                               std::less<>(), trx::thread_scratch);
+*/
+template <class T, class Comp>
+inline void external_sort(const std::string &input, const std::string &output,
+                          std::size_t memory_budget, Comp comp,
+                          scratch_t scratch) {
+  const detail_memory_resource_trx::scratch_scope scope(scratch);
+  detail_external_sort_trx::external_sort_file<T>(nullptr, input, output,
+                                                   memory_budget, comp);
+}
+
+//! Sorts a file of records which may not fit in memory.
+/*!
+  Sorts a binary file of records of type T into another file as
+  external_sort(input, output, memory_budget, comp) does, executed according
+  to policy: with the parallel policies, every chunk is sorted in parallel.
+
+  Parameters
+  policy - the execution policy to use.
+  input - the path of the input file, holding records of type T.
+  output - the path of the output file, which may be the input file.
+  memory_budget - the number of bytes of records kept in memory, at least
+                  512KiB.
+  comp - comparision function object.
+
+  Return value
+  (none)
+
+  Time Complexity
+  O(nlogn) comparisons
+
+  Space Complexity
+  O(m) in memory, O(n) on disk
+
+  Example
+  external_sort<std::uint64_t>(trx::execution::par, "in.bin", "out.bin",
+                               std::size_t(1) << 30);
+*/
+template <class T, class ExecutionPolicy, class Comp = std::less<> >
+inline std::enable_if_t<
+    is_execution_policy<std::decay_t<ExecutionPolicy> >::value, void>
+external_sort(ExecutionPolicy &&policy, const std::string &input,
+              const std::string &output, std::size_t memory_budget,
+              Comp comp = Comp()) {
+  detail_external_sort_trx::external_sort_file<T>(
+      detail_execution_trx::pool_of(policy), input, output, memory_budget,
+      comp);
+}
+
+//! Sorts a file of records which may not fit in memory, taking the buffers
+//! from the given resource.
+/*!
+  Sorts a binary file of records of type T into another file as
+  external_sort(policy, input, output, memory_budget, comp) does, taking
+  the buffers of every thread from the resource of the tag, which must be
+  thread-safe with the parallel policies unless it is trx::thread_scratch.
+
+  Parameters
+  policy - the execution policy to use.
+  input - the path of the input file, holding records of type T.
+  output - the path of the output file, which may be the input file.
+  memory_budget - the number of bytes of records kept in memory, at least
+                  512KiB.
+  comp - comparision function object.
+  scratch - trx::thread_scratch, or scratch_from(resource).
+
+  Return value
+  (none)
+
+  Time Complexity
+  O(nlogn) comparisons
+
+  Space Complexity
+  O(m) in memory, taken from the tag's resource, O(n) on disk
+
+  Example
+  external_sort<std::uint64_t>(trx::execution::par, "in.bin", "out.bin",
+                               std::size_t(1) << 30, std::less<>(),
+                               trx::thread_scratch);
+*/
+template <class T, class ExecutionPolicy, class Comp>
+inline std::enable_if_t<
+    is_execution_policy<std::decay_t<ExecutionPolicy> >::value, void>
+external_sort(ExecutionPolicy &&policy, const std::string &input,
+              const std::string &output, std::size_t memory_budget,
+              Comp comp, scratch_t scratch) {
+  const detail_memory_resource_trx::scratch_scope scope(scratch);
+  detail_external_sort_trx::external_sort_file<T>(
+      detail_execution_trx::pool_of(policy), input, output, memory_budget,
+      comp);
+}
+
+//! Sorts records, typically memory-mapped, touching them sequentially.
+/*!
+  Sorts the records of [first, last), typically a memory-mapped file, using
+  the given comparison function comp to compare them, operator< if none is
+  given. Chunks of half the memory budget are sorted in place, so that only
+  one chunk of the mapping is accessed at random at a time; the chunks are
+  then merged through a loser tree into a temporary file, written
+  asynchronously, which is finally read back into the range. The sort is not
+  stable.
+
+  Parameters
+  first, last - the range of records to sort.
+  memory_budget - the number of bytes of records accessed at random at once,
+                  at least 512KiB.
+  comp - comparision function object.
+
+  Type requirements
+  T must be TriviallyCopyable.
+
+  Return value
+  (none)
+
+  Exceptions
+  std::system_error if the temporary file cannot be created, read or
+  written.
+
+  Time Complexity
+  O(nlogn) comparisons
+
+  Space Complexity
+  O(m) in memory, O(n) on disk
+
+  Example
+  auto *records = static_cast<std::uint64_t *>(
+      mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0));
+  external_sort(records, records+size/8, std::size_t(1) << 30);
+*/
+template <class T, class Comp = std::less<> >
+inline void external_sort(T *first, T *last, std::size_t memory_budget,
+                          Comp comp = Comp()) {
+  detail_external_sort_trx::external_sort_span(nullptr, first, last,
+                                               memory_budget, comp);
+}
+
+//! Sorts records, typically memory-mapped, touching them sequentially, taking
+//! the buffers from the given resource.
+/*!
+  Sorts the records of [first, last) as external_sort(first, last,
+  memory_budget, comp) does, taking the merge blocks from the resource of
+  the tag.
+
+  Parameters
+  first, last - the range of records to sort.
+  memory_budget - the number of bytes of records accessed at random at once,
+                  at least 512KiB.
+  comp - comparision function object.
+  scratch - trx::thread_scratch, or scratch_from(resource).
+
+  Return value
+  (none)
+
+  Time Complexity
+  O(nlogn) comparisons
+
+  Space Complexity
+  O(m) in memory, taken from the tag's resource, O(n) on disk
+
+  Example
+  external_sort(records, records+count, std::size_t(1) << 30, std::less<>(),
+                trx::thread_scratch);
+*/
+template <class T, class Comp>
+inline void external_sort(T *first, T *last, std::size_t memory_budget,
+                          Comp comp, scratch_t scratch) {
+  const detail_memory_resource_trx::scratch_scope scope(scratch);
+  detail_external_sort_trx::external_sort_span(nullptr, first, last,
+                                               memory_budget, comp);
+}
+
+//! Sorts records, typically memory-mapped, touching them sequentially.
+/*!
+  Sorts the records of [first, last) as external_sort(first, last,
+  memory_budget, comp) does, executed according to policy: with the parallel
+  policies, every chunk is sorted in parallel.
+
+  Parameters
+  policy - the execution policy to use.
+  first, last - the range of records to sort.
+  memory_budget - the number of bytes of records accessed at random at once,
+                  at least 512KiB.
+  comp - comparision function object.
+
+  Return value
+  (none)
+
+  Time Complexity
+  O(nlogn) comparisons
+
+  Space Complexity
+  O(m) in memory, O(n) on disk
+
+  Example
+  external_sort(trx::execution::par, records, records+count,
+                std::size_t(1) << 30);
+*/
+template <class ExecutionPolicy, class T, class Comp = std::less<> >
+inline std::enable_if_t<
+    is_execution_policy<std::decay_t<ExecutionPolicy> >::value, void>
+external_sort(ExecutionPolicy &&policy, T *first, T *last,
+              std::size_t memory_budget, Comp comp = Comp()) {
+  detail_external_sort_trx::external_sort_span(
+      detail_execution_trx::pool_of(policy), first, last, memory_budget,
+      comp);
+}
+
+//! Sorts records, typically memory-mapped, touching them sequentially, taking
+//! the buffers from the given resource.
+/*!
+  Sorts the records of [first, last) as external_sort(policy, first, last,
+  memory_budget, comp) does, taking the buffers of every thread from the
+  resource of the tag, which must be thread-safe with the parallel policies
+  unless it is trx::thread_scratch.
+
+  Parameters
+  policy - the execution policy to use.
+  first, last - the range of records to sort.
+  memory_budget - the number of bytes of records accessed at random at once,
+                  at least 512KiB.
+  comp - comparision function object.
+  scratch - trx::thread_scratch, or scratch_from(resource).
+
+  Return value
+  (none)
+
+  Time Complexity
+  O(nlogn) comparisons
+
+  Space Complexity
+  O(m) in memory, taken from the tag's resource, O(n) on disk
+
+  Example
+  external_sort(trx::execution::par, records, records+count,
+                std::size_t(1) << 30, std::less<>(), trx::thread_scratch);
+*/
+template <class ExecutionPolicy, class T, class Comp>
+inline std::enable_if_t<
+    is_execution_policy<std::decay_t<ExecutionPolicy> >::value, void>
+external_sort(ExecutionPolicy &&policy, T *first, T *last,
+              std::size_t memory_budget, Comp comp, scratch_t scratch) {
+  const detail_memory_resource_trx::scratch_scope scope(scratch);
+  detail_external_sort_trx::external_sort_span(
+      detail_execution_trx::pool_of(policy), first, last, memory_budget,
+      comp);
+}
+
+} // namespace trx
+
+#endif // _STL_EXTENSION_TRX_EXTERNAL_SORT_H_
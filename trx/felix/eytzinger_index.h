@@ -0,0 +1,447 @@
+#ifndef _STL_EXTENSION_TRX_EYTZINGER_INDEX_H_
+#define _STL_EXTENSION_TRX_EYTZINGER_INDEX_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "algorithm.h"
+#include "memory_resource.h"
+#include "simd.h"
+
+namespace trx {
+//! Tag selecting the Eytzinger layout of eytzinger_index.
+struct eytzinger_layout_t {};
+
+//! Tag selecting the blocked layout of eytzinger_index, a static B-tree.
+struct blocked_layout_t {};
+
+constexpr eytzinger_layout_t eytzinger_layout{};
+constexpr blocked_layout_t blocked_layout{};
+
+//! Helper function/class templates for the current header.
+namespace detail_eytzinger_index_trx {
+using detail_simd_trx::compare_op;
+using detail_simd_trx::stree_batch;
+using detail_simd_trx::stree_node_bytes;
+
+//! Allocator of the key arrays, aligned on cache lines so that the nodes
+//! of the layouts never straddle two of them.
+template <class T>
+class cache_aligned_allocator {
+public:
+  using value_type = T;
+
+  static constexpr std::size_t alignment =
+      alignof(T) > stree_node_bytes ? alignof(T) : stree_node_bytes;
+
+  cache_aligned_allocator() = default;
+
+  template <class U>
+  cache_aligned_allocator(const cache_aligned_allocator<U> &) noexcept {}
+
+  T *allocate(std::size_t n) {
+    if (n > std::numeric_limits<std::size_t>::max()/sizeof(T))
+      throw std::bad_array_new_length();
+    return static_cast<T *>(
+        pmr::new_delete_resource()->allocate(n*sizeof(T), alignment));
+  }
+
+  void deallocate(T *p, std::size_t n) noexcept {
+    pmr::new_delete_resource()->deallocate(p, n*sizeof(T), alignment);
+  }
+};
+
+template <class T, class U>
+inline bool operator==(const cache_aligned_allocator<T> &,
+                       const cache_aligned_allocator<U> &) noexcept {
+  return true;
+}
+
+template <class T, class U>
+inline bool operator!=(const cache_aligned_allocator<T> &,
+                       const cache_aligned_allocator<U> &) noexcept {
+  return false;
+}
+
+template <class T>
+using aligned_vector = std::vector<T, cache_aligned_allocator<T> >;
+
+//! Prefetches the cache line at address, which may lie past the end of the
+//! arrays since it is computed as an integer.
+inline void prefetch(std::uintptr_t address) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+  __builtin_prefetch(reinterpret_cast<const void *>(address));
+#else
+  (void)address;
+#endif
+}
+
+//! Returns the number of trailing one bits of k, k not being all ones.
+inline unsigned trailing_ones(std::size_t k) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+  return static_cast<unsigned>(
+      __builtin_ctzll(~static_cast<unsigned long long>(k)));
+#else
+  unsigned ones = 0;
+  for (; k & 1; k >>= 1)
+    ++ones;
+  return ones;
+#endif
+}
+
+//! Tells which compare_op the stree_search kernels use for the lower bounds
+//! (Upper false) or the upper bounds (Upper true) under Comp.
+template <class T, class Comp, bool Upper>
+struct blocked_op {
+  static constexpr int direction =
+      detail_algorithm_trx::radix_direction<T, Comp>::value;
+  static constexpr compare_op value =
+      direction == 1 ? (Upper ? compare_op::less_equal : compare_op::less) :
+                       (Upper ? compare_op::greater_equal :
+                                compare_op::greater);
+};
+
+//! Checks whether the blocked layout can index T under Comp: arithmetic
+//! values ordered by operator< or operator>.
+template <class T, class Comp>
+struct is_blockable : std::integral_constant<bool,
+    detail_simd_trx::is_simd_element<T>::value &&
+    detail_algorithm_trx::radix_direction<T, Comp>::value != 0> {};
+
+} // namespace detail_eytzinger_index_trx
+
+//! A search index over a sorted container, laid out for cache-friendly
+//! lower_bound and upper_bound lookups.
+/*!
+  A search index over a sorted container, answering lower_bound and
+  upper_bound with the rank of the element found, its index in the sorted
+  container, or n if there is none. The keys are copied into one of two
+  layouts, both aligned on cache lines:
+  - eytzinger_layout, the default, stores the implicit binary search tree
+    in breadth-first order, the children of node k at 2k and 2k+1. The
+    search descends without branches, the next node being picked by the
+    result of the comparison, and prefetches the cache line holding the
+    descendants of the node a few levels down, which are contiguous.
+  - blocked_layout stores a static B-tree whose nodes fill a cache line,
+    16 keys of 32 bits, searched by comparing the whole node against the
+    key with the SIMD kernels. A lookup then touches log_17(n) cache lines
+    instead of log_2(n). Only for arithmetic keys ordered by std::less or
+    std::greater, and without NaNs.
+  The ranges of keys given to lower_bound(first, last, out) are searched in
+  groups of 16 queries interleaved level by level, the next node of each
+  query being prefetched while the others are compared, so that their cache
+  misses overlap instead of adding up.
+  Ranks are stored as Index: std::uint32_t halves the table of ranks when
+  the size is known to fit.
+
+  Type requirements
+  T must meet the requirements of DefaultConstructible and CopyAssignable
+  Comp must meet the requirements of Compare
+  Index must be an unsigned integer type able to represent the size
+
+  Example
+  std::vector<int> thresholds{10, 20, 30, 40};
+  trx::eytzinger_index<int> index(thresholds);
+  assert(index.lower_bound(25) == 2);
+  assert(index.upper_bound(40) == 4);
+  trx::eytzinger_index<int> blocked(thresholds, trx::blocked_layout);
+  std::vector<int> queries{5, 20, 45};
+  std::vector<std::size_t> ranks(queries.size());
+  blocked.lower_bound(queries.begin(), queries.end(), ranks.begin());
+  assert(ranks == std::vector<std::size_t>({0, 1, 4}));
+*/
+template <class T, class Comp = std::less<>, class Index = std::size_t>
+class eytzinger_index {
+public:
+  using value_type = T;
+  using value_compare = Comp;
+  using size_type = std::size_t;
+
+  //! Creates an empty index.
+  eytzinger_index() : ranks_(1, 0) {}
+
+  //! Creates an Eytzinger index over a container sorted by comp.
+  /*!
+    Time Complexity
+    O(n), with a single in-order pass over the container.
+  */
+  template <class Container>
+  explicit eytzinger_index(const Container &sorted, Comp comp = Comp())
+      : eytzinger_index(sorted, eytzinger_layout, comp) {}
+
+  template <class Container>
+  eytzinger_index(const Container &sorted, eytzinger_layout_t,
+                  Comp comp = Comp())
+      : comp_(comp) {
+    using std::begin;
+    using std::end;
+    size_ = std::distance(begin(sorted), end(sorted));
+    keys_.resize(size_+1);
+    ranks_.resize(size_+1);
+    // a failed search ends at node 0, whose rank is n
+    ranks_[0] = static_cast<Index>(size_);
+    auto it = begin(sorted);
+    Index rank = 0;
+    build_eytzinger(1, it, rank);
+  }
+
+  //! Creates a blocked index over a container sorted by comp.
+  /*!
+    Time Complexity
+    O(n), with a single in-order pass over the container.
+  */
+  template <class Container>
+  eytzinger_index(const Container &sorted, blocked_layout_t,
+                  Comp comp = Comp())
+      : comp_(comp) {
+    static_assert(
+        detail_eytzinger_index_trx::is_blockable<T, Comp>::value,
+        "trx::blocked_layout requires arithmetic keys ordered by std::less "
+        "or std::greater.");
+    using std::begin;
+    using std::end;
+    size_ = std::distance(begin(sorted), end(sorted));
+    blocks_ = (size_+node_keys-1)/node_keys;
+    // the padding keys come after every key, and the searches ending on
+    // them or past the last slot find rank n
+    keys_.assign(blocks_*node_keys, padding_key());
+    ranks_.assign(blocks_*node_keys+1, static_cast<Index>(size_));
+    auto it = begin(sorted);
+    Index rank = 0;
+    build_blocked(0, it, rank);
+  }
+
+  size_type size() const noexcept { return size_; }
+
+  bool empty() const noexcept { return size_ == 0; }
+
+  //! Tells whether the index has the blocked layout.
+  bool blocked() const noexcept { return blocks_ != 0; }
+
+  //! Returns the rank of the first element not before key, size() if there
+  //! is none, as std::lower_bound over the sorted container would.
+  /*!
+    Time Complexity
+    O(logn)
+  */
+  template <class Key>
+  size_type lower_bound(const Key &key) const {
+    return search<false>(key);
+  }
+
+  //! Returns the rank of the first element after key, size() if there is
+  //! none, as std::upper_bound over the sorted container would.
+  template <class Key>
+  size_type upper_bound(const Key &key) const {
+    return search<true>(key);
+  }
+
+  //! Writes to out the lower_bound of every key of [first, last), in order,
+  //! interleaving the searches of groups of keys. Returns the end of the
+  //! output.
+  /*!
+    Time Complexity
+    O(mlogn), where m = std::distance(first, last), with the cache misses
+    of up to 16 searches overlapping.
+  */
+  template <class InputIt, class OutputIt>
+  OutputIt lower_bound(InputIt first, InputIt last, OutputIt out) const {
+    return search_all<false>(first, last, out);
+  }
+
+  //! Writes to out the upper_bound of every key of [first, last), in order.
+  template <class InputIt, class OutputIt>
+  OutputIt upper_bound(InputIt first, InputIt last, OutputIt out) const {
+    return search_all<true>(first, last, out);
+  }
+
+  value_compare value_comp() const { return comp_; }
+
+private:
+  using compare_op = detail_simd_trx::compare_op;
+  using blockable = detail_eytzinger_index_trx::is_blockable<T, Comp>;
+
+  //! The keys of a node of the blocked layout, which fill a cache line.
+  static constexpr std::size_t node_keys =
+      sizeof(T) < detail_simd_trx::stree_node_bytes ?
+          detail_simd_trx::stree_node_bytes/sizeof(T) : 1;
+
+  //! The Eytzinger search prefetches the node this many times deeper than
+  //! the current one, whose descendants at that depth fill a cache line.
+  static constexpr std::size_t prefetch_stride =
+      sizeof(T) < detail_simd_trx::stree_node_bytes/2 ?
+          detail_simd_trx::stree_node_bytes/sizeof(T) : 2;
+
+  //! The key padding the last node of the blocked layout, after all others.
+  static T padding_key() {
+    constexpr bool descending =
+        detail_algorithm_trx::radix_direction<T, Comp>::value == -1;
+    using limits = std::numeric_limits<T>;
+    return limits::has_infinity ?
+        (descending ? -limits::infinity() : limits::infinity()) :
+        (descending ? limits::lowest() : limits::max());
+  }
+
+  //! Copies the keys in the in-order of the subtree of node k, the keys
+  //! being read in their sorted order.
+  template <class It>
+  void build_eytzinger(std::size_t k, It &it, Index &rank) {
+    if (k > size_)
+      return;
+    build_eytzinger(2*k, it, rank);
+    keys_[k] = *it;
+    ++it;
+    ranks_[k] = rank++;
+    build_eytzinger(2*k+1, it, rank);
+  }
+
+  template <class It>
+  void build_blocked(std::size_t node, It &it, Index &rank) {
+    if (node >= blocks_)
+      return;
+    for (std::size_t i = 0; i != node_keys; ++i) {
+      build_blocked(node*(node_keys+1)+i+1, it, rank);
+      if (rank == size_)
+        continue;
+      keys_[node*node_keys+i] = *it;
+      ++it;
+      ranks_[node*node_keys+i] = rank++;
+    }
+    build_blocked(node*(node_keys+1)+node_keys+1, it, rank);
+  }
+
+  //! Whether the element x precedes the result of the search for key: x
+  //! before key for the lower bounds, x not after key for the upper bounds.
+  template <bool Upper, class Key>
+  bool goes_right(const T &x, const Key &key) const {
+    return Upper ? !comp_(key, x) : comp_(x, key);
+  }
+
+  //! Returns the node after descending from k, the node past the leaf
+  //! whose ones bits after the last left turn are dropped to get back to the
+  //! node found.
+  static std::size_t found_node(std::size_t k) noexcept {
+    return k >> (detail_eytzinger_index_trx::trailing_ones(k)+1);
+  }
+
+  template <bool Upper, class Key>
+  size_type search(const Key &key) const {
+    if (blocks_ != 0) {
+      size_type rank;
+      search_blocked<Upper>(&key, 1, &rank, blockable());
+      return rank;
+    }
+    const T *const keys = keys_.data();
+    const std::uintptr_t base = reinterpret_cast<std::uintptr_t>(keys);
+    std::size_t k = 1;
+    while (k <= size_) {
+      detail_eytzinger_index_trx::prefetch(
+          base+k*prefetch_stride*sizeof(T));
+      k = 2*k+static_cast<std::size_t>(goes_right<Upper>(keys[k], key));
+    }
+    return ranks_[found_node(k)];
+  }
+
+  //! Searches the m keys of a group in the blocked layout and writes their
+  //! ranks. Keys of type T go through the stree_search kernels, other ones
+  //! through comp.
+  template <bool Upper, class Key>
+  void search_blocked(const Key *keys, std::size_t m, size_type *ranks,
+                      std::true_type) const {
+    constexpr compare_op op =
+        detail_eytzinger_index_trx::blocked_op<T, Comp, Upper>::value;
+    std::size_t slots[detail_eytzinger_index_trx::stree_batch];
+    if (!std::is_same<Key, T>::value ||
+        !detail_simd_trx::stree_search<op>(
+            keys_.data(), blocks_, reinterpret_cast<const T *>(keys), m,
+            slots))
+      for (std::size_t j = 0; j != m; ++j)
+        slots[j] = blocked_slot<Upper>(keys[j]);
+    for (std::size_t j = 0; j != m; ++j)
+      ranks[j] = ranks_[slots[j]];
+  }
+
+  //! Only the blockable types are ever laid out in blocks.
+  template <bool Upper, class Key>
+  void search_blocked(const Key *, std::size_t, size_type *,
+                      std::false_type) const {}
+
+  //! Returns the slot of the blocked layout a search for key ends on,
+  //! comparing through comp.
+  template <bool Upper, class Key>
+  std::size_t blocked_slot(const Key &key) const {
+    std::size_t found = blocks_*node_keys;
+    for (std::size_t node = 0; node < blocks_;) {
+      const T *const keys = keys_.data()+node*node_keys;
+      std::size_t i = 0;
+      while (i != node_keys && goes_right<Upper>(keys[i], key))
+        ++i;
+      if (i != node_keys)
+        found = node*node_keys+i;
+      node = node*(node_keys+1)+i+1;
+    }
+    return found;
+  }
+
+  template <bool Upper, class InputIt, class OutputIt>
+  OutputIt search_all(InputIt first, InputIt last, OutputIt out) const {
+    using key_type = typename std::iterator_traits<InputIt>::value_type;
+    key_type keys[detail_eytzinger_index_trx::stree_batch];
+    size_type ranks[detail_eytzinger_index_trx::stree_batch];
+    while (first != last) {
+      std::size_t m = 0;
+      for (; m != detail_eytzinger_index_trx::stree_batch && first != last;
+           ++m, ++first)
+        keys[m] = *first;
+      search_group<Upper>(keys, m, ranks);
+      out = std::copy(ranks, ranks+m, out);
+    }
+    return out;
+  }
+
+  //! Searches the m keys of a group, interleaved level by level.
+  template <bool Upper, class Key>
+  void search_group(const Key *keys, std::size_t m, size_type *ranks) const {
+    if (blocks_ != 0) {
+      search_blocked<Upper>(keys, m, ranks, blockable());
+      return;
+    }
+    const T *const data = keys_.data();
+    const std::uintptr_t base = reinterpret_cast<std::uintptr_t>(data);
+    std::size_t k[detail_eytzinger_index_trx::stree_batch];
+    std::fill(k, k+m, 1);
+    for (bool active = size_ != 0; active;) {
+      active = false;
+      for (std::size_t j = 0; j != m; ++j) {
+        if (k[j] > size_)
+          continue;
+        k[j] = 2*k[j]+static_cast<std::size_t>(
+            goes_right<Upper>(data[k[j]], keys[j]));
+        detail_eytzinger_index_trx::prefetch(
+            base+k[j]*prefetch_stride*sizeof(T));
+        active = true;
+      }
+    }
+    for (std::size_t j = 0; j != m; ++j)
+      ranks[j] = ranks_[found_node(k[j])];
+  }
+
+  detail_eytzinger_index_trx::aligned_vector<T> keys_;
+  std::vector<Index> ranks_;
+  std::size_t size_ = 0;
+  std::size_t blocks_ = 0;
+  Comp comp_;
+};
+
+} // namespace trx
+
+#endif // _STL_EXTENSION_TRX_EYTZINGER_INDEX_H_
@@ -0,0 +1,336 @@
+#ifndef _STL_EXTENSION_TRX_INSTRUMENTATION_H_
+#define _STL_EXTENSION_TRX_INSTRUMENTATION_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+//! Set TRX_INSTRUMENTATION to 1 before including any trx header, or with
+//! -DTRX_INSTRUMENTATION=1, to have trx's sorts count what they do. It must
+//! have the same value in every translation unit of a program.
+#ifndef TRX_INSTRUMENTATION
+#define TRX_INSTRUMENTATION 0
+#endif
+
+#if TRX_INSTRUMENTATION
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#endif
+
+//! constexpr for the functions which lose it when instrumented, as their
+//! counters are thread-local: trx::sort of a std::array is only usable at
+//! compile time without instrumentation.
+#if TRX_INSTRUMENTATION
+#define TRX_INSTRUMENTED_CONSTEXPR inline
+#else
+#define TRX_INSTRUMENTED_CONSTEXPR constexpr
+#endif
+
+namespace trx {
+//! Counters of the work done by trx's sorts, when TRX_INSTRUMENTATION is 1.
+/*!
+  Counters of the work done by trx's sorts, when TRX_INSTRUMENTATION is 1:
+  the calls of trx::sort, stable_sort, sort_by, sort_each, sort_columns,
+  sort_unique and argsort, the comparator calls they make, the elements
+  moved by trx's own kernels (radix passes, merges, insertion sorts and
+  permutations, but not std::sort nor the sorting networks), the bytes of
+  scratch memory they allocate, the backends they pick and the time they
+  take.
+  Each thread counts in its own counters, which cost a plain add each; the
+  work the parallel sorts hand to a thread_pool is counted by the workers.
+  snapshot() reads the counters of the calling thread, snapshot_all() the
+  sum over all threads, those which exited included.
+  Without instrumentation, nothing is counted and the snapshots are zero.
+
+  Example
+  // built with -DTRX_INSTRUMENTATION=1
+  trx::instrumentation::reset();
+  trx::sort(records, by_timestamp);
+  const trx::instrumentation::counters counters =
+      trx::instrumentation::snapshot();
+  if (counters.last_backend == trx::instrumentation::backend::introsort &&
+      counters.comparisons > 40*records.size())
+    log_slow_sort(counters);
+*/
+namespace instrumentation {
+//! Whether the counters are maintained.
+constexpr bool enabled = TRX_INSTRUMENTATION != 0;
+
+//! The algorithms trx's sorts dispatch to.
+enum class backend : unsigned char {
+  none,         // nothing sorted yet
+  sorter,       // a specialization of trx::sorter
+  network,      // a sorting network
+  radix,        // radix_sort, for radix_sort_key types
+  introsort,    // std::sort
+  run_merge,    // merging the runs of a presorted range
+  merge_sort,   // trx's stable merge sort
+  member_sort,  // the container's sort member function
+  list_gather,  // sorting the nodes of a list through a buffer
+  parallel      // parallel_sort on a thread_pool
+};
+
+//! The number of backends.
+constexpr std::size_t backend_count =
+    static_cast<std::size_t>(backend::parallel)+1;
+
+//! A snapshot of the counters.
+struct counters {
+  //! Outermost calls of the instrumented sorts.
+  std::uint64_t calls = 0;
+  //! Comparator calls.
+  std::uint64_t comparisons = 0;
+  //! Elements moved by trx's own kernels.
+  std::uint64_t moves = 0;
+  //! Bytes of scratch memory allocated.
+  std::uint64_t scratch_bytes = 0;
+  //! Time spent in outermost calls, in TSC ticks on x86, in nanoseconds
+  //! elsewhere.
+  std::uint64_t cycles = 0;
+  //! The number of times each backend was picked, indexed by backend.
+  std::uint64_t backend_calls[backend_count] = {};
+  //! The backend picked last.
+  backend last_backend = backend::none;
+
+  //! Returns the number of times b was picked.
+  std::uint64_t uses(backend b) const noexcept {
+    return backend_calls[static_cast<std::size_t>(b)];
+  }
+
+  //! Adds the counters of other, whose last backend is kept if it is set.
+  counters &operator+=(const counters &other) noexcept {
+    calls += other.calls;
+    comparisons += other.comparisons;
+    moves += other.moves;
+    scratch_bytes += other.scratch_bytes;
+    cycles += other.cycles;
+    for (std::size_t i = 0; i != backend_count; ++i)
+      backend_calls[i] += other.backend_calls[i];
+    if (other.last_backend != backend::none)
+      last_backend = other.last_backend;
+    return *this;
+  }
+};
+
+} // namespace instrumentation
+
+//! Helper function/class templates for the current header.
+namespace detail_instrumentation_trx {
+#if TRX_INSTRUMENTATION
+//! The counters of a thread, written by their thread only and read by any.
+//! The writes are a relaxed load and store, which are plain instructions.
+struct thread_counters {
+  enum field { calls, comparisons, moves, scratch_bytes, cycles, fields };
+
+  void add(field f, std::uint64_t n) noexcept {
+    values[f].store(values[f].load(std::memory_order_relaxed)+n,
+                    std::memory_order_relaxed);
+  }
+
+  void note(instrumentation::backend b) noexcept {
+    std::atomic<std::uint64_t> &uses = backend_calls[static_cast<int>(b)];
+    uses.store(uses.load(std::memory_order_relaxed)+1,
+               std::memory_order_relaxed);
+    last.store(b, std::memory_order_relaxed);
+  }
+
+  instrumentation::counters load() const noexcept {
+    instrumentation::counters result;
+    result.calls = values[calls].load(std::memory_order_relaxed);
+    result.comparisons = values[comparisons].load(std::memory_order_relaxed);
+    result.moves = values[moves].load(std::memory_order_relaxed);
+    result.scratch_bytes =
+        values[scratch_bytes].load(std::memory_order_relaxed);
+    result.cycles = values[cycles].load(std::memory_order_relaxed);
+    for (std::size_t i = 0; i != instrumentation::backend_count; ++i)
+      result.backend_calls[i] =
+          backend_calls[i].load(std::memory_order_relaxed);
+    result.last_backend = last.load(std::memory_order_relaxed);
+    return result;
+  }
+
+  void reset() noexcept {
+    for (auto &value : values)
+      value.store(0, std::memory_order_relaxed);
+    for (auto &uses : backend_calls)
+      uses.store(0, std::memory_order_relaxed);
+    last.store(instrumentation::backend::none, std::memory_order_relaxed);
+  }
+
+  std::atomic<std::uint64_t> values[fields] = {};
+  std::atomic<std::uint64_t> backend_calls[instrumentation::backend_count] =
+      {};
+  std::atomic<instrumentation::backend> last{instrumentation::backend::none};
+  //! The depth of the instrumented calls in progress.
+  unsigned depth = 0;
+};
+
+//! The counters of the live threads, and the sum of those of the threads
+//! which exited.
+struct registry {
+  std::mutex mutex;
+  std::vector<const thread_counters *> live;
+  instrumentation::counters retired;
+
+  static registry &get() {
+    static registry instance;
+    return instance;
+  }
+};
+
+//! The counters of a thread, registered while the thread lives.
+struct registered_counters {
+  registered_counters() {
+    registry &all = registry::get();
+    std::lock_guard<std::mutex> lock(all.mutex);
+    all.live.push_back(&counters);
+  }
+
+  ~registered_counters() {
+    registry &all = registry::get();
+    std::lock_guard<std::mutex> lock(all.mutex);
+    all.retired += counters.load();
+    for (auto &entry : all.live)
+      if (entry == &counters) {
+        entry = all.live.back();
+        all.live.pop_back();
+        break;
+      }
+  }
+
+  thread_counters counters;
+};
+
+//! Returns the counters of the calling thread.
+inline thread_counters &local() {
+  static thread_local registered_counters mine;
+  return mine.counters;
+}
+
+//! Returns a timestamp in TSC ticks on x86, in nanoseconds elsewhere.
+inline std::uint64_t timestamp() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+//! Counts a call of an instrumented sort and its duration, unless made from
+//! inside another one.
+class call_scope {
+public:
+  call_scope() : counters_(local()) {
+    if (counters_.depth++ == 0)
+      start_ = timestamp();
+  }
+
+  call_scope(const call_scope &) = delete;
+  call_scope &operator=(const call_scope &) = delete;
+
+  ~call_scope() {
+    if (--counters_.depth == 0) {
+      counters_.add(thread_counters::calls, 1);
+      counters_.add(thread_counters::cycles, timestamp()-start_);
+    }
+  }
+
+private:
+  thread_counters &counters_;
+  std::uint64_t start_ = 0;
+};
+
+//! A comparator counting its calls before forwarding them to comp.
+template <class Comp>
+struct counting_compare {
+  Comp &comp;
+
+  template <class T, class U>
+  bool operator()(T &&lhs, U &&rhs) const {
+    local().add(thread_counters::comparisons, 1);
+    return comp(std::forward<T>(lhs), std::forward<U>(rhs));
+  }
+};
+
+//! Returns comp wrapped in a counting_compare.
+template <class Comp>
+inline counting_compare<Comp> counted(Comp &comp) noexcept {
+  return {comp};
+}
+
+inline void count_moves(std::uint64_t n) noexcept {
+  local().add(thread_counters::moves, n);
+}
+
+inline void count_scratch_bytes(std::uint64_t n) noexcept {
+  local().add(thread_counters::scratch_bytes, n);
+}
+
+inline void note_backend(instrumentation::backend b) noexcept {
+  local().note(b);
+}
+#else
+//! Without instrumentation, a scope doing nothing.
+struct call_scope {
+  constexpr call_scope() noexcept {}
+};
+
+//! Without instrumentation, comp itself.
+template <class Comp>
+constexpr Comp &counted(Comp &comp) noexcept {
+  return comp;
+}
+
+constexpr void count_moves(std::uint64_t) noexcept {}
+
+constexpr void count_scratch_bytes(std::uint64_t) noexcept {}
+
+constexpr void note_backend(instrumentation::backend) noexcept {}
+#endif
+
+} // namespace detail_instrumentation_trx
+
+namespace instrumentation {
+//! Returns the counters of the calling thread.
+inline counters snapshot() {
+#if TRX_INSTRUMENTATION
+  return detail_instrumentation_trx::local().load();
+#else
+  return counters();
+#endif
+}
+
+//! Returns the sum of the counters of all threads, including those which
+//! exited. The last backend is that of an arbitrary thread.
+inline counters snapshot_all() {
+#if TRX_INSTRUMENTATION
+  using detail_instrumentation_trx::registry;
+  registry &all = registry::get();
+  std::lock_guard<std::mutex> lock(all.mutex);
+  counters result = all.retired;
+  for (const auto *thread : all.live)
+    result += thread->load();
+  return result;
+#else
+  return counters();
+#endif
+}
+
+//! Sets the counters of the calling thread to zero.
+inline void reset() {
+#if TRX_INSTRUMENTATION
+  detail_instrumentation_trx::local().reset();
+#endif
+}
+
+} // namespace instrumentation
+
+} // namespace trx
+
+#endif // _STL_EXTENSION_TRX_INSTRUMENTATION_H_
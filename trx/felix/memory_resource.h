@@ -0,0 +1,390 @@
+#ifndef _STL_EXTENSION_TRX_MEMORY_RESOURCE_H_
+#define _STL_EXTENSION_TRX_MEMORY_RESOURCE_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+#include "instrumentation.h"
+
+#if __cplusplus >= 201703L && defined(__has_include)
+#if __has_include(<memory_resource>)
+#include <memory_resource>
+#endif
+#endif
+
+namespace trx {
+//! The memory resources trx's scratch buffers are taken from. Since C++17,
+//! these are the ones of std::pmr, so that any std::pmr::memory_resource
+//! can be given to trx's algorithms; before, a minimal equivalent.
+namespace pmr {
+#if defined(__cpp_lib_memory_resource)
+using std::pmr::memory_resource;
+using std::pmr::new_delete_resource;
+#else
+//! Interface of the classes handing out memory, like std::pmr's.
+class memory_resource {
+public:
+  virtual ~memory_resource() = default;
+
+  void *allocate(std::size_t bytes,
+                 std::size_t alignment = alignof(std::max_align_t)) {
+    return do_allocate(bytes, alignment);
+  }
+
+  void deallocate(void *p, std::size_t bytes,
+                  std::size_t alignment = alignof(std::max_align_t)) {
+    do_deallocate(p, bytes, alignment);
+  }
+
+  bool is_equal(const memory_resource &other) const noexcept {
+    return do_is_equal(other);
+  }
+
+private:
+  virtual void *do_allocate(std::size_t bytes, std::size_t alignment) = 0;
+  virtual void do_deallocate(void *p, std::size_t bytes,
+                             std::size_t alignment) = 0;
+  virtual bool do_is_equal(const memory_resource &other) const noexcept = 0;
+};
+
+inline bool operator==(const memory_resource &lhs,
+                       const memory_resource &rhs) noexcept {
+  return &lhs == &rhs || lhs.is_equal(rhs);
+}
+
+inline bool operator!=(const memory_resource &lhs,
+                       const memory_resource &rhs) noexcept {
+  return !(lhs == rhs);
+}
+
+//! Helper function/class templates for the current header.
+namespace detail_memory_resource_trx {
+//! The resource of new_delete_resource(). Over-aligned blocks are carved out
+//! of a larger one, whose address is stored right before them.
+class new_delete_resource_type : public memory_resource {
+  void *do_allocate(std::size_t bytes, std::size_t alignment) override {
+    if (alignment <= alignof(std::max_align_t))
+      return ::operator new(bytes);
+    void *const block = ::operator new(bytes+alignment+sizeof(void *));
+    std::uintptr_t p = reinterpret_cast<std::uintptr_t>(block)+sizeof(void *);
+    p = (p+alignment-1) & ~std::uintptr_t(alignment-1);
+    reinterpret_cast<void **>(p)[-1] = block;
+    return reinterpret_cast<void *>(p);
+  }
+
+  void do_deallocate(void *p, std::size_t, std::size_t alignment) override {
+    if (alignment <= alignof(std::max_align_t))
+      ::operator delete(p);
+    else
+      ::operator delete(static_cast<void **>(p)[-1]);
+  }
+
+  bool do_is_equal(const memory_resource &other) const noexcept override {
+    return this == &other;
+  }
+};
+
+} // namespace detail_memory_resource_trx
+
+//! Returns the resource calling the global operator new and operator delete.
+inline memory_resource *new_delete_resource() noexcept {
+  static detail_memory_resource_trx::new_delete_resource_type resource;
+  return &resource;
+}
+#endif // defined(__cpp_lib_memory_resource)
+
+} // namespace pmr
+
+//! A monotonic arena rewound whenever all its memory has been given back.
+/*!
+  A monotonic arena rewound whenever all its memory has been given back.
+  Blocks are carved one after the other out of chunks taken from the
+  upstream resource, and their deallocation only counts them, except for
+  the last block carved, whose memory is reused at once. When the count drops
+  to zero, the arena starts over from its first byte; if it had to take
+  several chunks, they are replaced by a single one as large as all of them.
+  So, repeating a computation whose blocks are all given back at its end,
+  like one of trx's algorithms, allocates from upstream during the first
+  repetitions only.
+  The arena is not thread-safe: use one per thread, like
+  thread_scratch_arena(), or trx::thread_scratch with the parallel policies.
+
+  Example
+  trx::scratch_arena arena;
+  std::vector<int> vtr{9,1,3,4,2};
+  for (int i = 0; i != 1000; ++i)
+    trx::stable_sort(vtr, std::less<>(), trx::scratch_from(&arena));
+*/
+class scratch_arena : public pmr::memory_resource {
+public:
+  //! Creates an arena taking its chunks from upstream, the first one of
+  //! initial_bytes if not zero.
+  explicit scratch_arena(
+      std::size_t initial_bytes = 0,
+      pmr::memory_resource *upstream = pmr::new_delete_resource())
+      : upstream_(upstream) {
+    if (initial_bytes != 0)
+      add_chunk(initial_bytes);
+  }
+
+  scratch_arena(const scratch_arena &) = delete;
+  scratch_arena &operator=(const scratch_arena &) = delete;
+
+  ~scratch_arena() override { free_chunks(); }
+
+  //! Returns the number of bytes taken from upstream.
+  std::size_t capacity() const noexcept { return capacity_; }
+
+  //! Returns the number of blocks allocated and not given back yet.
+  std::size_t live_blocks() const noexcept { return live_; }
+
+  //! Gives every chunk back to upstream. No block may be alive.
+  void release() noexcept {
+    free_chunks();
+    cursor_ = end_ = nullptr;
+  }
+
+private:
+  //! Header of a chunk, which is followed by its blocks.
+  struct chunk {
+    chunk *next;
+    std::size_t bytes;
+  };
+
+  void *do_allocate(std::size_t bytes, std::size_t alignment) override {
+    void *p = carve(bytes, alignment);
+    if (p == nullptr) {
+      const std::size_t last = head_ != nullptr ? head_->bytes : 0;
+      add_chunk(std::max(2*last, bytes+alignment));
+      p = carve(bytes, alignment);
+    }
+    ++live_;
+    return p;
+  }
+
+  void do_deallocate(void *p, std::size_t bytes, std::size_t) override {
+    if (static_cast<char *>(p)+bytes == cursor_)
+      cursor_ = static_cast<char *>(p);
+    if (--live_ == 0)
+      rewind();
+  }
+
+  bool do_is_equal(const pmr::memory_resource &other) const noexcept
+      override {
+    return this == &other;
+  }
+
+  //! Returns bytes from the current chunk aligned as given, nullptr if they
+  //! do not fit.
+  void *carve(std::size_t bytes, std::size_t alignment) noexcept {
+    if (cursor_ == nullptr)
+      return nullptr;
+    const std::uintptr_t p =
+        (reinterpret_cast<std::uintptr_t>(cursor_)+alignment-1) &
+        ~std::uintptr_t(alignment-1);
+    if (p > reinterpret_cast<std::uintptr_t>(end_) ||
+        bytes > reinterpret_cast<std::uintptr_t>(end_)-p)
+      return nullptr;
+    cursor_ = reinterpret_cast<char *>(p)+bytes;
+    return reinterpret_cast<void *>(p);
+  }
+
+  //! Takes a chunk of at least bytes, and at least 64KiB, from upstream.
+  void add_chunk(std::size_t bytes) {
+    if (bytes < (std::size_t(1) << 16))
+      bytes = std::size_t(1) << 16;
+    chunk *const added = static_cast<chunk *>(
+        upstream_->allocate(sizeof(chunk)+bytes, alignof(std::max_align_t)));
+    added->next = head_;
+    added->bytes = bytes;
+    head_ = added;
+    capacity_ += bytes;
+    cursor_ = reinterpret_cast<char *>(added+1);
+    end_ = cursor_+bytes;
+  }
+
+  void free_chunks() noexcept {
+    while (head_ != nullptr) {
+      chunk *const next = head_->next;
+      upstream_->deallocate(head_, sizeof(chunk)+head_->bytes,
+                            alignof(std::max_align_t));
+      head_ = next;
+    }
+    capacity_ = 0;
+  }
+
+  //! Starts over from the first byte, in a single chunk.
+  void rewind() {
+    if (head_ == nullptr)
+      return;
+    if (head_->next != nullptr) {
+      const std::size_t total = capacity_;
+      free_chunks();
+      add_chunk(total);
+    }
+    cursor_ = reinterpret_cast<char *>(head_+1);
+  }
+
+  pmr::memory_resource *upstream_;
+  chunk *head_ = nullptr;
+  char *cursor_ = nullptr;
+  char *end_ = nullptr;
+  std::size_t capacity_ = 0;
+  std::size_t live_ = 0;
+};
+
+//! Returns the scratch_arena of the calling thread.
+inline scratch_arena &thread_scratch_arena() {
+  static thread_local scratch_arena arena;
+  return arena;
+}
+
+//! Tag giving a trx algorithm the memory resource of its scratch buffers.
+/*!
+  Tag giving a trx algorithm the memory resource of its scratch buffers,
+  see scratch_from(resource) and thread_scratch. The parallel algorithms
+  allocate from every thread of their pool, so that their resource must be
+  thread-safe, like std::pmr::synchronized_pool_resource; thread_scratch
+  lets each thread allocate from its own thread_scratch_arena().
+*/
+struct scratch_t {
+  pmr::memory_resource *resource;
+};
+
+//! Selects each thread's thread_scratch_arena() for the scratch buffers.
+constexpr scratch_t thread_scratch{nullptr};
+
+//! Returns a scratch_t taking the scratch buffers from resource.
+inline scratch_t scratch_from(pmr::memory_resource *resource) noexcept {
+  return scratch_t{resource};
+}
+
+//! Helper function/class templates for the current header.
+namespace detail_memory_resource_trx {
+//! Where trx's algorithms take their scratch buffers from in the calling
+//! thread: nowhere special unless installed is set, in which case resource,
+//! or the thread's arena if resource is nullptr.
+struct scratch_setting {
+  bool installed = false;
+  pmr::memory_resource *resource = nullptr;
+};
+
+inline scratch_setting &current_scratch_setting() noexcept {
+  static thread_local scratch_setting setting;
+  return setting;
+}
+
+//! Returns the resource installed for the calling thread's scratch buffers,
+//! nullptr if none is.
+inline pmr::memory_resource *current_scratch_resource() {
+  const scratch_setting &setting = current_scratch_setting();
+  if (!setting.installed)
+    return nullptr;
+  return setting.resource != nullptr ? setting.resource
+                                     : &thread_scratch_arena();
+}
+
+//! Installs a scratch setting for the calling thread until destroyed.
+class scratch_scope {
+public:
+  explicit scratch_scope(const scratch_setting &setting) noexcept
+      : saved_(current_scratch_setting()) {
+    current_scratch_setting() = setting;
+  }
+
+  explicit scratch_scope(const scratch_t &tag) noexcept
+      : scratch_scope(scratch_setting{true, tag.resource}) {}
+
+  scratch_scope(const scratch_scope &) = delete;
+  scratch_scope &operator=(const scratch_scope &) = delete;
+
+  ~scratch_scope() { current_scratch_setting() = saved_; }
+
+private:
+  scratch_setting saved_;
+};
+
+} // namespace detail_memory_resource_trx
+
+//! Allocator drawing from a memory resource, by default the one installed
+//! for trx's scratch buffers.
+/*!
+  Allocator drawing from a memory resource. A default constructed
+  scratch_allocator draws from the resource given to the trx algorithm
+  running in the calling thread, or from new_delete_resource() outside of
+  one. Unlike std::pmr::polymorphic_allocator, the resource follows the
+  containers when they are move assigned or swapped.
+
+  Example
+  trx::scratch_arena arena;
+  std::list<int> lst{9,1,3,4,2};
+  trx::sort(lst, std::less<>(),
+            trx::list_gather_with(trx::scratch_allocator<int>(&arena)));
+*/
+template <class T>
+class scratch_allocator {
+public:
+  using value_type = T;
+  using propagate_on_container_copy_assignment = std::false_type;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+
+  scratch_allocator()
+      : resource_(detail_memory_resource_trx::current_scratch_resource()) {
+    if (resource_ == nullptr)
+      resource_ = pmr::new_delete_resource();
+  }
+
+  scratch_allocator(pmr::memory_resource *resource) noexcept
+      : resource_(resource) {}
+
+  template <class U>
+  scratch_allocator(const scratch_allocator<U> &other) noexcept
+      : resource_(other.resource()) {}
+
+  T *allocate(std::size_t n) {
+    if (n > std::numeric_limits<std::size_t>::max()/sizeof(T))
+      throw std::bad_array_new_length();
+    detail_instrumentation_trx::count_scratch_bytes(n*sizeof(T));
+    return static_cast<T *>(resource_->allocate(n*sizeof(T), alignof(T)));
+  }
+
+  void deallocate(T *p, std::size_t n) noexcept {
+    resource_->deallocate(p, n*sizeof(T), alignof(T));
+  }
+
+  //! Copies of the containers take their memory from the current resource.
+  scratch_allocator select_on_container_copy_construction() const {
+    return scratch_allocator();
+  }
+
+  pmr::memory_resource *resource() const noexcept { return resource_; }
+
+private:
+  pmr::memory_resource *resource_;
+};
+
+template <class T, class U>
+inline bool operator==(const scratch_allocator<T> &lhs,
+                       const scratch_allocator<U> &rhs) noexcept {
+  return *lhs.resource() == *rhs.resource();
+}
+
+template <class T, class U>
+inline bool operator!=(const scratch_allocator<T> &lhs,
+                       const scratch_allocator<U> &rhs) noexcept {
+  return !(lhs == rhs);
+}
+
+//! A std::vector drawing from the resource of trx's scratch buffers.
+template <class T>
+using scratch_vector = std::vector<T, scratch_allocator<T> >;
+
+} // namespace trx
+
+#endif // _STL_EXTENSION_TRX_MEMORY_RESOURCE_H_
@@ -0,0 +1,726 @@
+#ifndef _STL_EXTENSION_TRX_RANGES_H_
+#define _STL_EXTENSION_TRX_RANGES_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "algorithm.h"
+
+namespace trx {
+//! Helper function/class templates for the current header.
+namespace detail_ranges_trx {
+using detail_algorithm_trx::adl_begin;
+using detail_algorithm_trx::adl_end;
+
+//! The iterator of Range, or of const Range.
+template <class Range>
+using iterator_of = decltype(adl_begin(std::declval<Range &>()));
+
+//! The category of It, capped at Cap.
+template <class It, class Cap>
+using capped_category = std::conditional_t<
+    std::is_base_of<Cap, typename std::iterator_traits<It>::iterator_category
+                    >::value,
+    Cap, typename std::iterator_traits<It>::iterator_category>;
+
+//! The weakest of the given iterator categories.
+template <class... Categories>
+struct weakest_category;
+
+template <class Category>
+struct weakest_category<Category> {
+  using type = Category;
+};
+
+template <class Category, class... Categories>
+struct weakest_category<Category, Categories...> {
+  using rest = typename weakest_category<Categories...>::type;
+  using type = std::conditional_t<std::is_base_of<Category, rest>::value,
+                                  Category, rest>;
+};
+
+//! Returns the end of the first n elements of [first, last), in O(1) for
+//! random access iterators.
+template <class It>
+It advance_bounded(It first, It last, std::size_t n,
+                   std::random_access_iterator_tag) {
+  const std::size_t size = std::distance(first, last);
+  return first+std::min(n, size);
+}
+
+template <class It>
+It advance_bounded(It first, It last, std::size_t n,
+                   std::input_iterator_tag) {
+  for (; n != 0 && first != last; --n)
+    ++first;
+  return first;
+}
+
+} // namespace detail_ranges_trx
+
+//! Iterator over the elements of [base, end) satisfying a predicate.
+/*!
+  Iterator over the elements of a range satisfying a predicate, which is
+  called by const reference. At most bidirectional, the iterator steps over
+  the elements rejected by the predicate when incremented or decremented.
+*/
+template <class It, class Pred>
+class filter_iterator {
+public:
+  using iterator_category =
+      detail_ranges_trx::capped_category<It, std::bidirectional_iterator_tag>;
+  using value_type = typename std::iterator_traits<It>::value_type;
+  using difference_type = typename std::iterator_traits<It>::difference_type;
+  using pointer = typename std::iterator_traits<It>::pointer;
+  using reference = typename std::iterator_traits<It>::reference;
+
+  filter_iterator() = default;
+
+  //! Points to the first element of [current, end) satisfying pred.
+  filter_iterator(It current, It end, const Pred &pred)
+      : current_(current), end_(end), pred_(std::addressof(pred)) {
+    skip();
+  }
+
+  reference operator*() const { return *current_; }
+
+  pointer operator->() const { return std::addressof(*current_); }
+
+  filter_iterator &operator++() {
+    ++current_;
+    skip();
+    return *this;
+  }
+
+  filter_iterator operator++(int) {
+    filter_iterator old = *this;
+    ++*this;
+    return old;
+  }
+
+  //! Steps back to the previous element satisfying the predicate, which
+  //! must exist.
+  filter_iterator &operator--() {
+    do
+      --current_;
+    while (!(*pred_)(*current_));
+    return *this;
+  }
+
+  filter_iterator operator--(int) {
+    filter_iterator old = *this;
+    --*this;
+    return old;
+  }
+
+  //! Returns the underlying iterator.
+  const It &base() const noexcept { return current_; }
+
+  //! Returns the end of the underlying range.
+  const It &base_end() const noexcept { return end_; }
+
+  const Pred &predicate() const noexcept { return *pred_; }
+
+  friend bool operator==(const filter_iterator &lhs,
+                         const filter_iterator &rhs) {
+    return lhs.current_ == rhs.current_;
+  }
+
+  friend bool operator!=(const filter_iterator &lhs,
+                         const filter_iterator &rhs) {
+    return !(lhs == rhs);
+  }
+
+private:
+  void skip() {
+    while (current_ != end_ && !(*pred_)(*current_))
+      ++current_;
+  }
+
+  It current_{}, end_{};
+  const Pred *pred_ = nullptr;
+};
+
+//! Iterator yielding fn(element) for the elements of a range.
+/*!
+  Iterator yielding fn(element) for the elements of a range, computed on
+  each dereference. It has the category of the underlying iterator, capped
+  at random access, and its reference is the result of fn.
+*/
+template <class It, class Fn>
+class transform_iterator {
+public:
+  using iterator_category =
+      detail_ranges_trx::capped_category<It, std::random_access_iterator_tag>;
+  using reference = decltype(std::declval<const Fn &>()(
+      *std::declval<const It &>()));
+  using value_type = std::remove_cv_t<std::remove_reference_t<reference> >;
+  using difference_type = typename std::iterator_traits<It>::difference_type;
+  using pointer = void;
+
+  transform_iterator() = default;
+
+  transform_iterator(It current, const Fn &fn)
+      : current_(current), fn_(std::addressof(fn)) {}
+
+  reference operator*() const { return (*fn_)(*current_); }
+
+  reference operator[](difference_type n) const {
+    return (*fn_)(current_[n]);
+  }
+
+  transform_iterator &operator++() {
+    ++current_;
+    return *this;
+  }
+
+  transform_iterator operator++(int) {
+    transform_iterator old = *this;
+    ++current_;
+    return old;
+  }
+
+  transform_iterator &operator--() {
+    --current_;
+    return *this;
+  }
+
+  transform_iterator operator--(int) {
+    transform_iterator old = *this;
+    --current_;
+    return old;
+  }
+
+  transform_iterator &operator+=(difference_type n) {
+    current_ += n;
+    return *this;
+  }
+
+  transform_iterator &operator-=(difference_type n) {
+    current_ -= n;
+    return *this;
+  }
+
+  friend transform_iterator operator+(transform_iterator it,
+                                      difference_type n) {
+    return it += n;
+  }
+
+  friend transform_iterator operator+(difference_type n,
+                                      transform_iterator it) {
+    return it += n;
+  }
+
+  friend transform_iterator operator-(transform_iterator it,
+                                      difference_type n) {
+    return it -= n;
+  }
+
+  friend difference_type operator-(const transform_iterator &lhs,
+                                   const transform_iterator &rhs) {
+    return lhs.current_-rhs.current_;
+  }
+
+  //! Returns the underlying iterator.
+  const It &base() const noexcept { return current_; }
+
+  friend bool operator==(const transform_iterator &lhs,
+                         const transform_iterator &rhs) {
+    return lhs.current_ == rhs.current_;
+  }
+
+  friend bool operator!=(const transform_iterator &lhs,
+                         const transform_iterator &rhs) {
+    return !(lhs == rhs);
+  }
+
+  friend bool operator<(const transform_iterator &lhs,
+                        const transform_iterator &rhs) {
+    return lhs.current_ < rhs.current_;
+  }
+
+  friend bool operator>(const transform_iterator &lhs,
+                        const transform_iterator &rhs) {
+    return rhs < lhs;
+  }
+
+  friend bool operator<=(const transform_iterator &lhs,
+                         const transform_iterator &rhs) {
+    return !(rhs < lhs);
+  }
+
+  friend bool operator>=(const transform_iterator &lhs,
+                         const transform_iterator &rhs) {
+    return !(lhs < rhs);
+  }
+
+private:
+  It current_{};
+  const Fn *fn_ = nullptr;
+};
+
+//! Iterator over tuples of the elements at the same position of several
+//! ranges.
+/*!
+  Iterator over tuples of the elements at the same position of several
+  ranges. Its reference is a std::tuple of the references of the underlying
+  iterators, its category the weakest of theirs, capped at random access.
+  Two zip_iterators compare equal when any of their underlying iterators
+  do, so that zipping stops at the end of the shortest range.
+*/
+template <class... Its>
+class zip_iterator {
+public:
+  using iterator_category = typename detail_ranges_trx::weakest_category<
+      detail_ranges_trx::capped_category<
+          Its, std::random_access_iterator_tag>...>::type;
+  using reference =
+      std::tuple<typename std::iterator_traits<Its>::reference...>;
+  using value_type =
+      std::tuple<typename std::iterator_traits<Its>::value_type...>;
+  using difference_type = std::common_type_t<
+      typename std::iterator_traits<Its>::difference_type...>;
+  using pointer = void;
+
+  zip_iterator() = default;
+
+  explicit zip_iterator(Its... currents) : currents_(currents...) {}
+
+  reference operator*() const {
+    return dereference(std::index_sequence_for<Its...>());
+  }
+
+  reference operator[](difference_type n) const { return *(*this+n); }
+
+  zip_iterator &operator++() {
+    for_each([](auto &it) { ++it; });
+    return *this;
+  }
+
+  zip_iterator operator++(int) {
+    zip_iterator old = *this;
+    ++*this;
+    return old;
+  }
+
+  zip_iterator &operator--() {
+    for_each([](auto &it) { --it; });
+    return *this;
+  }
+
+  zip_iterator operator--(int) {
+    zip_iterator old = *this;
+    --*this;
+    return old;
+  }
+
+  zip_iterator &operator+=(difference_type n) {
+    for_each([n](auto &it) { it += n; });
+    return *this;
+  }
+
+  zip_iterator &operator-=(difference_type n) {
+    for_each([n](auto &it) { it -= n; });
+    return *this;
+  }
+
+  friend zip_iterator operator+(zip_iterator it, difference_type n) {
+    return it += n;
+  }
+
+  friend zip_iterator operator+(difference_type n, zip_iterator it) {
+    return it += n;
+  }
+
+  friend zip_iterator operator-(zip_iterator it, difference_type n) {
+    return it -= n;
+  }
+
+  //! The smallest distance between the underlying iterators.
+  friend difference_type operator-(const zip_iterator &lhs,
+                                   const zip_iterator &rhs) {
+    return lhs.distance(rhs, std::index_sequence_for<Its...>());
+  }
+
+  //! Returns the underlying iterators.
+  const std::tuple<Its...> &base() const noexcept { return currents_; }
+
+  friend bool operator==(const zip_iterator &lhs, const zip_iterator &rhs) {
+    return lhs.any_equal(rhs, std::index_sequence_for<Its...>());
+  }
+
+  friend bool operator!=(const zip_iterator &lhs, const zip_iterator &rhs) {
+    return !(lhs == rhs);
+  }
+
+  friend bool operator<(const zip_iterator &lhs, const zip_iterator &rhs) {
+    return lhs-rhs < 0;
+  }
+
+  friend bool operator>(const zip_iterator &lhs, const zip_iterator &rhs) {
+    return rhs < lhs;
+  }
+
+  friend bool operator<=(const zip_iterator &lhs, const zip_iterator &rhs) {
+    return !(rhs < lhs);
+  }
+
+  friend bool operator>=(const zip_iterator &lhs, const zip_iterator &rhs) {
+    return !(lhs < rhs);
+  }
+
+private:
+  template <std::size_t... I>
+  reference dereference(std::index_sequence<I...>) const {
+    return reference(*std::get<I>(currents_)...);
+  }
+
+  template <class Fn, std::size_t... I>
+  void for_each(Fn fn, std::index_sequence<I...>) {
+    const int expand[] = {0, (fn(std::get<I>(currents_)), 0)...};
+    (void)expand;
+  }
+
+  template <class Fn>
+  void for_each(Fn fn) {
+    for_each(fn, std::index_sequence_for<Its...>());
+  }
+
+  template <std::size_t... I>
+  bool any_equal(const zip_iterator &other, std::index_sequence<I...>) const {
+    const bool equal[] = {false, (std::get<I>(currents_) ==
+                                  std::get<I>(other.currents_))...};
+    return std::find(std::begin(equal), std::end(equal), true) !=
+           std::end(equal);
+  }
+
+  template <std::size_t... I>
+  difference_type distance(const zip_iterator &other,
+                           std::index_sequence<I...>) const {
+    const difference_type distances[] = {static_cast<difference_type>(
+        std::get<I>(currents_)-std::get<I>(other.currents_))...};
+    return *std::min_element(std::begin(distances), std::end(distances),
+                             [](difference_type lhs, difference_type rhs) {
+      return (lhs < 0 ? -lhs : lhs) < (rhs < 0 ? -rhs : rhs);
+    });
+  }
+
+  std::tuple<Its...> currents_;
+};
+
+//! A lazy view of the elements of a range satisfying a predicate.
+/*!
+  A lazy view of the elements of a range satisfying a predicate. The range
+  is referred to if it is an lvalue, moved into the view otherwise. Finding
+  begin() walks the range up to its first element satisfying pred, on each
+  call. See views::filter.
+*/
+template <class Range, class Pred>
+class filter_view {
+public:
+  filter_view(Range &&range, Pred pred)
+      : range_(std::forward<Range>(range)), pred_(std::move(pred)) {}
+
+  auto begin() {
+    using iterator = filter_iterator<
+        detail_ranges_trx::iterator_of<std::remove_reference_t<Range> >,
+        Pred>;
+    return iterator(detail_ranges_trx::adl_begin(range_),
+                    detail_ranges_trx::adl_end(range_), pred_);
+  }
+
+  auto end() {
+    using iterator = filter_iterator<
+        detail_ranges_trx::iterator_of<std::remove_reference_t<Range> >,
+        Pred>;
+    return iterator(detail_ranges_trx::adl_end(range_),
+                    detail_ranges_trx::adl_end(range_), pred_);
+  }
+
+  auto begin() const {
+    using iterator = filter_iterator<detail_ranges_trx::iterator_of<
+        const std::remove_reference_t<Range> >, Pred>;
+    return iterator(detail_ranges_trx::adl_begin(as_const()),
+                    detail_ranges_trx::adl_end(as_const()), pred_);
+  }
+
+  auto end() const {
+    using iterator = filter_iterator<detail_ranges_trx::iterator_of<
+        const std::remove_reference_t<Range> >, Pred>;
+    return iterator(detail_ranges_trx::adl_end(as_const()),
+                    detail_ranges_trx::adl_end(as_const()), pred_);
+  }
+
+private:
+  const std::remove_reference_t<Range> &as_const() const noexcept {
+    return range_;
+  }
+
+  Range range_;
+  Pred pred_;
+};
+
+//! A lazy view of fn(element) for the elements of a range.
+/*!
+  A lazy view of fn(element) for the elements of a range, computed on each
+  access. Its iterators have the category of the range's, capped at random
+  access. See views::transform.
+*/
+template <class Range, class Fn>
+class transform_view {
+public:
+  transform_view(Range &&range, Fn fn)
+      : range_(std::forward<Range>(range)), fn_(std::move(fn)) {}
+
+  auto begin() { return make(detail_ranges_trx::adl_begin(range_)); }
+
+  auto end() { return make(detail_ranges_trx::adl_end(range_)); }
+
+  auto begin() const { return make(detail_ranges_trx::adl_begin(as_const())); }
+
+  auto end() const { return make(detail_ranges_trx::adl_end(as_const())); }
+
+private:
+  template <class It>
+  transform_iterator<It, Fn> make(It it) const {
+    return transform_iterator<It, Fn>(it, fn_);
+  }
+
+  const std::remove_reference_t<Range> &as_const() const noexcept {
+    return range_;
+  }
+
+  Range range_;
+  Fn fn_;
+};
+
+//! A view of the first n elements of a range.
+/*!
+  A view of the first n elements of a range, or all of them if it has less.
+  Its iterators are those of the range, so that it keeps their category:
+  trx::sort sorts the prefix in place, and trx::best_if searches contiguous
+  prefixes through its SIMD kernels. Finding end() takes O(1) for random
+  access ranges, O(n) otherwise. See views::take.
+*/
+template <class Range>
+class take_view {
+public:
+  take_view(Range &&range, std::size_t count)
+      : range_(std::forward<Range>(range)), count_(count) {}
+
+  auto begin() { return detail_ranges_trx::adl_begin(range_); }
+
+  auto end() { return bounded_end(range_); }
+
+  auto begin() const { return detail_ranges_trx::adl_begin(as_const()); }
+
+  auto end() const { return bounded_end(as_const()); }
+
+  //! Returns the number of elements of the view.
+  std::size_t size() const {
+    return std::distance(begin(), end());
+  }
+
+private:
+  template <class R>
+  auto bounded_end(R &range) const {
+    using iterator = detail_ranges_trx::iterator_of<R>;
+    return detail_ranges_trx::advance_bounded(
+        detail_ranges_trx::adl_begin(range), detail_ranges_trx::adl_end(range),
+        count_, typename std::iterator_traits<iterator>::iterator_category());
+  }
+
+  const std::remove_reference_t<Range> &as_const() const noexcept {
+    return range_;
+  }
+
+  Range range_;
+  std::size_t count_;
+};
+
+//! A lazy view of tuples of the elements at the same position of several
+//! ranges.
+/*!
+  A lazy view of tuples of the elements at the same position of several
+  ranges, as long as the shortest one. Its elements are std::tuples of
+  references to those of the ranges. See views::zip.
+*/
+template <class... Ranges>
+class zip_view {
+public:
+  explicit zip_view(Ranges &&... ranges)
+      : ranges_(std::forward<Ranges>(ranges)...) {}
+
+  auto begin() { return begin(ranges_, std::index_sequence_for<Ranges...>()); }
+
+  auto end() { return end(ranges_, std::index_sequence_for<Ranges...>()); }
+
+  auto begin() const {
+    return begin(ranges_, std::index_sequence_for<Ranges...>());
+  }
+
+  auto end() const {
+    return end(ranges_, std::index_sequence_for<Ranges...>());
+  }
+
+private:
+  //! Random access ranges end at the length of the shortest one, so that
+  //! the iterators can be subtracted.
+  using random_access = std::integral_constant<bool,
+      std::is_base_of<std::random_access_iterator_tag,
+                      typename zip_iterator<detail_ranges_trx::iterator_of<
+                          std::remove_reference_t<Ranges> >...
+                          >::iterator_category>::value>;
+
+  template <class Tuple, std::size_t... I>
+  static auto begin(Tuple &ranges, std::index_sequence<I...>) {
+    return make_zip(detail_ranges_trx::adl_begin(std::get<I>(ranges))...);
+  }
+
+  template <class Tuple, std::size_t... I>
+  static auto end(Tuple &ranges, std::index_sequence<I...> indices) {
+    return end(ranges, indices, random_access());
+  }
+
+  template <class Tuple, std::size_t... I>
+  static auto end(Tuple &ranges, std::index_sequence<I...>,
+                  std::false_type) {
+    return make_zip(detail_ranges_trx::adl_end(std::get<I>(ranges))...);
+  }
+
+  template <class Tuple, std::size_t... I>
+  static auto end(Tuple &ranges, std::index_sequence<I...>, std::true_type) {
+    const std::size_t sizes[] = {static_cast<std::size_t>(std::distance(
+        detail_ranges_trx::adl_begin(std::get<I>(ranges)),
+        detail_ranges_trx::adl_end(std::get<I>(ranges))))...};
+    const std::size_t size = *std::min_element(std::begin(sizes),
+                                               std::end(sizes));
+    return make_zip(std::next(
+        detail_ranges_trx::adl_begin(std::get<I>(ranges)),
+        static_cast<std::ptrdiff_t>(size))...);
+  }
+
+  template <class... Its>
+  static zip_iterator<Its...> make_zip(Its... its) {
+    return zip_iterator<Its...>(its...);
+  }
+
+  std::tuple<Ranges...> ranges_;
+};
+
+//! Factories of the lazy views, which refer to lvalue ranges and take over
+//! rvalue ones.
+namespace views {
+//! Returns a lazy view of the elements of range satisfying pred.
+/*!
+  Returns a lazy view of the elements of range satisfying pred, without
+  copying any. trx::best_if searches the view as the underlying range with
+  pred as its predicate, so that a contiguous range of arithmetic values
+  filtered by trx::less_than and the like is searched by the SIMD kernels.
+
+  Example
+  std::vector<float> weights{0.5f, 2.f, 8.f, 1.5f};
+  auto light = trx::views::filter(weights, trx::less_than(2.f));
+  assert(*trx::best_if(light.begin(), light.end(), trx::any_value(),
+                       std::greater<>()) == 1.5f);
+*/
+template <class Range, class Pred>
+inline filter_view<Range, Pred> filter(Range &&range, Pred pred) {
+  return filter_view<Range, Pred>(std::forward<Range>(range),
+                                  std::move(pred));
+}
+
+//! Returns a lazy view of fn(element) for the elements of range.
+/*!
+  Returns a lazy view of fn(element) for the elements of range, computed on
+  each access. Random access ranges stay random access.
+
+  Example
+  std::vector<std::string> names{"bob", "al", "chris"};
+  auto sizes = trx::views::transform(
+      names, [](const std::string &name){ return name.size(); });
+  assert(trx::top_k(sizes, 1) == std::vector<std::size_t>({5}));
+*/
+template <class Range, class Fn>
+inline transform_view<Range, Fn> transform(Range &&range, Fn fn) {
+  return transform_view<Range, Fn>(std::forward<Range>(range), std::move(fn));
+}
+
+//! Returns a view of the first count elements of range.
+/*!
+  Returns a view of the first count elements of range, whose iterators are
+  those of the range.
+
+  Example
+  std::vector<int> vtr{9,1,3,4,2};
+  trx::sort(trx::views::take(vtr, 3)); // {1,3,9,4,2}
+*/
+template <class Range>
+inline take_view<Range> take(Range &&range, std::size_t count) {
+  return take_view<Range>(std::forward<Range>(range), count);
+}
+
+//! Returns a lazy view of tuples of the elements of the ranges.
+/*!
+  Returns a lazy view of std::tuples of references to the elements at the
+  same position of the ranges, as long as the shortest one.
+
+  Example
+  std::vector<int> ids{4,7,1};
+  std::vector<float> scores{0.5f, 2.f, 1.f};
+  auto both = trx::views::zip(ids, scores);
+  auto best = trx::best_if(both.begin(), both.end(), trx::any_value(),
+      [](const auto &lhs, const auto &rhs) {
+        return std::get<1>(lhs) > std::get<1>(rhs);
+      });
+  assert(std::get<0>(*best) == 7);
+*/
+template <class... Ranges>
+inline zip_view<Ranges...> zip(Ranges &&... ranges) {
+  return zip_view<Ranges...>(std::forward<Ranges>(ranges)...);
+}
+
+} // namespace views
+
+//! Searches for the best element of a filtered range among those for which
+//! predicate returns true.
+/*!
+  Searches a filter_view as best_if(first, last, up, bp) does, but through
+  the underlying range: its predicate is combined with up, or replaces it if
+  up is trx::any_value, so that the SIMD kernels of best_if apply to the
+  filtered contiguous ranges of arithmetic values.
+
+  Return value
+  An iterator to the first best element, or last if no element satisfies
+  the predicates.
+*/
+template <class It, class Pred, class UnaryPredicate, class BinaryPredicate>
+inline filter_iterator<It, Pred> best_if(filter_iterator<It, Pred> first,
+                                         filter_iterator<It, Pred> last,
+                                         UnaryPredicate up,
+                                         BinaryPredicate bp) {
+  const Pred &pred = first.predicate();
+  const It best = best_if(first.base(), last.base(),
+                          [&pred, &up](const auto &value) {
+                            return pred(value) && up(value);
+                          }, bp);
+  return filter_iterator<It, Pred>(best, last.base(), pred);
+}
+
+template <class It, class Pred, class BinaryPredicate>
+inline filter_iterator<It, Pred> best_if(filter_iterator<It, Pred> first,
+                                         filter_iterator<It, Pred> last,
+                                         any_value, BinaryPredicate bp) {
+  const Pred &pred = first.predicate();
+  return filter_iterator<It, Pred>(
+      best_if(first.base(), last.base(), pred, bp), last.base(), pred);
+}
+
+} // namespace trx
+
+#endif // _STL_EXTENSION_TRX_RANGES_H_
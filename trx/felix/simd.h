@@ -0,0 +1,256 @@
+#ifndef _STL_EXTENSION_TRX_SIMD_H_
+#define _STL_EXTENSION_TRX_SIMD_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+// The kernels are written with the vector extensions of GCC and Clang, which
+// lower to SSE2/AVX2/AVX-512 on x86 and to NEON on ARM. Defining
+// TRX_DISABLE_SIMD, or any other compiler, leaves the scalar loops only.
+#if !defined(TRX_DISABLE_SIMD) && (defined(__GNUC__) || defined(__clang__))
+#define TRX_SIMD_VECTOR_EXTENSIONS 1
+#if defined(__x86_64__) || defined(__i386__)
+#define TRX_SIMD_X86_DISPATCH 1
+#endif
+#endif
+
+#if TRX_SIMD_VECTOR_EXTENSIONS
+#define TRX_SIMD_ALWAYS_INLINE inline __attribute__((always_inline))
+#else
+#define TRX_SIMD_ALWAYS_INLINE inline
+#endif
+
+namespace trx {
+//! Helper function/class templates for the current header.
+namespace detail_simd_trx {
+//! The instruction sets the kernels are compiled for.
+enum class isa { generic, avx2, avx512 };
+
+//! Returns the widest instruction set supported by the running CPU.
+inline isa detected_isa() noexcept {
+#if TRX_SIMD_X86_DISPATCH
+  static const isa value = [] {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") &&
+        __builtin_cpu_supports("avx512bw") &&
+        __builtin_cpu_supports("avx512dq") &&
+        __builtin_cpu_supports("avx512vl"))
+      return isa::avx512;
+    if (__builtin_cpu_supports("avx2"))
+      return isa::avx2;
+    return isa::generic;
+  }();
+  return value;
+#else
+  return isa::generic;
+#endif
+}
+
+//! Element types the kernels handle: arithmetic types but bool and long
+//! double.
+template <class T>
+struct is_simd_element : std::integral_constant<bool,
+    std::is_arithmetic<T>::value && !std::is_same<T, bool>::value &&
+    sizeof(T) <= sizeof(std::uint64_t)> {};
+
+//! The unary predicates the kernels understand, compared against a bound.
+enum class compare_op { any, less, greater, less_equal, greater_equal };
+
+//! What the match_stats kernels find out about the elements matching their
+//! predicate: how many there are, the indices of the first min and of the
+//! first max, n if none matches, and whether any is NaN, in which case the
+//! indices are meaningless.
+struct match_stats {
+  std::size_t count, min_index, max_index;
+  bool nan;
+};
+
+//! The nodes of the static B-trees searched by the stree_search kernels fill
+//! a cache line.
+constexpr std::size_t stree_node_bytes = 64;
+
+//! The stree_search kernels interleave the search of this many queries.
+constexpr std::size_t stree_batch = 16;
+
+#if TRX_SIMD_VECTOR_EXTENSIONS
+//! A vector of Bytes/sizeof(T) lanes of T.
+template <class T, std::size_t Bytes>
+struct vector_of {
+  typedef T type __attribute__((vector_size(Bytes)));
+};
+
+//! Returns true if any lane of the mask is set.
+template <std::size_t Bytes, class M>
+TRX_SIMD_ALWAYS_INLINE bool any_lane(const M &mask) noexcept {
+  std::uint64_t words[Bytes/sizeof(std::uint64_t)];
+  std::memcpy(words, &mask, Bytes);
+  std::uint64_t any = 0;
+  for (std::uint64_t word : words)
+    any |= word;
+  return any != 0;
+}
+#endif // TRX_SIMD_VECTOR_EXTENSIONS
+
+} // namespace detail_simd_trx
+
+} // namespace trx
+
+#if TRX_SIMD_VECTOR_EXTENSIONS
+// The kernels are stamped out once per instruction set from simd_kernels.inc:
+// GCC lowers the vector operations of a function to its own target before
+// inlining it, so the kernels must be defined under the target they run on.
+#define TRX_SIMD_KERNEL_BYTES 16
+#define TRX_SIMD_KERNEL(name) name##_generic
+#include "simd_kernels.inc"
+#undef TRX_SIMD_KERNEL
+#undef TRX_SIMD_KERNEL_BYTES
+
+#if TRX_SIMD_X86_DISPATCH
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2"))), \
+                             apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+#define TRX_SIMD_KERNEL_BYTES 32
+#define TRX_SIMD_KERNEL(name) name##_avx2
+#include "simd_kernels.inc"
+#undef TRX_SIMD_KERNEL
+#undef TRX_SIMD_KERNEL_BYTES
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+#if defined(__clang__)
+#pragma clang attribute push( \
+    __attribute__((target("avx512f,avx512bw,avx512dq,avx512vl"))), \
+    apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx512f,avx512bw,avx512dq,avx512vl")
+#endif
+#define TRX_SIMD_KERNEL_BYTES 64
+#define TRX_SIMD_KERNEL(name) name##_avx512
+#include "simd_kernels.inc"
+#undef TRX_SIMD_KERNEL
+#undef TRX_SIMD_KERNEL_BYTES
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+#endif // TRX_SIMD_X86_DISPATCH
+#endif // TRX_SIMD_VECTOR_EXTENSIONS
+
+namespace trx {
+namespace detail_simd_trx {
+//! Returns the index of the first best element of data[0, n) matching
+//! x Op bound as the first_best kernels do, picking the widest one the CPU
+//! supports. Without vector extensions, always returns n+1.
+template <compare_op Op, bool Maximum, class T>
+inline std::size_t first_best_index(const T *data, std::size_t n, T bound) {
+#if TRX_SIMD_VECTOR_EXTENSIONS
+#if TRX_SIMD_X86_DISPATCH
+  switch (detected_isa()) {
+  case isa::avx512:
+    return first_best_avx512<Op, Maximum>(data, n, bound);
+  case isa::avx2:
+    return first_best_avx2<Op, Maximum>(data, n, bound);
+  case isa::generic:
+    break;
+  }
+#endif
+  return first_best_generic<Op, Maximum>(data, n, bound);
+#else
+  return (void)data, (void)bound, n+1;
+#endif
+}
+
+//! Computes the match_stats of data[0, n) for the predicate x Op bound as the
+//! match_stats kernels do, picking the widest one the CPU supports. Without
+//! vector extensions, returns false and leaves stats untouched.
+template <compare_op Op, class T>
+inline bool match_stats_of(const T *data, std::size_t n, T bound,
+                           match_stats &stats) {
+#if TRX_SIMD_VECTOR_EXTENSIONS
+#if TRX_SIMD_X86_DISPATCH
+  switch (detected_isa()) {
+  case isa::avx512:
+    stats = match_stats_avx512<Op>(data, n, bound);
+    return true;
+  case isa::avx2:
+    stats = match_stats_avx2<Op>(data, n, bound);
+    return true;
+  case isa::generic:
+    break;
+  }
+#endif
+  stats = match_stats_generic<Op>(data, n, bound);
+  return true;
+#else
+  return (void)data, (void)n, (void)bound, (void)stats, false;
+#endif
+}
+
+//! Writes to out the elements of a[0, na) found in b[0, nb) as the
+//! intersect_sorted kernels do, picking the widest one the CPU supports, and
+//! returns how many, or min(na, nb)+1 if an input is not strictly
+//! increasing. Without vector extensions, always returns min(na, nb)+1.
+template <class T>
+inline std::size_t intersect_sorted(const T *a, std::size_t na, const T *b,
+                                    std::size_t nb, T *out) {
+#if TRX_SIMD_VECTOR_EXTENSIONS
+#if TRX_SIMD_X86_DISPATCH
+  switch (detected_isa()) {
+  case isa::avx512:
+    return intersect_sorted_avx512(a, na, b, nb, out);
+  case isa::avx2:
+    return intersect_sorted_avx2(a, na, b, nb, out);
+  case isa::generic:
+    break;
+  }
+#endif
+  return intersect_sorted_generic(a, na, b, nb, out);
+#else
+  return (void)a, (void)b, (void)out, (na < nb ? na : nb)+1;
+#endif
+}
+
+//! Searches count keys in a static B-tree as the stree_search kernels do,
+//! picking the widest one the CPU supports. Without vector extensions,
+//! returns false and leaves slots untouched.
+template <compare_op Op, class T>
+inline bool stree_search(const T *nodes, std::size_t blocks, const T *keys,
+                         std::size_t count, std::size_t *slots) {
+#if TRX_SIMD_VECTOR_EXTENSIONS
+#if TRX_SIMD_X86_DISPATCH
+  switch (detected_isa()) {
+  case isa::avx512:
+    stree_search_avx512<Op>(nodes, blocks, keys, count, slots);
+    return true;
+  case isa::avx2:
+    stree_search_avx2<Op>(nodes, blocks, keys, count, slots);
+    return true;
+  case isa::generic:
+    break;
+  }
+#endif
+  stree_search_generic<Op>(nodes, blocks, keys, count, slots);
+  return true;
+#else
+  return (void)nodes, (void)blocks, (void)keys, (void)count, (void)slots,
+         false;
+#endif
+}
+
+} // namespace detail_simd_trx
+
+} // namespace trx
+
+#endif // _STL_EXTENSION_TRX_SIMD_H_
@@ -0,0 +1,291 @@
+#ifndef _STL_EXTENSION_TRX_SORTED_VECTOR_H_
+#define _STL_EXTENSION_TRX_SORTED_VECTOR_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "algorithm.h"
+
+namespace trx {
+//! A sorted std::vector whose insertions are buffered and merged in batches.
+/*!
+  A sorted std::vector whose insertions are buffered and merged in batches,
+  like a flat multiset. Insertions append to the end of the vector; the
+  first read which needs the order, like begin(), lower_bound() or top_k(),
+  sorts the d elements appended since the previous one by trx's stable merge
+  sort, and merges them in place with the n sorted ones from the back. A
+  batch then costs O(n+dlogd) instead of the O((n+d)log(n+d)) of sorting the
+  whole vector again, and the merge only moves the sorted elements greater
+  than the least inserted one. Equivalent elements are kept in the order of
+  their insertion. Every insertion invalidates the iterators, and so does a
+  read which merges a batch. As the reads merge the pending elements,
+  concurrent reads are only safe once flush() has been called.
+
+  Type requirements
+  T must meet the requirements of MoveConstructible and MoveAssignable
+  Comp must meet the requirements of Compare
+  Allocator must meet the requirements of Allocator for T
+
+  Example
+  trx::sorted_vector<int> ids{9,1,3};
+  ids.insert({4,2});
+  assert(ids.best() == 1);
+  assert(*ids.lower_bound(3) == 3);
+  assert(ids.top_k(2) == std::vector<int>({1,2}));
+*/
+template <class T, class Comp = std::less<>,
+          class Allocator = std::allocator<T> >
+class sorted_vector {
+  using storage = std::vector<T, Allocator>;
+
+public:
+  using value_type = T;
+  using value_compare = Comp;
+  using allocator_type = Allocator;
+  using size_type = typename storage::size_type;
+  using difference_type = typename storage::difference_type;
+  using reference = const T &;
+  using const_reference = const T &;
+  using iterator = typename storage::const_iterator;
+  using const_iterator = typename storage::const_iterator;
+
+  //! Creates an empty container.
+  sorted_vector() = default;
+
+  explicit sorted_vector(const Comp &comp,
+                         const Allocator &allocator = Allocator())
+      : elements_(allocator), comp_(comp) {}
+
+  explicit sorted_vector(const Allocator &allocator) : elements_(allocator) {}
+
+  //! Creates a container holding the elements of [first, last), sorted on
+  //! the first read.
+  template <class InputIt>
+  sorted_vector(InputIt first, InputIt last, const Comp &comp = Comp(),
+                const Allocator &allocator = Allocator())
+      : elements_(first, last, allocator), comp_(comp) {}
+
+  sorted_vector(std::initializer_list<T> values, const Comp &comp = Comp(),
+                const Allocator &allocator = Allocator())
+      : sorted_vector(values.begin(), values.end(), comp, allocator) {}
+
+  sorted_vector(const sorted_vector &) = default;
+
+  //! The moved-from container is left empty, or with its elements pending
+  //! when its allocator does not let them be moved.
+  sorted_vector(sorted_vector &&other) noexcept(
+      std::is_nothrow_move_constructible<storage>::value &&
+      std::is_nothrow_move_constructible<Comp>::value)
+      : elements_(std::move(other.elements_)),
+        sorted_(std::exchange(other.sorted_, 0)),
+        comp_(std::move(other.comp_)) {}
+
+  sorted_vector &operator=(const sorted_vector &) = default;
+
+  sorted_vector &operator=(sorted_vector &&other) noexcept(
+      std::is_nothrow_move_assignable<storage>::value &&
+      std::is_nothrow_move_assignable<Comp>::value) {
+    elements_ = std::move(other.elements_);
+    sorted_ = std::exchange(other.sorted_, 0);
+    comp_ = std::move(other.comp_);
+    return *this;
+  }
+
+  //! Inserts value, merged on the next read.
+  /*!
+    Time Complexity
+    Amortized O(1), the sort and merge being paid by the next read.
+  */
+  void insert(const T &value) { elements_.push_back(value); }
+
+  void insert(T &&value) { elements_.push_back(std::move(value)); }
+
+  //! Inserts the elements of [first, last), merged on the next read.
+  template <class InputIt>
+  void insert(InputIt first, InputIt last) {
+    elements_.insert(elements_.end(), first, last);
+  }
+
+  void insert(std::initializer_list<T> values) {
+    insert(values.begin(), values.end());
+  }
+
+  //! Inserts an element constructed from args, merged on the next read.
+  template <class... Args>
+  void emplace(Args &&... args) {
+    elements_.emplace_back(std::forward<Args>(args)...);
+  }
+
+  //! Sorts the pending elements and merges them with the sorted ones.
+  /*!
+    Time Complexity
+    O(n+dlogd), where n is the number of sorted elements and d the number
+    of pending ones.
+  */
+  void flush() const {
+    if (sorted_ == elements_.size())
+      return;
+    T *const first = elements_.data(), *const middle = first+sorted_,
+            *const last = first+elements_.size();
+    detail_algorithm_trx::stable_sort_range(middle, last, comp_);
+    if (sorted_ != 0 && comp_(*middle, middle[-1]))
+      detail_algorithm_trx::merge_suffix(first, middle, last, comp_);
+    sorted_ = elements_.size();
+  }
+
+  //! Returns the number of inserted elements not merged yet.
+  size_type pending() const noexcept { return elements_.size()-sorted_; }
+
+  size_type size() const noexcept { return elements_.size(); }
+
+  bool empty() const noexcept { return elements_.empty(); }
+
+  void reserve(size_type n) { elements_.reserve(n); }
+
+  void clear() noexcept {
+    elements_.clear();
+    sorted_ = 0;
+  }
+
+  //! Returns an iterator to the first element, merging the pending ones.
+  const_iterator begin() const {
+    flush();
+    return elements_.cbegin();
+  }
+
+  const_iterator end() const {
+    flush();
+    return elements_.cend();
+  }
+
+  const_iterator cbegin() const { return begin(); }
+
+  const_iterator cend() const { return end(); }
+
+  //! Returns a pointer to the sorted elements, merging the pending ones.
+  const T *data() const {
+    flush();
+    return elements_.data();
+  }
+
+  //! Returns the first element in the order of comp, without merging the
+  //! pending elements. Of equivalent elements, the one which comes first
+  //! once merged is returned.
+  /*!
+    Precondition, empty() is false.
+
+    Time Complexity
+    O(d), where d is the number of pending elements.
+  */
+  const T &best() const {
+    const auto middle = elements_.begin()+sorted_;
+    const auto pending_best = trx::best_if(middle, elements_.end(),
+                                           any_value(), comp_);
+    if (sorted_ != 0 &&
+        (pending_best == elements_.end() ||
+         !comp_(*pending_best, elements_.front())))
+      return elements_.front();
+    return *pending_best;
+  }
+
+  //! Returns copies of the k first elements in the order of comp, all of
+  //! them if there are less than k.
+  /*!
+    Time Complexity
+    O(k), plus the merge of the pending elements.
+  */
+  storage top_k(size_type k) const {
+    flush();
+    return storage(elements_.begin(),
+                   elements_.begin()+std::min(k, elements_.size()),
+                   elements_.get_allocator());
+  }
+
+  //! Returns an iterator to the first element not before key.
+  template <class Key>
+  const_iterator lower_bound(const Key &key) const {
+    flush();
+    return std::lower_bound(elements_.cbegin(), elements_.cend(), key, comp_);
+  }
+
+  //! Returns an iterator to the first element after key.
+  template <class Key>
+  const_iterator upper_bound(const Key &key) const {
+    flush();
+    return std::upper_bound(elements_.cbegin(), elements_.cend(), key, comp_);
+  }
+
+  //! Returns the range of the elements equivalent to key.
+  template <class Key>
+  std::pair<const_iterator, const_iterator> equal_range(
+      const Key &key) const {
+    flush();
+    return std::equal_range(elements_.cbegin(), elements_.cend(), key, comp_);
+  }
+
+  //! Returns an iterator to the first element equivalent to key, end() if
+  //! there is none.
+  template <class Key>
+  const_iterator find(const Key &key) const {
+    const const_iterator it = lower_bound(key);
+    return it != elements_.cend() && !comp_(key, *it) ? it
+                                                       : elements_.cend();
+  }
+
+  //! Returns the number of elements equivalent to key.
+  template <class Key>
+  size_type count(const Key &key) const {
+    const auto range = equal_range(key);
+    return range.second-range.first;
+  }
+
+  template <class Key>
+  bool contains(const Key &key) const {
+    return find(key) != elements_.cend();
+  }
+
+  //! Erases the element at pos, and returns the iterator following it.
+  const_iterator erase(const_iterator pos) {
+    flush();
+    --sorted_;
+    return elements_.erase(pos);
+  }
+
+  //! Erases the elements of [first, last), and returns last.
+  const_iterator erase(const_iterator first, const_iterator last) {
+    flush();
+    sorted_ -= last-first;
+    return elements_.erase(first, last);
+  }
+
+  //! Erases the elements equivalent to key, and returns their number.
+  template <class Key>
+  size_type erase(const Key &key) {
+    const auto range = equal_range(key);
+    const size_type n = range.second-range.first;
+    erase(range.first, range.second);
+    return n;
+  }
+
+  value_compare value_comp() const { return comp_; }
+
+  allocator_type get_allocator() const noexcept {
+    return elements_.get_allocator();
+  }
+
+private:
+  mutable storage elements_;
+  mutable size_type sorted_ = 0;
+  mutable Comp comp_;
+};
+
+} // namespace trx
+
+#endif // _STL_EXTENSION_TRX_SORTED_VECTOR_H_
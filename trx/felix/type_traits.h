@@ -1,28 +1,23 @@
 #ifndef _STL_EXTENSION_TRX_TYPE_TRAITS_H_
 #define _STL_EXTENSION_TRX_TYPE_TRAITS_H_
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <iterator>
+#include <limits>
+#include <string>
 #include <type_traits>
+#include <vector>
 
 namespace trx {
 //! Helper function/class templates for the current header.
 namespace detail_trx {
-//! tlx_and's helper for the case of no template argument
+//! A pack of bools as a type, so that two packs compare with std::is_same.
 template <bool... vals>
-constexpr std::enable_if_t<sizeof...(vals)==0, bool> tlx_and_impl() {
-  return true;
-}
-
-//! tlx_and's helper for the case of one template arguments
-template <bool val>
-constexpr bool tlx_and_impl() {
-  return val;
-}
-
-//! tlx_and's helper for the case of multiple template arguments
-template <bool val, bool... vals>
-constexpr std::enable_if_t<sizeof...(vals)>=1, bool> tlx_and_impl() {
-  return val && tlx_and_impl<vals...>();
-}
+struct bool_pack {};
 
 } // namespace detail_trx
 
@@ -30,12 +25,343 @@ constexpr std::enable_if_t<sizeof...(vals)>=1, bool> tlx_and_impl() {
 /*!
   Returns the result of logical and of all template arguments.
   If the template arguments is empty, returns true.
-*/ 
+  The instantiation depth does not depend on the number of arguments.
+*/
 template <bool... vals>
 constexpr bool tlx_and() {
-  return detail_trx::tlx_and_impl<vals...>();
+#if __cpp_fold_expressions
+  return (true && ... && vals);
+#else
+  // all true iff shifting the pack by one true leaves it unchanged
+  return std::is_same<detail_trx::bool_pack<true, vals...>,
+                      detail_trx::bool_pack<vals..., true> >::value;
+#endif
+}
+
+//! Returns the result of logical or of all template arguments.
+/*!
+  Returns the result of logical or of all template arguments.
+  If the template arguments is empty, returns false.
+  The instantiation depth does not depend on the number of arguments.
+*/
+template <bool... vals>
+constexpr bool tlx_or() {
+#if __cpp_fold_expressions
+  return (false || ... || vals);
+#else
+  return !std::is_same<detail_trx::bool_pack<false, vals...>,
+                       detail_trx::bool_pack<vals..., false> >::value;
+#endif
+}
+
+//! Returns the number of template arguments which are true.
+/*!
+  Returns the number of template arguments which are true.
+  If the template arguments is empty, returns 0.
+  The instantiation depth does not depend on the number of arguments.
+*/
+template <bool... vals>
+constexpr std::size_t tlx_count() {
+#if __cpp_fold_expressions
+  return (std::size_t(0) + ... + std::size_t(vals));
+#else
+  const bool values[] = {false, vals...};
+  std::size_t count = 0;
+  for (bool value : values)
+    count += value;
+  return count;
+#endif
+}
+
+namespace detail_trx {
+//! tlx_all_same's helper for less than two types
+template <class... Ts>
+struct all_same : std::true_type {};
+
+//! tlx_all_same's helper, comparing every type to the first one
+template <class T, class... Ts>
+struct all_same<T, Ts...>
+    : std::integral_constant<bool,
+                             tlx_and<std::is_same<T, Ts>::value...>()> {};
+
+} // namespace detail_trx
+
+//! Returns whether all template arguments are the same type.
+/*!
+  Returns whether all template arguments are the same type, as given by
+  std::is_same. If there are less than two template arguments, returns true.
+  The instantiation depth does not depend on the number of arguments.
+*/
+template <class... Ts>
+constexpr bool tlx_all_same() {
+  return detail_trx::all_same<Ts...>::value;
 }
 
+namespace detail_trx {
+//! is_contiguous_iterator's helper: checks whether It is an iterator of a
+//! std::vector or std::array of its value type. Only object types other
+//! than bool are looked up, as output iterators have a void value type and
+//! the iterators of std::vector<bool> point into packed bits.
+template <class It, class Enable = void>
+struct is_vector_or_array_iterator : std::false_type {};
+
+template <class It>
+struct is_vector_or_array_iterator<It, std::enable_if_t<
+    std::is_object<typename std::iterator_traits<It>::value_type>::value &&
+    !std::is_array<typename std::iterator_traits<It>::value_type>::value &&
+    !std::is_same<typename std::iterator_traits<It>::value_type,
+                  bool>::value> >
+    : std::integral_constant<bool,
+        std::is_same<It, typename std::vector<
+            typename std::iterator_traits<It>::value_type>::iterator>::value ||
+        std::is_same<It, typename std::vector<
+            typename std::iterator_traits<It>::value_type>::const_iterator
+            >::value ||
+        std::is_same<It, typename std::array<
+            typename std::iterator_traits<It>::value_type, 1>::iterator
+            >::value ||
+        std::is_same<It, typename std::array<
+            typename std::iterator_traits<It>::value_type, 1>::const_iterator
+            >::value> {};
+
+} // namespace detail_trx
+
+//! Checks whether It is known to point into contiguous memory.
+/*!
+  Checks whether It is known to point into contiguous memory: pointers, the
+  iterators of std::vector (but std::vector<bool>), std::basic_string and
+  std::array with the default allocator, and any std::contiguous_iterator
+  in C++20. Other iterators, output iterators included, yield false.
+  Specialize it as std::true_type for other iterators over contiguous
+  elements, so that the algorithms may search them through pointers.
+*/
+template <class It, class Enable = void>
+struct is_contiguous_iterator : std::integral_constant<bool,
+    std::is_pointer<It>::value ||
+    detail_trx::is_vector_or_array_iterator<It>::value> {};
+
+template <class It>
+struct is_contiguous_iterator<It, std::enable_if_t<
+    std::is_same<It, std::string::iterator>::value ||
+    std::is_same<It, std::string::const_iterator>::value> >
+    : std::true_type {};
+
+#if defined(__cpp_lib_concepts)
+template <class It>
+struct is_contiguous_iterator<It, std::enable_if_t<
+    std::contiguous_iterator<It> &&
+    !std::is_same<It, std::string::iterator>::value &&
+    !std::is_same<It, std::string::const_iterator>::value> >
+    : std::true_type {};
+#endif
+
+//! Tells where the block of contiguous elements an iterator points into ends.
+/*!
+  Tells where the block of contiguous elements an iterator points into ends,
+  for the iterators of containers storing their elements in blocks, like
+  std::deque. A specialization provides a static member function
+  block_end(const It &it) returning a pointer past the last element of the
+  block holding *it. The algorithms then process ranges of such random
+  access iterators one block at a time through pointers, to take their
+  contiguous paths, like the SIMD kernels of best_if.
+  Specialized for the iterators of std::deque with libstdc++, but in debug
+  mode.
+
+  Example
+  template <class T>
+  struct trx::segmented_iterator<chunked_array<T>::iterator> {
+    static T *block_end(const chunked_array<T>::iterator &it) noexcept {
+      return it.chunk->data()+it.chunk->size();
+    }
+  };
+*/
+template <class It, class Enable = void>
+struct segmented_iterator {};
+
+#if defined(__GLIBCXX__) && !defined(_GLIBCXX_DEBUG)
+template <class T, class Ref, class Ptr>
+struct segmented_iterator<std::_Deque_iterator<T, Ref, Ptr> > {
+  static Ptr block_end(const std::_Deque_iterator<T, Ref, Ptr> &it) noexcept {
+    return it._M_last;
+  }
+};
+#endif
+
+//! Checks whether It is a random access iterator whose ranges are processed
+//! block by block, as described by trx::segmented_iterator.
+template <class It, class Enable = void>
+struct is_segmented_iterator : std::false_type {};
+
+template <class It>
+struct is_segmented_iterator<It, std::enable_if_t<
+    std::is_pointer<decltype(segmented_iterator<It>::block_end(
+        std::declval<const It &>()))>::value> >
+    : std::is_base_of<std::random_access_iterator_tag,
+                      typename std::iterator_traits<It>::iterator_category> {};
+
+//! Checks whether Container stores its elements contiguously.
+/*!
+  Checks whether Container stores its elements contiguously: C arrays, and
+  the classes with random access iterators whose data() member function
+  returns a pointer to their elements, like std::vector but std::vector<bool>,
+  std::array, std::basic_string and spans. The algorithms handle those
+  through pointers. Specialize it as std::false_type for a class whose data()
+  does not point to the elements of [begin(), end()).
+*/
+template <class Container, class Enable = void>
+struct is_contiguous_container : std::false_type {};
+
+template <class T, std::size_t N>
+struct is_contiguous_container<T[N]> : std::true_type {};
+
+template <class Container>
+struct is_contiguous_container<Container, std::enable_if_t<
+    std::is_pointer<decltype(std::declval<Container &>().data())>::value &&
+    std::is_same<std::remove_cv_t<std::remove_pointer_t<decltype(
+                     std::declval<Container &>().data())> >,
+                 std::remove_cv_t<typename std::iterator_traits<decltype(
+                     std::begin(std::declval<Container &>()))>::value_type>
+                 >::value &&
+    std::is_base_of<std::random_access_iterator_tag,
+                    typename std::iterator_traits<decltype(std::begin(
+                        std::declval<Container &>()))>::iterator_category
+                    >::value> > : std::true_type {};
+
+//! Checks whether moving a T and destroying the source amounts to copying
+//! its bytes.
+/*!
+  Checks whether moving a T and destroying the source amounts to copying
+  its bytes, in which case the algorithms relocate the elements they permute
+  with std::memcpy. True for the trivially copyable types. Specialize it as
+  std::true_type for other types holding no pointer into themselves, like
+  most classes owning a heap allocation through a pointer.
+*/
+template <class T>
+struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+//! Order-preserving mapping of T to unsigned integers, used by radix sorting.
+/*!
+  Order-preserving mapping of T to unsigned integers, used by radix sorting.
+  A specialization provides type, an unsigned integer type, and a static
+  member function key(const T &) returning a type such that
+  key(a) < key(b) exactly when a < b. trx::sort then radix sorts the ranges
+  of T ordered by std::less or std::greater.
+  Specialized for the integral types but bool, and for IEEE-754 float and
+  double.
+
+  Example
+  struct record { std::uint32_t id; float weight; };
+  bool operator<(const record &lhs, const record &rhs) {
+    return lhs.id < rhs.id;
+  }
+
+  template <>
+  struct trx::radix_sort_key<record> {
+    using type = std::uint32_t;
+
+    static type key(const record &value) noexcept { return value.id; }
+  };
+*/
+template <class T, class Enable = void>
+struct radix_sort_key {};
+
+//! radix_sort_key for the integral types but bool, whose sign bit is flipped
+template <class T>
+struct radix_sort_key<T, std::enable_if_t<
+    std::is_integral<T>::value && !std::is_same<T, bool>::value> > {
+  using type = std::make_unsigned_t<T>;
+
+  static type key(T value) noexcept {
+    constexpr type sign = std::is_signed<T>::value ?
+        type(type(1) << (std::numeric_limits<type>::digits-1)) : type(0);
+    return static_cast<type>(static_cast<type>(value)^sign);
+  }
+};
+
+//! radix_sort_key for IEEE-754 float and double: negative values have all
+//! their bits flipped, non-negative values only their sign bit. -0.0 is
+//! first replaced by 0.0, so that both get the same key as they compare
+//! equal. NaNs are ordered after +inf, or before -inf if their sign bit is
+//! set.
+template <class T>
+struct radix_sort_key<T, std::enable_if_t<
+    std::is_floating_point<T>::value && std::numeric_limits<T>::is_iec559 &&
+    (sizeof(T) == sizeof(std::uint32_t) ||
+     sizeof(T) == sizeof(std::uint64_t))> > {
+  using type = std::conditional_t<sizeof(T) == sizeof(std::uint32_t),
+                                  std::uint32_t, std::uint64_t>;
+
+  static type key(T value) noexcept {
+    constexpr type sign = type(1) << (std::numeric_limits<type>::digits-1);
+    if (value == T(0))
+      value = T(0);
+    type bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return (bits & sign) ? static_cast<type>(~bits) : (bits | sign);
+  }
+};
+
+//! Checks whether radix_sort_key is specialized for T with an unsigned
+//! integer key.
+template <class T, class Enable = void>
+struct is_radix_sortable : std::false_type {};
+
+template <class T>
+struct is_radix_sortable<T, std::conditional_t<
+    true, void, typename radix_sort_key<T>::type> >
+    : std::integral_constant<bool,
+          std::is_integral<typename radix_sort_key<T>::type>::value &&
+          std::is_unsigned<typename radix_sort_key<T>::type>::value &&
+          !std::is_same<typename radix_sort_key<T>::type, bool>::value> {};
+
+//! Checks whether comparing two T costs about as much as comparing two
+//! integers.
+/*!
+  Checks whether comparing two T costs about as much as comparing two
+  integers, in which case the algorithms prefer branch-free code doing more
+  comparisons, like the sorting networks. True for the arithmetic, enum and
+  pointer types. Specialize it as std::true_type for small records compared
+  by a single field.
+*/
+template <class T>
+struct is_cheap_to_compare : std::integral_constant<bool,
+    std::is_arithmetic<T>::value || std::is_enum<T>::value ||
+    std::is_pointer<T>::value || std::is_member_pointer<T>::value> {};
+
+//! tlx_and, tlx_or, tlx_count and tlx_all_same as variable templates.
+template <bool... vals>
+constexpr bool tlx_and_v = tlx_and<vals...>();
+
+template <bool... vals>
+constexpr bool tlx_or_v = tlx_or<vals...>();
+
+template <bool... vals>
+constexpr std::size_t tlx_count_v = tlx_count<vals...>();
+
+template <class... Ts>
+constexpr bool tlx_all_same_v = tlx_all_same<Ts...>();
+
+//! The traits above as variable templates.
+template <class It>
+constexpr bool is_contiguous_iterator_v = is_contiguous_iterator<It>::value;
+
+template <class It>
+constexpr bool is_segmented_iterator_v = is_segmented_iterator<It>::value;
+
+template <class Container>
+constexpr bool is_contiguous_container_v =
+    is_contiguous_container<Container>::value;
+
+template <class T>
+constexpr bool is_trivially_relocatable_v =
+    is_trivially_relocatable<T>::value;
+
+template <class T>
+constexpr bool is_radix_sortable_v = is_radix_sortable<T>::value;
+
+template <class T>
+constexpr bool is_cheap_to_compare_v = is_cheap_to_compare<T>::value;
+
 } // namespace trx
 
 #endif // _STL_EXTENSION_TRX_TYPE_TRAITS_H_